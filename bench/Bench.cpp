@@ -0,0 +1,257 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+//Bench.cpp
+//Simulator throughput benchmark (simulated cycles/sec, transactions/sec, and peak RSS per scenario)
+
+#include <getopt.h>			//getopt_long
+#include <stdlib.h>			//exit(0)
+#include <stdio.h>			//freopen
+#include <unistd.h>			//fork, pipe
+#include <time.h>			//clock_gettime
+#include <sys/wait.h>		//waitpid
+#include <sys/resource.h>	//getrusage
+#include <fstream>			//ofstream
+#include <sstream>			//stringstream
+#include <map>				//map
+
+#include "CasHMCWrapper.h"
+#include "Workload.h"
+
+using namespace std;
+using namespace CasHMC;
+
+extern long numSimCycles;
+extern string traceType;
+extern double memUtil;
+extern double rwRatio;
+
+struct BenchScenario
+{
+	const char *name;
+	const char *pattern;		//Synthetic workload pattern (NULL is idle)
+	unsigned size;				//[byte] Request size
+	double rwratio;				//(%) The percentage of reads
+	double util;				//Issue probability per core
+	const char *simOverride;	//Lines appended to ConfigSim.ini
+};
+
+static BenchScenario scenarios[] =
+{
+	{"idle",			NULL,		64,		100,	0,		""},
+	{"read_stream",		"stream",	64,		100,	1,		""},
+	{"write_stream",	"stream",	64,		0,		1,		""},
+	{"random_64B",		"uniform",	64,		80,		1,		""},
+	{"segmented_256B",	"uniform",	256,	80,		1,		""},
+	{"atomics",			"gups",		16,		100,	1,		""},
+	{"retry_storm",		"uniform",	64,		80,		1,		"LINK_BER = -5;\n"},
+	{"link_power",		"uniform",	64,		80,		0.02,	"LINK_POWER = QUIESCE_SLEEP;\ntQUIESCE = 100;\ntSME = 50;\ntTXD = 500;\ntRESP2 = 100;\n"},
+	{NULL,				NULL,		0,		0,		0,		NULL}
+};
+
+void Help()
+{
+	cout<<endl<<"-c (--cycle)     : The number of CPU cycles to be simulated per scenario [Default 100000]"<<endl;
+	cout<<"-s (--sim)       : Simulation configure file [Default ../ConfigSim.ini]"<<endl;
+	cout<<"-d (--dram)      : DRAM configure file [Default ../ConfigDRAM.ini]"<<endl;
+	cout<<"-o (--output)    : Benchmark result file (csv) [Default bench_result.csv]"<<endl;
+	cout<<"-b (--baseline)  : Baseline file to be compared with (csv)"<<endl;
+	cout<<"-t (--tolerance) : (%) Allowed slowdown against the baseline [Default 20]"<<endl;
+	cout<<"-h (--help)      : Benchmark option help"<<endl<<endl;
+}
+
+double WallTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//
+//Run one scenario in the current process and return the csv line
+//
+string RunScenario(BenchScenario &sc, string simCfg, string dramCfg)
+{
+	//Scenario configure file is the original file with overriding lines (the last value is taken)
+	string scenarioCfg = string("ConfigSim_") + sc.name + ".ini";
+	ifstream cfgIn(simCfg.c_str());
+	if(!cfgIn.is_open()) {
+		ERROR(" == Error - Could not open configure file ["<<simCfg<<"]");
+		exit(1);
+	}
+	ofstream cfgOut(scenarioCfg.c_str());
+	cfgOut<<cfgIn.rdbuf()<<endl<<sc.simOverride;
+	cfgOut.close();
+	cfgIn.close();
+
+	traceType = (sc.pattern == NULL) ? "random" : "synthetic";
+	memUtil = sc.util;
+	rwRatio = sc.rwratio;
+
+	CasHMCWrapper *casHMCWrapper = new CasHMCWrapper(scenarioCfg, dramCfg);
+	Workload *workload = NULL;
+	if(sc.pattern != NULL) {
+		workload = new Workload(casHMCWrapper, sc.pattern, 8, 16, sc.size, 4096, 0.99, 0, sc.util, sc.rwratio);
+	}
+
+	double start = WallTime();
+	for(long cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
+		if(workload != NULL)	workload->Update();
+		casHMCWrapper->Update();
+	}
+	double elapsed = WallTime() - start;
+
+	uint64_t completed = 0;
+	if(workload != NULL) {
+		for(unsigned c=0; c<workload->cores.size(); c++) {
+			completed += workload->cores[c].completed;
+		}
+		delete workload;
+	}
+	delete casHMCWrapper;
+	remove(scenarioCfg.c_str());
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	stringstream line;
+	line<<sc.name<<","<<numSimCycles<<","<<completed<<","<<elapsed<<","
+		<<(uint64_t)(numSimCycles/elapsed)<<","<<(uint64_t)(completed/elapsed)<<","<<usage.ru_maxrss;
+	return line.str();
+}
+
+//
+//Read cycles/sec of each scenario in the baseline file
+//
+map<string, double> ReadBaseline(string fileName)
+{
+	map<string, double> baseline;
+	ifstream in(fileName.c_str());
+	string line;
+	while(getline(in, line)) {
+		if(line.size() == 0 || line[0] == '#')	continue;
+		stringstream ss(line);
+		string field[5];
+		for(int i=0; i<5; i++) {
+			getline(ss, field[i], ',');
+		}
+		baseline[field[0]] = atof(field[4].c_str());
+	}
+	return baseline;
+}
+
+int main(int argc, char **argv)
+{
+	numSimCycles = 100000;
+	string simCfg = "../ConfigSim.ini";
+	string dramCfg = "../ConfigDRAM.ini";
+	string outputName = "bench_result.csv";
+	string baselineName = "";
+	double tolerance = 20;
+
+	int opt;
+	while(1) {
+		static struct option long_options[] = {
+			{"cycle",  required_argument, 0, 'c'},
+			{"sim",  required_argument, 0, 's'},
+			{"dram",  required_argument, 0, 'd'},
+			{"output",  required_argument, 0, 'o'},
+			{"baseline",  required_argument, 0, 'b'},
+			{"tolerance",  required_argument, 0, 't'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0;
+		opt = getopt_long (argc, argv, "c:s:d:o:b:t:h", long_options, &option_index);
+		if(opt == -1) {
+			break;
+		}
+		switch(opt) {
+			case 'c':	numSimCycles = atol(optarg);	break;
+			case 's':	simCfg = string(optarg);		break;
+			case 'd':	dramCfg = string(optarg);		break;
+			case 'o':	outputName = string(optarg);	break;
+			case 'b':	baselineName = string(optarg);	break;
+			case 't':	tolerance = atof(optarg);		break;
+			case 'h':
+			case '?':
+				Help();
+				exit(0);
+				break;
+		}
+	}
+
+	ofstream resultOut(outputName.c_str());
+	resultOut<<"#scenario,cycles,transactions,seconds,cycles_per_sec,trans_per_sec,peak_rss_kb"<<endl;
+	cout.setf(ios::left);
+	cout<<endl<<"   === CasHMC benchmark ("<<numSimCycles<<" CPU cycles per scenario) ==="<<endl;
+
+	//Each scenario runs in a child process so that peak RSS is measured separately
+	bool failed = false;
+	vector<string> lines;
+	for(int s=0; scenarios[s].name != NULL; s++) {
+		int fd[2];
+		if(pipe(fd) != 0) {
+			ERROR(" == Error - Could not create pipe");
+			exit(1);
+		}
+		pid_t pid = fork();
+		if(pid == 0) {
+			close(fd[0]);
+			if(freopen("/dev/null", "w", stdout) == NULL) {}
+			string line = RunScenario(scenarios[s], simCfg, dramCfg);
+			if(write(fd[1], line.c_str(), line.size()) < 0) {}
+			close(fd[1]);
+			_exit(0);
+		}
+		close(fd[1]);
+		string line;
+		char buf[256];
+		ssize_t n;
+		while((n = read(fd[0], buf, sizeof(buf))) > 0) {
+			line.append(buf, n);
+		}
+		close(fd[0]);
+		int status;
+		waitpid(pid, &status, 0);
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || line.size() == 0) {
+			ERROR(" == Error - Scenario ["<<scenarios[s].name<<"] failed");
+			failed = true;
+			continue;
+		}
+		resultOut<<line<<endl;
+		lines.push_back(line);
+		cout<<"  "<<line<<endl;
+	}
+	resultOut.flush();	resultOut.close();
+	cout<<"  [ "<<outputName<<" ] is generated"<<endl;
+
+	//Compare simulated cycles/sec with the baseline
+	if(baselineName != "") {
+		map<string, double> baseline = ReadBaseline(baselineName);
+		map<string, double> current = ReadBaseline(outputName);
+		cout<<endl<<"   === Comparison with baseline ["<<baselineName<<"] (tolerance "<<tolerance<<"%) ==="<<endl;
+		for(map<string, double>::iterator it=current.begin(); it!=current.end(); it++) {
+			if(baseline.find(it->first) == baseline.end() || baseline[it->first] == 0) {
+				cout<<"  "<<setw(16)<<it->first<<" : no baseline"<<endl;
+				continue;
+			}
+			double ratio = it->second / baseline[it->first];
+			bool regression = ratio < (1 - tolerance/100);
+			cout<<"  "<<setw(16)<<it->first<<" : "<<setw(10)<<(uint64_t)it->second<<" cycles/sec ("
+				<<setprecision(3)<<ratio*100<<"% of baseline)"<<(regression ? "  << REGRESSION" : "")<<endl;
+			if(regression)	failed = true;
+		}
+	}
+	cout<<endl;
+
+	return failed ? 1 : 0;
+}
@@ -39,7 +39,8 @@
 
 #include "mem/dramsim2.hh"
 
-#include "CasHMC/sources/CallBack.h"
+#include <algorithm>
+
 #include "base/callback.hh"
 #include "base/trace.hh"
 #include "debug/DRAMSim2.hh"
@@ -59,14 +60,8 @@ DRAMSim2::DRAMSim2(const Params* p) :
             "Instantiated DRAMSim2 with clock %d ns and queue size %d\n",
             wrapper.clockPeriod(), wrapper.queueSize());
 
-    CasHMC::TransCompCB* read_cb =
-        new CasHMC::Callback<DRAMSim2, void, uint64_t, uint64_t>(
-            this, &DRAMSim2::readComplete);
-    CasHMC::TransCompCB* write_cb =
-        new CasHMC::Callback<DRAMSim2, void, uint64_t, uint64_t>(
-            this, &DRAMSim2::writeComplete);
-			
-    wrapper.setCallbacks(read_cb, write_cb);
+    pendingRequests.reserve(wrapper.queueSize());
+    completions.resize(wrapper.queueSize());
 
     // Register a callback to compensate for the destructor not
     // being called. The callback prints the DRAMSim2 stats.
@@ -96,8 +91,7 @@ DRAMSim2::startup()
 {
     startTick = curTick();
 
-    // kick off the clock ticks
-    schedule(tickEvent, clockEdge());
+    // the clock ticks are kicked off by the first request
 }
 
 void
@@ -136,10 +130,58 @@ DRAMSim2::nbrOutstanding() const
     return nbrOutstandingReads + nbrOutstandingWrites + responseQueue.size();
 }
 
+uint64_t
+DRAMSim2::cycleNow() const
+{
+    return divCeil(curTick() - startTick,
+                   wrapper.clockPeriod() * SimClock::Int::ns);
+}
+
+void
+DRAMSim2::scheduleTick()
+{
+    if (tickEvent.scheduled())
+        return;
+
+    // the next cycle of CasHMC is never earlier than the current one
+    Tick period = wrapper.clockPeriod() * SimClock::Int::ns;
+    uint64_t cycle = std::max(cycleNow(), wrapper.currentCycle());
+    schedule(tickEvent, startTick + cycle * period);
+}
+
 void
 DRAMSim2::tick()
 {
-    wrapper.tick();
+    // catch up on the cycles skipped while CasHMC was idle, nothing
+    // completes in these cycles as there is nothing in flight
+    uint64_t now = cycleNow();
+    if (now > wrapper.currentCycle())
+        wrapper.run(now - wrapper.currentCycle());
+
+    // hand the requests received since the last tick over in one
+    // batch, and keep the ones that do not fit for the next tick
+    if (!pendingRequests.empty()) {
+        unsigned int accepted = wrapper.submit(pendingRequests.data(),
+                                               pendingRequests.size());
+        DPRINTF(DRAMSim2, "Submitted %d of %d requests\n", accepted,
+                pendingRequests.size());
+        pendingRequests.erase(pendingRequests.begin(),
+                              pendingRequests.begin() + accepted);
+    }
+
+    wrapper.run(1);
+
+    // drain everything that completed in this cycle
+    unsigned int drained;
+    do {
+        drained = wrapper.drain(completions.data(), completions.size());
+        for (unsigned int i = 0; i < drained; ++i) {
+            if (completions[i].isWrite)
+                writeComplete(completions[i].addr, completions[i].cycle);
+            else
+                readComplete(completions[i].addr, completions[i].cycle);
+        }
+    } while (drained == completions.size());
 
     // is the connected port waiting for a retry, if so check the
     // state and send a retry if conditions have changed
@@ -148,7 +190,9 @@ DRAMSim2::tick()
         port.sendRetryReq();
     }
 
-    schedule(tickEvent, curTick() + wrapper.clockPeriod() * SimClock::Int::ns);
+    // skip the ticks until the next request once CasHMC is idle
+    if (!pendingRequests.empty() || !wrapper.isIdle())
+        scheduleTick();
 }
 
 Tick
@@ -219,16 +263,19 @@ DRAMSim2::recvTimingReq(PacketPtr pkt)
     }
 
     if (can_accept) {
-        // we should never have a situation when we think there is space,
-        // and there isn't
-        assert(wrapper.canAccept());
-
         DPRINTF(DRAMSim2, "Enqueueing address %lld\n", pkt->getAddr());
 
-        // @todo what about the granularity here, implicit assumption that
-        // a transaction matches the burst size of the memory (which we
-        // cannot determine without parsing the ini file ourselves)
-        wrapper.enqueue(pkt->isWrite(), pkt->getAddr());
+        // the request size matches the burst size of the memory, which
+        // is checked against the cache line size at init
+        CasHMC_Request req;
+        req.addr = pkt->getAddr();
+        req.size = wrapper.burstSize();
+        req.type = pkt->isWrite() ? CASHMC_DATA_WRITE : CASHMC_DATA_READ;
+        req.priority = 0;
+        pendingRequests.push_back(req);
+
+        // the request is submitted at the next clock edge
+        scheduleTick();
 
         return true;
     } else {
@@ -286,8 +333,7 @@ DRAMSim2::accessAndRespond(PacketPtr pkt)
 
 void DRAMSim2::readComplete(uint64_t addr, uint64_t cycle)
 {
-    assert(cycle == divCeil(curTick() - startTick,
-                            wrapper.clockPeriod() * SimClock::Int::ns));
+    assert(cycle == cycleNow());
 
     DPRINTF(DRAMSim2, "Read to address %lld complete\n", addr);
 
@@ -314,8 +360,7 @@ void DRAMSim2::readComplete(uint64_t addr, uint64_t cycle)
 
 void DRAMSim2::writeComplete(uint64_t addr, uint64_t cycle)
 {
-    assert(cycle == divCeil(curTick() - startTick,
-                            wrapper.clockPeriod() * SimClock::Int::ns));
+    assert(cycle == cycleNow());
 
     DPRINTF(DRAMSim2, "Write to address %lld complete\n", addr);
 
@@ -46,6 +46,7 @@
 
 #include <queue>
 #include <unordered_map>
+#include <vector>
 
 #include "mem/abstract_mem.hh"
 #include "mem/dramsim2_wrapper.hh"
@@ -125,6 +126,17 @@ class DRAMSim2 : public AbstractMemory
     unsigned int nbrOutstandingReads;
     unsigned int nbrOutstandingWrites;
 
+    /**
+     * Requests received since the last tick, which are handed to
+     * CasHMC as one batch at the next clock edge.
+     */
+    std::vector<CasHMC_Request> pendingRequests;
+
+    /**
+     * Buffer for the completions drained from CasHMC every tick.
+     */
+    std::vector<CasHMC_Completion> completions;
+
     /**
      * Queue to hold response packets until we can send them
      * back. This is needed as DRAMSim2 unconditionally passes
@@ -151,10 +163,23 @@ class DRAMSim2 : public AbstractMemory
     EventFunctionWrapper sendResponseEvent;
 
     /**
-     * Progress the controller one clock cycle.
+     * Progress the controller one clock cycle. The ticks are not
+     * scheduled while CasHMC is idle, and the skipped cycles are
+     * caught up at the next tick.
      */
     void tick();
 
+    /**
+     * Schedule the next tick at the next clock edge of CasHMC if it
+     * is not scheduled yet.
+     */
+    void scheduleTick();
+
+    /**
+     * The CasHMC cycle corresponding to the current tick.
+     */
+    uint64_t cycleNow() const;
+
     /**
      * Event to schedule clock ticks
      */
@@ -172,7 +197,7 @@ class DRAMSim2 : public AbstractMemory
     DRAMSim2(const Params *p);
 
     /**
-     * Read completion callback.
+     * Read completion.
      *
      * @param addr Address of the request
      * @param cycle Internal cycle count of CasHMC
@@ -180,7 +205,7 @@ class DRAMSim2 : public AbstractMemory
     void readComplete(uint64_t addr, uint64_t cycle);
 
     /**
-     * Write completion callback.
+     * Write completion.
      *
      * @param addr Address of the request
      * @param cycle Internal cycle count of CasHMC
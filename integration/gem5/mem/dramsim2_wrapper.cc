@@ -41,106 +41,58 @@
 
 #include "mem/dramsim2_wrapper.hh"
 
-#include <fstream>
-
-#include "base/compiler.hh"
 #include "base/logging.hh"
 
 DRAMSim2Wrapper::DRAMSim2Wrapper(const std::string& configSim_file,
                                  const std::string& configDRAM_file,
                                  const std::string& working_dir) :
-    casHMCWrapper(new CasHMC::CasHMCWrapper(working_dir+'/'+configSim_file, working_dir+'/'+configDRAM_file)),
-    _clockPeriod(0.0), _queueSize(0), _burstSize(0)
+    handle(NULL), _clockPeriod(0.0), _queueSize(0), _burstSize(0)
 {
-    // there is no way of getting CasHMC to tell us what frequency
-    // it is assuming, so we have to extract it ourselves
-	_clockPeriod = extractConfig<double>("tCK =", working_dir + '/' + configDRAM_file);
+    if (CasHMC_ApiVersion() != CASHMC_API_VERSION)
+        fatal("CasHMC library API version %d does not match header %d\n",
+              CasHMC_ApiVersion(), CASHMC_API_VERSION);
+
+    handle = CasHMC_Create((working_dir + '/' + configSim_file).c_str(),
+                           (working_dir + '/' + configDRAM_file).c_str());
+
+    // CasHMC is updated every CPU clock (CPU_CLK_PERIOD), and the
+    // request buffer and size are queried from the library
+    _clockPeriod = CasHMC_ClockPeriod(handle);
+    _queueSize = CasHMC_QueueSize(handle);
+    _burstSize = CasHMC_TransactionSize(handle);
 
     if (!_clockPeriod)
         fatal("CasHMC wrapper failed to get clock\n");
 
-    // we also need to know what transaction queue size CasHMC is
-    // using so we can stall when responses are blocked
-	_queueSize = extractConfig<unsigned int>("MAX_REQ_BUF =", working_dir + '/' + configSim_file);
-
     if (!_queueSize)
         fatal("CasHMC wrapper failed to get queue size\n");
 
-
-   // finally, get the data bus bits and burst length so we can add a
-   // sanity check for the burst size
-    unsigned int dataBusBits =
-        extractConfig<unsigned int>("TRANSACTION_SIZE = ", working_dir + '/' + configSim_file);
-
-	unsigned int burstLength = 1;
-
-   if (!dataBusBits || !burstLength)
-       fatal("CasHMC wrapper failed to get burst size\n");
-
-   _burstSize = dataBusBits * burstLength;
+    if (!_burstSize)
+        fatal("CasHMC wrapper failed to get burst size\n");
 }
 
 DRAMSim2Wrapper::~DRAMSim2Wrapper()
 {
-    delete casHMCWrapper;
-}
-
-template <typename T>
-T
-DRAMSim2Wrapper::extractConfig(const std::string& field_name,
-                               const std::string& file_name) const
-{
-    std::ifstream file_stream(file_name.c_str(), ios::in);
-
-    if (!file_stream.good())
-        fatal("CasHMC wrapper could not open %s for reading\n", file_name);
-
-    bool found = false;
-    T res;
-    std::string line;
-    while (!found && file_stream) {
-        getline(file_stream, line);
-        if (line.substr(0, field_name.size()) == field_name) {
-            found = true;
-            istringstream iss(line.substr(field_name.size()));
-            iss >> res;
-        }
-    }
-
-    file_stream.close();
-
-    if (!found)
-        fatal("CasHMC wrapper could not find %s in %s\n", field_name,
-              file_name);
-
-    return res;
+    CasHMC_Destroy(handle);
 }
 
 void
 DRAMSim2Wrapper::printStats()
 {
-	casHMCWrapper->PrintEpochStatistic();
-	casHMCWrapper->PrintFinalStatistic();
-}
-
-void
-DRAMSim2Wrapper::setCallbacks(CasHMC::TransCompCB* read_callback,
-                              CasHMC::TransCompCB* write_callback)
-{
-	casHMCWrapper->RegisterCallbacks(read_callback, write_callback);
+    CasHMC_PrintStatistic(handle);
 }
 
-bool
-DRAMSim2Wrapper::canAccept() const
+unsigned int
+DRAMSim2Wrapper::submit(const CasHMC_Request *requests, unsigned int count)
 {
-    return casHMCWrapper->CanAcceptTran();
+    return CasHMC_Submit(handle, requests, count);
 }
 
-void
-DRAMSim2Wrapper::enqueue(bool is_write, uint64_t addr)
+unsigned int
+DRAMSim2Wrapper::drain(CasHMC_Completion *completions,
+                       unsigned int max_count)
 {
-    bool success M5_VAR_USED = casHMCWrapper->ReceiveTran((is_write ? CasHMC::DATA_WRITE : CasHMC::DATA_READ), addr, _burstSize); 
-    assert(success);
+    return CasHMC_Drain(handle, completions, max_count);
 }
 
 double
@@ -161,8 +113,20 @@ DRAMSim2Wrapper::burstSize() const
     return _burstSize;
 }
 
+uint64_t
+DRAMSim2Wrapper::currentCycle() const
+{
+    return CasHMC_CurrentCycle(handle);
+}
+
+bool
+DRAMSim2Wrapper::isIdle() const
+{
+    return CasHMC_IsIdle(handle);
+}
+
 void
-DRAMSim2Wrapper::tick()
+DRAMSim2Wrapper::run(uint64_t cycles)
 {
-	casHMCWrapper->Update();
+    CasHMC_Run(handle, cycles);
 }
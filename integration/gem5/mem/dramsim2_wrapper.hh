@@ -47,24 +47,21 @@
 
 #include <string>
 
-#include "CasHMC/sources/CasHMCWrapper.h"
-#include "CasHMC/sources/CallBack.h"
-#include "CasHMC/sources/Transaction.h"
+#include "CasHMC/sources/CasHMCApi.h"
 
 /**
- * Wrapper class to avoid having CasHMC names like ClockDomain etc
- * clashing with the normal gem5 world. Many of the CasHMC headers
- * do not make use of namespaces, and quite a few also open up
- * std. The only thing that needs to be exposed externally are the
- * callbacks. This wrapper effectively avoids clashes by not including
- * any of the conventional gem5 headers (e.g. Packet or SimObject).
+ * Wrapper class over the C interface of libcashmc. Only the C header
+ * is included, so none of the CasHMC names (which open up std in
+ * several headers) clash with the normal gem5 world, and the clock,
+ * queue and burst size are queried from CasHMC instead of being
+ * parsed out of the ini files.
  */
 class DRAMSim2Wrapper
 {
 
   private:
 
-    CasHMC::CasHMCWrapper *casHMCWrapper;
+    CasHMC_Handle *handle;
 
     double _clockPeriod;
 
@@ -72,10 +69,6 @@ class DRAMSim2Wrapper
 
     unsigned int _burstSize;
 
-    template <typename T>
-    T extractConfig(const std::string& field_name,
-                    const std::string& file_name) const;
-
   public:
 
     /**
@@ -97,33 +90,30 @@ class DRAMSim2Wrapper
     void printStats();
 
     /**
-     * Set the callbacks to use for read and write completion.
+     * Submit a batch of requests in order. The caller makes sure
+     * that the batch fits in the request buffer.
      *
-     * @param read_callback Callback used for read completions
-     * @param write_callback Callback used for write completions
+     * @param requests Requests to turn into CasHMC transactions
+     * @param count The number of requests
+     * @return The number of accepted requests
      */
-    void setCallbacks(CasHMC::TransCompCB* read_callback,
-                      CasHMC::TransCompCB* write_callback);
+    unsigned int submit(const CasHMC_Request *requests, unsigned int count);
 
     /**
-     * Determine if the controller can accept a new packet or not.
+     * Drain the requests completed so far.
      *
-     * @return true if the controller can accept transactions
+     * @param completions Buffer receiving the completions
+     * @param max_count Size of the buffer
+     * @return The number of drained completions
      */
-    bool canAccept() const;
-
-    /**
-     * Enqueue a packet. This assumes that canAccept has returned true.
-     *
-     * @param pkt Packet to turn into a CasHMC transaction
-     */
-    void enqueue(bool is_write, uint64_t addr);
+    unsigned int drain(CasHMC_Completion *completions,
+                       unsigned int max_count);
 
     /**
      * Get the internal clock period used by CasHMC, specified in
      * ns.
      *
-     * @return The clock period of the DRAM interface in ns
+     * @return The CPU clock period of CasHMC in ns
      */
     double clockPeriod() const;
 
@@ -137,14 +127,30 @@ class DRAMSim2Wrapper
     /**
      * Get the burst size in bytes used by CasHMC.
      *
-     * @return The burst size in bytes (data width * burst length)
+     * @return The request size in bytes (TRANSACTION_SIZE)
      */
     unsigned int burstSize() const;
 
     /**
-     * Progress the memory controller one cycle
+     * Get the current CasHMC cycle.
+     *
+     * @return The number of simulated CPU cycles
+     */
+    uint64_t currentCycle() const;
+
+    /**
+     * Determine if no request is waiting or in flight in CasHMC.
+     *
+     * @return true if the ticks can be skipped until the next request
+     */
+    bool isIdle() const;
+
+    /**
+     * Progress the memory controller the given number of cycles
+     *
+     * @param cycles The number of CPU cycles
      */
-    void tick();
+    void run(uint64_t cycles);
 };
 
-#endif //__MEM_DRAMSIM2_WRAPPER_HH__
\ No newline at end of file
+#endif //__MEM_DRAMSIM2_WRAPPER_HH__
@@ -0,0 +1,398 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+//CasHMCModule.cpp
+//
+//Python extension module (cashmc) over CasHMCWrapper
+// Request batches are read from buffer protocol objects (NumPy arrays, array.array, memoryview) without copying,
+// and statistics and latency histograms are returned as typed memoryviews (numpy.asarray makes no copy).
+//
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>	//max
+#include <vector>		//vector
+
+#include "CasHMCWrapper.h"
+
+using namespace std;
+using namespace CasHMC;
+
+//Configuration values are global, so that only one simulator can be alive at a time
+static bool simulatorAlive = false;
+
+typedef struct
+{
+	PyObject_HEAD
+	CasHMCWrapper *casHMCWrapper;
+	bool running;		//The simulator is running without the GIL
+} PySimulator;
+
+//One column of a request batch (1-D integer buffer, strides are allowed)
+class BatchColumn
+{
+public:
+	BatchColumn():valid(false) {}
+	~BatchColumn() {
+		if(valid)	PyBuffer_Release(&view);
+	}
+	bool Open(PyObject *obj, const char *name) {
+		if(PyObject_GetBuffer(obj, &view, PyBUF_STRIDES | PyBUF_FORMAT) < 0)	return false;
+		valid = true;
+		const char *fmt = view.format;
+		if(*fmt == '@' || *fmt == '=' || *fmt == '<')	fmt++;
+		type = *fmt;
+		if(view.ndim != 1 || fmt[0] == 0 || fmt[1] != 0 || string("bBhHiIlLqQnN").find(type) == string::npos) {
+			PyErr_Format(PyExc_TypeError, "%s must be a 1-D integer array (format '%s')", name, view.format);
+			return false;
+		}
+		return true;
+	}
+	Py_ssize_t Size() {
+		return view.shape[0];
+	}
+	uint64_t operator[](Py_ssize_t i) {
+		const char *p = (const char *)view.buf + i*view.strides[0];
+		switch(type) {
+			case 'b':	return *(const int8_t *)p;
+			case 'B':	return *(const uint8_t *)p;
+			case 'h':	return *(const short *)p;
+			case 'H':	return *(const unsigned short *)p;
+			case 'i':	return *(const int *)p;
+			case 'I':	return *(const unsigned *)p;
+			case 'l':	return *(const long *)p;
+			case 'L':	return *(const unsigned long *)p;
+			case 'q':	return *(const long long *)p;
+			case 'Q':	return *(const unsigned long long *)p;
+			case 'n':	return *(const Py_ssize_t *)p;
+			default:	return *(const size_t *)p;
+		}
+	}
+
+	Py_buffer view;
+	bool valid;
+	char type;
+};
+
+//
+//Make a typed memoryview (format 'Q' or 'd') of the given shape over a new bytes object
+//
+static PyObject *MakeArray(const void *data, size_t itemSize, const char *format, Py_ssize_t rows, Py_ssize_t cols)
+{
+	PyObject *bytes = PyBytes_FromStringAndSize((const char *)data, rows*max(cols, (Py_ssize_t)1)*itemSize);
+	if(bytes == NULL)	return NULL;
+	PyObject *view = PyMemoryView_FromObject(bytes);
+	Py_DECREF(bytes);
+	if(view == NULL)	return NULL;
+	PyObject *shape = (cols == 0) ? Py_BuildValue("(n)", rows) : Py_BuildValue("(nn)", rows, cols);
+	PyObject *typed = PyObject_CallMethod(view, "cast", "sO", format, shape);
+	Py_DECREF(view);
+	Py_XDECREF(shape);
+	return typed;
+}
+
+//
+//Check if the simulator can be used by the calling thread
+//
+static bool CheckSimulator(PySimulator *self)
+{
+	if(self->casHMCWrapper == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "simulator is closed");
+		return false;
+	}
+	if(self->running) {
+		PyErr_SetString(PyExc_RuntimeError, "simulator is running in another thread");
+		return false;
+	}
+	return true;
+}
+
+//
+//No request is waiting or in flight (every request holds a tag until it is completed)
+//
+static bool IsIdle(CasHMCWrapper *casHMCWrapper)
+{
+	return casHMCWrapper->hmcCont->downBuffers.empty() && casHMCWrapper->hmcCont->tagPool->inFlight == 0;
+}
+
+static int Simulator_init(PySimulator *self, PyObject *args, PyObject *kwds)
+{
+	static const char *kwlist[] = {"sim_cfg", "dram_cfg", NULL};
+	const char *simCfg = "ConfigSim.ini";
+	const char *dramCfg = "ConfigDRAM.ini";
+	if(!PyArg_ParseTupleAndKeywords(args, kwds, "|ss", (char **)kwlist, &simCfg, &dramCfg))	return -1;
+	if(self->casHMCWrapper != NULL || simulatorAlive) {
+		PyErr_SetString(PyExc_RuntimeError, "only one simulator can be alive at a time (close the previous one)");
+		return -1;
+	}
+	if(access(simCfg, 0) == -1 || access(dramCfg, 0) == -1) {
+		PyErr_Format(PyExc_FileNotFoundError, "there is no configuration file [%s] or [%s]", simCfg, dramCfg);
+		return -1;
+	}
+	self->casHMCWrapper = new CasHMCWrapper(simCfg, dramCfg);
+	self->running = false;
+	simulatorAlive = true;
+	return 0;
+}
+
+//
+//Delete the wrapper (the final statistic is written to the result log)
+//
+static void Simulator_release(PySimulator *self)
+{
+	if(self->casHMCWrapper != NULL) {
+		delete self->casHMCWrapper;
+		self->casHMCWrapper = NULL;
+		simulatorAlive = false;
+	}
+}
+
+static void Simulator_dealloc(PySimulator *self)
+{
+	Simulator_release(self);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Simulator_close(PySimulator *self, PyObject *unused)
+{
+	if(self->running) {
+		PyErr_SetString(PyExc_RuntimeError, "simulator is running in another thread");
+		return NULL;
+	}
+	Simulator_release(self);
+	Py_RETURN_NONE;
+}
+
+//
+//Advance the simulation by the given CPU cycles
+//
+static PyObject *Simulator_run(PySimulator *self, PyObject *args)
+{
+	unsigned long long cycles;
+	if(!PyArg_ParseTuple(args, "K", &cycles))	return NULL;
+	if(!CheckSimulator(self))	return NULL;
+
+	CasHMCWrapper *casHMCWrapper = self->casHMCWrapper;
+	self->running = true;
+	Py_BEGIN_ALLOW_THREADS
+	for(uint64_t c=0; c<cycles; c++) {
+		casHMCWrapper->Update();
+	}
+	Py_END_ALLOW_THREADS
+	self->running = false;
+	return PyLong_FromUnsignedLongLong(casHMCWrapper->currentClockCycle);
+}
+
+//
+//Issue a request batch in order (the same timing as trace file mode) and optionally run until all requests are completed
+//
+static PyObject *Simulator_run_batch(PySimulator *self, PyObject *args, PyObject *kwds)
+{
+	static const char *kwlist[] = {"cycle", "addr", "type", "size", "priority", "drain", NULL};
+	PyObject *cycleObj, *addrObj, *typeObj, *sizeObj, *priorityObj = Py_None;
+	int drain = 1;
+	if(!PyArg_ParseTupleAndKeywords(args, kwds, "OOOO|Op", (char **)kwlist,
+									&cycleObj, &addrObj, &typeObj, &sizeObj, &priorityObj, &drain))	return NULL;
+	if(!CheckSimulator(self))	return NULL;
+
+	BatchColumn cycle, addr, type, size, priority;
+	if(!cycle.Open(cycleObj, "cycle") || !addr.Open(addrObj, "addr")
+	|| !type.Open(typeObj, "type") || !size.Open(sizeObj, "size"))	return NULL;
+	bool hasPriority = (priorityObj != Py_None);
+	if(hasPriority && !priority.Open(priorityObj, "priority"))	return NULL;
+
+	Py_ssize_t count = cycle.Size();
+	if(addr.Size() != count || type.Size() != count || size.Size() != count || (hasPriority && priority.Size() != count)) {
+		PyErr_SetString(PyExc_ValueError, "request arrays must have the same length");
+		return NULL;
+	}
+	//The whole batch is checked before the simulation starts (a bad request would exit the interpreter in the simulator)
+	for(Py_ssize_t i=0; i<count; i++) {
+		if(type[i] > ATM_SWAP16 || type[i] == RETURN_DATA) {
+			PyErr_Format(PyExc_ValueError, "unknown transaction type %llu at %zd", (unsigned long long)type[i], i);
+			return NULL;
+		}
+		if((type[i] == DATA_READ || type[i] == DATA_WRITE)
+		&& (size[i] % 16 != 0 || size[i] < 16 || (size[i] > 128 && size[i] != 256))) {
+			PyErr_Format(PyExc_ValueError, "size %llu at %zd should be 16, 32, 48, 64, 80, 96, 112, 128, or 256",
+							(unsigned long long)size[i], i);
+			return NULL;
+		}
+		if(hasPriority && priority[i] >= (uint64_t)QOS_CLASSES) {
+			PyErr_Format(PyExc_ValueError, "priority %llu at %zd is not smaller than QOS_CLASSES (%d)",
+							(unsigned long long)priority[i], i, QOS_CLASSES);
+			return NULL;
+		}
+	}
+
+	CasHMCWrapper *casHMCWrapper = self->casHMCWrapper;
+	self->running = true;
+	Py_BEGIN_ALLOW_THREADS
+	for(Py_ssize_t i=0; i<count; i++) {
+		while(casHMCWrapper->currentClockCycle < cycle[i]) {
+			casHMCWrapper->Update();
+		}
+		//One request is issued per cycle at most
+		while(!casHMCWrapper->CanAcceptTran()) {
+			casHMCWrapper->Update();
+		}
+		casHMCWrapper->ReceiveTran((TransactionType)type[i], addr[i], size[i], NULL, hasPriority ? priority[i] : 0);
+		casHMCWrapper->Update();
+	}
+	if(drain) {
+		while(!IsIdle(casHMCWrapper)) {
+			casHMCWrapper->Update();
+		}
+	}
+	Py_END_ALLOW_THREADS
+	self->running = false;
+	return PyLong_FromUnsignedLongLong(casHMCWrapper->currentClockCycle);
+}
+
+//
+//Statistics accumulated so far (total and the current epoch) and latency histograms
+//
+static PyObject *Simulator_stats(PySimulator *self, PyObject *unused)
+{
+	if(!CheckSimulator(self))	return NULL;
+	CasHMCWrapper *w = self->casHMCWrapper;
+
+	uint64_t reads = 0, writes = 0, atomics = 0;
+	for(int i=0; i<NUM_LINKS; i++) {
+		reads += w->totalReadPerLink[i] + w->readPerLink[i];
+		writes += w->totalWritePerLink[i] + w->writePerLink[i];
+		atomics += w->totalAtomicPerLink[i] + w->atomicPerLink[i];
+	}
+	uint64_t tranCount = w->totalTranCount + w->tranFullLat.size();
+	uint64_t latencySum = w->totalTranFullSum + w->tranFullSum;
+	unsigned latencyMax = w->totalTranFullMax;
+	for(unsigned i=0; i<w->tranFullLat.size(); i++) {
+		latencyMax = max(latencyMax, w->tranFullLat[i]);
+	}
+
+	//Latency histograms [bucket] (bucket lower bounds are given in hist_bucket_cycles)
+	vector<uint64_t> classHist(QOS_CLASSES*NUM_STAGE_HIST);
+	for(int c=0; c<QOS_CLASSES; c++) {
+		for(int b=0; b<NUM_STAGE_HIST; b++) {
+			classHist[c*NUM_STAGE_HIST + b] = w->classHist[c][b];
+		}
+	}
+	vector<uint64_t> stageHist(NUM_STAGES*NUM_STAGE_HIST);
+	vector<double> stageMean(NUM_STAGES);
+	uint64_t stageCount = w->totalStageCount + w->stageCount;
+	for(int s=0; s<NUM_STAGES; s++) {
+		for(int b=0; b<NUM_STAGE_HIST; b++) {
+			stageHist[s*NUM_STAGE_HIST + b] = w->totalStageHist[s][b] + w->stageHist[s][b];
+		}
+		stageMean[s] = (stageCount==0 ? 0 : (double)(w->totalStageSum[s] + w->stageSum[s])/stageCount*CPU_CLK_PERIOD);
+	}
+	vector<uint64_t> bucketCycles(NUM_STAGE_HIST);
+	for(int b=0; b<NUM_STAGE_HIST; b++) {
+		bucketCycles[b] = HistBucketValue(b);
+	}
+	PyObject *stageNames = PyTuple_New(NUM_STAGES);
+	if(stageNames == NULL)	return NULL;
+	for(int s=0; s<NUM_STAGES; s++) {
+		PyTuple_SET_ITEM(stageNames, s, PyUnicode_FromString(StageName(s).c_str()));
+	}
+
+	uint64_t hmcBytes = w->totalHmcTransmitSize + w->hmcTransmitSize;
+	double elapsedTime = (double)(w->currentClockCycle*CPU_CLK_PERIOD*1E-9);
+	return Py_BuildValue("{s:K,s:d,s:K,s:K,s:K,s:K,s:d,s:d,s:K,s:d,s:N,s:N,s:N,s:N,s:N,s:i}",
+		"cycles",				(unsigned long long)w->currentClockCycle,
+		"clock_period_ns",		CPU_CLK_PERIOD,
+		"transactions",			(unsigned long long)tranCount,
+		"reads",				(unsigned long long)reads,
+		"writes",				(unsigned long long)writes,
+		"atomics",				(unsigned long long)atomics,
+		"latency_mean_ns",		(tranCount==0 ? 0 : (double)latencySum/tranCount*CPU_CLK_PERIOD),
+		"latency_max_ns",		latencyMax*CPU_CLK_PERIOD,
+		"hmc_bytes",			(unsigned long long)hmcBytes,
+		"bandwidth_gbps",		(elapsedTime==0 ? 0 : hmcBytes/elapsedTime/(1<<30)),
+		"latency_hist",			MakeArray(&classHist[0], sizeof(uint64_t), "Q", QOS_CLASSES, NUM_STAGE_HIST),
+		"stage_hist",			MakeArray(&stageHist[0], sizeof(uint64_t), "Q", NUM_STAGES, NUM_STAGE_HIST),
+		"stage_mean_ns",		MakeArray(&stageMean[0], sizeof(double), "d", NUM_STAGES, 0),
+		"hist_bucket_cycles",	MakeArray(&bucketCycles[0], sizeof(uint64_t), "Q", NUM_STAGE_HIST, 0),
+		"stage_names",			stageNames,
+		"qos_classes",			QOS_CLASSES);
+}
+
+static PyObject *Simulator_get_cycle(PySimulator *self, void *closure)
+{
+	if(!CheckSimulator(self))	return NULL;
+	return PyLong_FromUnsignedLongLong(self->casHMCWrapper->currentClockCycle);
+}
+
+static PyObject *Simulator_get_idle(PySimulator *self, void *closure)
+{
+	if(!CheckSimulator(self))	return NULL;
+	return PyBool_FromLong(IsIdle(self->casHMCWrapper));
+}
+
+static PyMethodDef Simulator_methods[] = {
+	{"run", (PyCFunction)Simulator_run, METH_VARARGS,
+		"run(cycles) -> cycle\nAdvance the simulation by the given CPU cycles."},
+	{"run_batch", (PyCFunction)(void(*)(void))Simulator_run_batch, METH_VARARGS | METH_KEYWORDS,
+		"run_batch(cycle, addr, type, size, priority=None, drain=True) -> cycle\n"
+		"Issue requests in order at their CPU cycles (1-D integer arrays, not copied).\n"
+		"With drain, the simulation runs until all requests are completed."},
+	{"stats", (PyCFunction)Simulator_stats, METH_NOARGS,
+		"stats() -> dict\nStatistics and latency histograms accumulated so far."},
+	{"close", (PyCFunction)Simulator_close, METH_NOARGS,
+		"close()\nFinish the simulation and write the result log."},
+	{NULL}
+};
+
+static PyGetSetDef Simulator_getset[] = {
+	{(char *)"cycle", (getter)Simulator_get_cycle, NULL, (char *)"Current CPU cycle", NULL},
+	{(char *)"idle", (getter)Simulator_get_idle, NULL, (char *)"No request is waiting or in flight", NULL},
+	{NULL}
+};
+
+static PyTypeObject SimulatorType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	"cashmc.Simulator",			//tp_name
+	sizeof(PySimulator),	//tp_basicsize
+};
+
+static PyModuleDef cashmcModule = {
+	PyModuleDef_HEAD_INIT,
+	"cashmc",
+	"CasHMC: A Cycle-accurate Simulator for Hybrid Memory Cube",
+	-1,
+	NULL
+};
+
+PyMODINIT_FUNC PyInit_cashmc(void)
+{
+	SimulatorType.tp_dealloc = (destructor)Simulator_dealloc;
+	SimulatorType.tp_flags = Py_TPFLAGS_DEFAULT;
+	SimulatorType.tp_doc = "Simulator(sim_cfg='ConfigSim.ini', dram_cfg='ConfigDRAM.ini')";
+	SimulatorType.tp_methods = Simulator_methods;
+	SimulatorType.tp_getset = Simulator_getset;
+	SimulatorType.tp_init = (initproc)Simulator_init;
+	SimulatorType.tp_new = PyType_GenericNew;
+	if(PyType_Ready(&SimulatorType) < 0)	return NULL;
+
+	PyObject *module = PyModule_Create(&cashmcModule);
+	if(module == NULL)	return NULL;
+	Py_INCREF(&SimulatorType);
+	if(PyModule_AddObject(module, "Simulator", (PyObject *)&SimulatorType) < 0) {
+		Py_DECREF(&SimulatorType);
+		Py_DECREF(module);
+		return NULL;
+	}
+	PyModule_AddIntConstant(module, "DATA_READ", DATA_READ);
+	PyModule_AddIntConstant(module, "DATA_WRITE", DATA_WRITE);
+	PyModule_AddIntConstant(module, "NUM_HIST_BUCKETS", NUM_STAGE_HIST);
+	return module;
+}
@@ -0,0 +1,161 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include "AddressMap.h"
+
+namespace CasHMC
+{
+
+AddressMap::AddressMap(string order, string vaultHash, string bankHash):
+	orderSpec(order),
+	vaultHashSpec(vaultHash),
+	bankHashSpec(bankHash)
+{
+	blockBit = _log2(ADDRESS_MAPPING);
+	fieldWidth[FIELD_VAULT] = _log2(NUM_VAULTS);
+	fieldWidth[FIELD_BANK] = _log2(NUM_BANKS);
+	fieldWidth[FIELD_COL] = _log2(NUM_COLS) - blockBit;
+	fieldWidth[FIELD_ROW] = _log2(NUM_ROWS);
+	
+	//Fields are placed from LSB (the last field in the order) to MSB
+	vector<AddressField> fields = ParseFields(order, false);
+	if(fields.size() != NUM_FIELDS) {
+		ERROR(" == Error - ADDRESS_ORDER ["<<order<<"] must have VA, BA, CO, and RO fields only once");
+		exit(0);
+	}
+	unsigned shift = blockBit;
+	for(int f=fields.size()-1; f>=0; f--) {
+		for(int g=f-1; g>=0; g--) {
+			if(fields[f] == fields[g]) {
+				ERROR(" == Error - ADDRESS_ORDER ["<<order<<"] has duplicated field "<<FieldName(fields[f]));
+				exit(0);
+			}
+		}
+		fieldShift[fields[f]] = shift;
+		fieldMask[fields[f]] = ((uint64_t)1 << fieldWidth[fields[f]]) - 1;
+		shift += fieldWidth[fields[f]];
+	}
+	
+	MakeHashMask(vaultHashMask, FIELD_VAULT, vaultHash);
+	MakeHashMask(bankHashMask, FIELD_BANK, bankHash);
+}
+
+AddressMap::~AddressMap()
+{
+	vaultHashMask.clear();
+	bankHashMask.clear();
+}
+
+//
+//Parse field list separated by '_' (e.g. RO_CO_BA_VA)
+//
+vector<AddressField> AddressMap::ParseFields(string spec, bool allowNone)
+{
+	vector<AddressField> fields;
+	if(allowNone && spec == "NONE") {
+		return fields;
+	}
+	stringstream ss(spec);
+	string token;
+	while(getline(ss, token, '_')) {
+		if(token == "VA")		fields.push_back(FIELD_VAULT);
+		else if(token == "BA")	fields.push_back(FIELD_BANK);
+		else if(token == "CO")	fields.push_back(FIELD_COL);
+		else if(token == "RO")	fields.push_back(FIELD_ROW);
+		else {
+			ERROR(" == Error - Unknown address field ["<<token<<"] in ["<<spec<<"] (VA, BA, CO, RO, or NONE)");
+			exit(0);
+		}
+	}
+	return fields;
+}
+
+//
+//Precompute XOR-fold masks (source field bit j is folded into target bit j % target width)
+// Only column and row fields can be sources so that the mapping stays invertible
+//
+void AddressMap::MakeHashMask(vector<uint64_t> &hashMask, AddressField target, string spec)
+{
+	hashMask = vector<uint64_t>(fieldWidth[target], 0);
+	vector<AddressField> sources = ParseFields(spec, true);
+	if(fieldWidth[target] == 0)	return;
+	
+	for(int s=0; s<sources.size(); s++) {
+		if(sources[s] != FIELD_COL && sources[s] != FIELD_ROW) {
+			ERROR(" == Error - "<<FieldName(sources[s])<<" field can't be XOR-folded into "<<FieldName(target)<<" field (only CO and RO)");
+			exit(0);
+		}
+		for(int j=0; j<fieldWidth[sources[s]]; j++) {
+			hashMask[j % fieldWidth[target]] |= (uint64_t)1 << (fieldShift[sources[s]] + j);
+		}
+	}
+}
+
+//
+//Extract a field index with XOR-folded bits
+//
+unsigned AddressMap::HashIndex(uint64_t addr, AddressField target, vector<uint64_t> &hashMask)
+{
+	unsigned index = (addr >> fieldShift[target]) & fieldMask[target];
+	for(int i=0; i<hashMask.size(); i++) {
+		index ^= (__builtin_parityll(addr & hashMask[i]) << i);
+	}
+	return index;
+}
+
+//
+//Vault index of physical address (crossbar switch)
+//
+unsigned AddressMap::Vault(uint64_t addr)
+{
+	return HashIndex(addr, FIELD_VAULT, vaultHashMask);
+}
+
+//
+//Mapping physical address to vault, bank, column, and row (column is byte address)
+//
+void AddressMap::Decode(uint64_t addr, unsigned &vault, unsigned &bank, unsigned &col, unsigned &row)
+{
+	vault = HashIndex(addr, FIELD_VAULT, vaultHashMask);
+	bank = HashIndex(addr, FIELD_BANK, bankHashMask);
+	col = ((addr >> fieldShift[FIELD_COL]) & fieldMask[FIELD_COL]) << blockBit;
+	row = (addr >> fieldShift[FIELD_ROW]) & fieldMask[FIELD_ROW];
+}
+
+//
+//Restore physical address from vault, bank, column, and row
+// (hash sources are column and row bits, so XORing them again gives the original vault and bank bits)
+//
+uint64_t AddressMap::Encode(unsigned vault, unsigned bank, unsigned col, unsigned row)
+{
+	uint64_t addr = 0;
+	addr |= (uint64_t)((col >> blockBit) & fieldMask[FIELD_COL]) << fieldShift[FIELD_COL];
+	addr |= (uint64_t)(row & fieldMask[FIELD_ROW]) << fieldShift[FIELD_ROW];
+	
+	unsigned plainVault = HashIndex(addr, FIELD_VAULT, vaultHashMask) ^ vault;
+	unsigned plainBank = HashIndex(addr, FIELD_BANK, bankHashMask) ^ bank;
+	addr |= (uint64_t)(plainVault & fieldMask[FIELD_VAULT]) << fieldShift[FIELD_VAULT];
+	addr |= (uint64_t)(plainBank & fieldMask[FIELD_BANK]) << fieldShift[FIELD_BANK];
+	return addr;
+}
+
+string AddressMap::FieldName(AddressField field)
+{
+	switch(field) {
+		case FIELD_VAULT:	return "VA";
+		case FIELD_BANK:	return "BA";
+		case FIELD_COL:		return "CO";
+		case FIELD_ROW:		return "RO";
+		default:			return "??";
+	}
+}
+
+} //namespace CasHMC
@@ -0,0 +1,76 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef ADDRESSMAP_H
+#define ADDRESSMAP_H
+
+//AddressMap.h
+
+#include <stdint.h>		//uint64_t
+#include <stdlib.h>		//exit(0)
+#include <string>		//string
+#include <sstream>		//stringstream
+#include <vector>		//vector
+
+#include "ConfigValue.h"
+
+#define MAX_HASH_BITS	32
+
+using namespace std;
+
+namespace CasHMC
+{
+
+enum AddressField
+{
+	FIELD_VAULT,	//VA
+	FIELD_BANK,		//BA
+	FIELD_COL,		//CO
+	FIELD_ROW,		//RO
+	NUM_FIELDS
+};
+
+//Table-driven address mapping shared by crossbar switch (vault select) and vault controller (bank, column, and row decode)
+// order : field order from MSB to LSB above the max block offset (e.g. RO_CO_BA_VA)
+// vaultHash, bankHash : fields XOR-folded into vault and bank index (NONE, RO, CO, or RO_CO)
+class AddressMap
+{
+public:
+	//
+	//Functions
+	//
+	AddressMap(string order, string vaultHash, string bankHash);
+	virtual ~AddressMap();
+	vector<AddressField> ParseFields(string spec, bool allowNone);
+	void MakeHashMask(vector<uint64_t> &hashMask, AddressField target, string spec);
+	unsigned HashIndex(uint64_t addr, AddressField target, vector<uint64_t> &hashMask);
+	unsigned Vault(uint64_t addr);
+	void Decode(uint64_t addr, unsigned &vault, unsigned &bank, unsigned &col, unsigned &row);
+	uint64_t Encode(unsigned vault, unsigned bank, unsigned col, unsigned row);
+	string FieldName(AddressField field);
+
+	//
+	//Fields
+	//
+	string orderSpec;
+	string vaultHashSpec;
+	string bankHashSpec;
+	unsigned blockBit;
+	unsigned fieldShift[NUM_FIELDS];	//Address bit position of each field
+	unsigned fieldWidth[NUM_FIELDS];	//The number of bits of each field
+	uint64_t fieldMask[NUM_FIELDS];		//Field mask after shift
+	vector<uint64_t> vaultHashMask;		//Address bits XOR-folded into each vault index bit
+	vector<uint64_t> bankHashMask;		//Address bits XOR-folded into each bank index bit
+};
+
+}
+
+#endif
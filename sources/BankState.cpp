@@ -11,58 +11,227 @@
 
 #include "BankState.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>	//SSE4.2 and AVX2 intrinsics
+#define BANK_SIMD
+#endif
+
+#define BANK_NEVER	((uint64_t)INT64_MAX)	//Timing of padded banks (never reached in signed 64-bit comparison)
+
 namespace CasHMC
 {
-	
-BankState::BankState(unsigned id):
-	bankID(id)
+
+//
+//Scalar kernels
+//
+static BankReadyMask ReadyMaskScalar(BankState &bs, uint64_t clock)
+{
+	BankReadyMask ready;
+	for(unsigned b=0; b<bs.numBanks; b++) {
+		uint64_t bit = (uint64_t)1 << b;
+		if(bs.currentBankState[b] == ROW_ACTIVE) {
+			if(bs.nextRead[b] <= clock)			ready.read |= bit;
+			if(bs.nextWrite[b] <= clock)		ready.write |= bit;
+			if(bs.nextPrecharge[b] <= clock)	ready.precharge |= bit;
+		}
+		else if(bs.currentBankState[b] == IDLE || bs.currentBankState[b] == REFRESHING) {
+			if(bs.nextActivate[b] <= clock)		ready.activate |= bit;
+		}
+	}
+	return ready;
+}
+
+static uint64_t CountdownScalar(BankState &bs)
+{
+	uint64_t expired = 0;
+	for(unsigned b=0; b<bs.numBanks; b++) {
+		if(bs.stateChangeCountdown[b] > 0) {
+			bs.stateChangeCountdown[b]--;
+			if(bs.stateChangeCountdown[b] == 0)	expired |= (uint64_t)1 << b;
+		}
+	}
+	return expired;
+}
+
+#ifdef BANK_SIMD
+//
+//SSE4.2 kernels (2 banks of 64-bit timing, or 4 banks of 32-bit countdown at once)
+//
+__attribute__((target("sse4.2")))
+static BankReadyMask ReadyMaskSSE42(BankState &bs, uint64_t clock)
+{
+	BankReadyMask ready;
+	__m128i clk = _mm_set1_epi64x(clock);
+	__m128i idle = _mm_set1_epi64x(IDLE);
+	__m128i active = _mm_set1_epi64x(ROW_ACTIVE);
+	__m128i refreshing = _mm_set1_epi64x(REFRESHING);
+	for(unsigned b=0; b<bs.paddedBanks; b+=2) {
+		__m128i state = _mm_cvtepu32_epi64(_mm_loadl_epi64((__m128i *)&bs.currentBankState[b]));
+		__m128i isActive = _mm_cmpeq_epi64(state, active);
+		__m128i isClosed = _mm_or_si128(_mm_cmpeq_epi64(state, idle), _mm_cmpeq_epi64(state, refreshing));
+		//Ready when the next time is not greater than the clock
+		__m128i actWait = _mm_cmpgt_epi64(_mm_loadu_si128((__m128i *)&bs.nextActivate[b]), clk);
+		__m128i readWait = _mm_cmpgt_epi64(_mm_loadu_si128((__m128i *)&bs.nextRead[b]), clk);
+		__m128i writeWait = _mm_cmpgt_epi64(_mm_loadu_si128((__m128i *)&bs.nextWrite[b]), clk);
+		__m128i preWait = _mm_cmpgt_epi64(_mm_loadu_si128((__m128i *)&bs.nextPrecharge[b]), clk);
+		ready.activate |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_andnot_si128(actWait, isClosed))) << b;
+		ready.read |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_andnot_si128(readWait, isActive))) << b;
+		ready.write |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_andnot_si128(writeWait, isActive))) << b;
+		ready.precharge |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_andnot_si128(preWait, isActive))) << b;
+	}
+	return ready;
+}
+
+__attribute__((target("sse4.2")))
+static uint64_t CountdownSSE42(BankState &bs)
+{
+	uint64_t expired = 0;
+	__m128i zero = _mm_setzero_si128();
+	__m128i one = _mm_set1_epi32(1);
+	for(unsigned b=0; b<bs.paddedBanks; b+=4) {
+		__m128i count = _mm_loadu_si128((__m128i *)&bs.stateChangeCountdown[b]);
+		__m128i running = _mm_andnot_si128(_mm_cmpeq_epi32(count, zero), _mm_set1_epi32(-1));
+		count = _mm_sub_epi32(count, _mm_and_si128(running, one));
+		_mm_storeu_si128((__m128i *)&bs.stateChangeCountdown[b], count);
+		__m128i reached = _mm_and_si128(running, _mm_cmpeq_epi32(count, zero));
+		expired |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(reached)) << b;
+	}
+	return expired;
+}
+
+//
+//AVX2 kernels (4 banks of 64-bit timing, or 8 banks of 32-bit countdown at once)
+//
+__attribute__((target("avx2")))
+static BankReadyMask ReadyMaskAVX2(BankState &bs, uint64_t clock)
+{
+	BankReadyMask ready;
+	__m256i clk = _mm256_set1_epi64x(clock);
+	__m256i idle = _mm256_set1_epi64x(IDLE);
+	__m256i active = _mm256_set1_epi64x(ROW_ACTIVE);
+	__m256i refreshing = _mm256_set1_epi64x(REFRESHING);
+	for(unsigned b=0; b<bs.paddedBanks; b+=4) {
+		__m256i state = _mm256_cvtepu32_epi64(_mm_loadu_si128((__m128i *)&bs.currentBankState[b]));
+		__m256i isActive = _mm256_cmpeq_epi64(state, active);
+		__m256i isClosed = _mm256_or_si256(_mm256_cmpeq_epi64(state, idle), _mm256_cmpeq_epi64(state, refreshing));
+		//Ready when the next time is not greater than the clock
+		__m256i actWait = _mm256_cmpgt_epi64(_mm256_loadu_si256((__m256i *)&bs.nextActivate[b]), clk);
+		__m256i readWait = _mm256_cmpgt_epi64(_mm256_loadu_si256((__m256i *)&bs.nextRead[b]), clk);
+		__m256i writeWait = _mm256_cmpgt_epi64(_mm256_loadu_si256((__m256i *)&bs.nextWrite[b]), clk);
+		__m256i preWait = _mm256_cmpgt_epi64(_mm256_loadu_si256((__m256i *)&bs.nextPrecharge[b]), clk);
+		ready.activate |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_andnot_si256(actWait, isClosed))) << b;
+		ready.read |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_andnot_si256(readWait, isActive))) << b;
+		ready.write |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_andnot_si256(writeWait, isActive))) << b;
+		ready.precharge |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_andnot_si256(preWait, isActive))) << b;
+	}
+	return ready;
+}
+
+__attribute__((target("avx2")))
+static uint64_t CountdownAVX2(BankState &bs)
+{
+	uint64_t expired = 0;
+	__m256i zero = _mm256_setzero_si256();
+	__m256i one = _mm256_set1_epi32(1);
+	for(unsigned b=0; b<bs.paddedBanks; b+=8) {
+		__m256i count = _mm256_loadu_si256((__m256i *)&bs.stateChangeCountdown[b]);
+		__m256i running = _mm256_andnot_si256(_mm256_cmpeq_epi32(count, zero), _mm256_set1_epi32(-1));
+		count = _mm256_sub_epi32(count, _mm256_and_si256(running, one));
+		_mm256_storeu_si256((__m256i *)&bs.stateChangeCountdown[b], count);
+		__m256i reached = _mm256_and_si256(running, _mm256_cmpeq_epi32(count, zero));
+		expired |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(reached)) << b;
+	}
+	return expired;
+}
+#endif
+
+BankState::BankState():
+	numBanks(NUM_BANKS)
+{
+	if(numBanks < 1 || numBanks > MAX_BANKS) {
+		ERROR(" == Error - The number of banks per vault (NUM_BANKS : "<<numBanks<<") should be 1 ~ "<<MAX_BANKS);
+		exit(0);
+	}
+	//Padded banks never become ready and never count down
+	paddedBanks = (numBanks + BANK_PADDING-1) / BANK_PADDING * BANK_PADDING;
+	currentBankState = vector<BankStateType>(paddedBanks, NUM_BANK_STATES);
+	openRowAddress = vector<unsigned>(paddedBanks, 0);
+	nextActivate = vector<uint64_t>(paddedBanks, BANK_NEVER);
+	nextRead = vector<uint64_t>(paddedBanks, BANK_NEVER);
+	nextWrite = vector<uint64_t>(paddedBanks, BANK_NEVER);
+	nextPrecharge = vector<uint64_t>(paddedBanks, BANK_NEVER);
+	nextPowerUp = vector<uint64_t>(paddedBanks, 0);
+	lastCommand = vector<DRAMCommandType>(paddedBanks, PRECHARGE);
+	stateChangeCountdown = vector<uint32_t>(paddedBanks, 0);
+	for(unsigned b=0; b<numBanks; b++) {
+		currentBankState[b] = IDLE;
+		nextActivate[b] = 0;
+		nextRead[b] = 0;
+		nextWrite[b] = 0;
+		nextPrecharge[b] = 0;
+	}
+
+	kernel = BANK_SCALAR;
+#ifdef BANK_SIMD
+	if(__builtin_cpu_supports("avx2"))			kernel = BANK_AVX2;
+	else if(__builtin_cpu_supports("sse4.2"))	kernel = BANK_SSE42;
+#endif
+}
+
+//
+//Banks able to accept ACT, READ, WRITE, and PRE at the clock
+//
+BankReadyMask BankState::ReadyMask(uint64_t clock)
 {
-	currentBankState = IDLE;
-	openRowAddress = 0;
-	nextActivate = 0;
-	nextRead = 0;
-	nextWrite = 0;
-	nextPrecharge = 0;
-	nextPowerUp = 0;
-	lastCommand = PRECHARGE;
-	stateChangeCountdown = 0;
+	switch(kernel) {
+#ifdef BANK_SIMD
+		case BANK_AVX2:		return ReadyMaskAVX2(*this, clock);
+		case BANK_SSE42:	return ReadyMaskSSE42(*this, clock);
+#endif
+		default:			return ReadyMaskScalar(*this, clock);
+	}
 }
 
-void BankState::UpdateStateChange()
+//
+//Decrement running state change countdowns (banks whose countdown reaches 0 are returned)
+//
+uint64_t BankState::Countdown()
 {
+	switch(kernel) {
+#ifdef BANK_SIMD
+		case BANK_AVX2:		return CountdownAVX2(*this);
+		case BANK_SSE42:	return CountdownSSE42(*this);
+#endif
+		default:			return CountdownScalar(*this);
+	}
+}
 
+string BankState::KernelName()
+{
+	switch(kernel) {
+		case BANK_AVX2:		return "AVX2";
+		case BANK_SSE42:	return "SSE4.2";
+		default:			return "Scalar";
+	}
 }
 
 //
-//Defines "<<" operation for printing
+//Bank state name for printing
 //
-ostream &operator<<(ostream &out, const BankState &bs)
+string BankStateName(BankStateType state)
 {
-	switch(bs.currentBankState) {
-		case IDLE:
-			out<<"Idle";
-			break;
-		case ROW_ACTIVE:
-			out<<"Actv";
-			break;
-		case PRECHARGING:
-			out<<"Prch";
-			break;
-		case REFRESHING:
-			out<<"Refr";
-			break;
-		case POWERDOWN:
-			out<<"Pwdw";
-			break;
-		case AWAKING:
-			out<<"Awak";
-			break;
+	switch(state) {
+		case IDLE:			return "Idle";
+		case ROW_ACTIVE:	return "Actv";
+		case PRECHARGING:	return "Prch";
+		case REFRESHING:	return "Refr";
+		case POWERDOWN:		return "Pwdw";
+		case AWAKING:		return "Awak";
 		default:
 			ERROR(" (BS) == Error - Trying to print unknown kind of bank state");
-			ERROR("         Type : "<<bs.currentBankState);
+			ERROR("         Type : "<<(unsigned)state);
 			exit(0);
 	}
-	return out;
 }
 
-} //namespace CasHMC
\ No newline at end of file
+} //namespace CasHMC
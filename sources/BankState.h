@@ -13,56 +13,90 @@
 #define BANKSTATE_H
 
 //BankState.h
+//
+//Bank states of one vault stored as arrays (one element per bank)
+// Issuable banks and expired state countdowns are found by SIMD kernels (AVX2 or SSE4.2 selected at run time,
+// and the scalar kernel otherwise), and the results are returned as bitmasks (bit b is bank b).
+//
 
 #include <stdint.h>		//uint64_t
 #include <stdlib.h>		//exit(0)
 #include <iomanip>		//setw()
 #include <iostream> 	//ostream
+#include <string>		//string
+#include <vector>		//vector
 
 #include "ConfigValue.h"
 #include "DRAMCommand.h"
 
+#define MAX_BANKS		64		//Banks of one vault are held in a 64-bit mask
+#define BANK_PADDING	8		//Arrays are padded to a multiple of the widest SIMD kernel (8 x 32-bit)
+
 using namespace std;
 
 namespace CasHMC
 {
-enum BankStateType
+enum BankStateType : uint32_t
 {
 	IDLE,
 	ROW_ACTIVE,
 	PRECHARGING,
 	REFRESHING,
 	POWERDOWN,
-	AWAKING
-};	
-	
+	AWAKING,
+	NUM_BANK_STATES
+};
+
+enum BankKernelType
+{
+	BANK_SCALAR,
+	BANK_SSE42,
+	BANK_AVX2
+};
+
+//Banks that can accept each command type at a clock (timing and bank state only)
+class BankReadyMask
+{
+public:
+	BankReadyMask():activate(0), read(0), write(0), precharge(0) {}
+	uint64_t Any() const {return activate | read | write | precharge;}
+
+	uint64_t activate;	//IDLE or REFRESHING bank after nextActivate
+	uint64_t read;		//ROW_ACTIVE bank after nextRead
+	uint64_t write;		//ROW_ACTIVE bank after nextWrite
+	uint64_t precharge;	//ROW_ACTIVE bank after nextPrecharge
+};
+
 class BankState
 {
 public:
 	//
 	//Functions
 	//
-	BankState(unsigned id);
-	void UpdateStateChange();
+	BankState();
+	BankReadyMask ReadyMask(uint64_t clock);
+	uint64_t Countdown();
+	string KernelName();
 
 	//
 	//Fields
 	//
-	unsigned bankID;
-	
-	BankStateType currentBankState;
-	unsigned openRowAddress;
-	uint64_t nextActivate;
-	uint64_t nextRead;
-	uint64_t nextWrite;
-	uint64_t nextPrecharge;
-	uint64_t nextPowerUp;
+	unsigned numBanks;
+	unsigned paddedBanks;
+	BankKernelType kernel;
 
-	DRAMCommandType lastCommand;
-	unsigned stateChangeCountdown;
+	vector<BankStateType> currentBankState;
+	vector<unsigned> openRowAddress;
+	vector<uint64_t> nextActivate;
+	vector<uint64_t> nextRead;
+	vector<uint64_t> nextWrite;
+	vector<uint64_t> nextPrecharge;
+	vector<uint64_t> nextPowerUp;
+	vector<DRAMCommandType> lastCommand;
+	vector<uint32_t> stateChangeCountdown;
 };
 
-ostream &operator<<(ostream &out, const BankState &bs);
+string BankStateName(BankStateType state);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,159 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include <deque>		//deque
+
+#include "CasHMCApi.h"
+#include "CasHMCWrapper.h"
+
+using namespace std;
+using namespace CasHMC;
+
+//Request type values of C interface should match TransactionType
+typedef char CheckReadType[(CASHMC_DATA_READ == DATA_READ) ? 1 : -1];
+typedef char CheckWriteType[(CASHMC_DATA_WRITE == DATA_WRITE) ? 1 : -1];
+
+struct CasHMC_Handle
+{
+	CasHMC_Handle(const char *simCfg, const char *dramCfg) {
+		casHMCWrapper = new CasHMCWrapper(simCfg, dramCfg);
+		readCB = new Callback<CasHMC_Handle, void, uint64_t, uint64_t>(this, &CasHMC_Handle::ReadComplete);
+		writeCB = new Callback<CasHMC_Handle, void, uint64_t, uint64_t>(this, &CasHMC_Handle::WriteComplete);
+		casHMCWrapper->RegisterCallbacks(readCB, writeCB);
+	}
+	~CasHMC_Handle() {
+		casHMCWrapper->RegisterCallbacks(NULL, NULL);
+		delete casHMCWrapper;
+		delete readCB;
+		delete writeCB;
+	}
+	void ReadComplete(uint64_t addr, uint64_t cycle) {
+		CasHMC_Completion comp = {addr, cycle, 0, 0};
+		completions.push_back(comp);
+	}
+	void WriteComplete(uint64_t addr, uint64_t cycle) {
+		CasHMC_Completion comp = {addr, cycle, 1, 0};
+		completions.push_back(comp);
+	}
+
+	CasHMCWrapper *casHMCWrapper;
+	TransCompCB *readCB;
+	TransCompCB *writeCB;
+	deque<CasHMC_Completion> completions;	//Completed requests waiting to be drained
+};
+
+extern "C" {
+
+int CasHMC_ApiVersion(void)
+{
+	return CASHMC_API_VERSION;
+}
+
+CasHMC_Handle *CasHMC_Create(const char *simCfg, const char *dramCfg)
+{
+	return new CasHMC_Handle(simCfg, dramCfg);
+}
+
+void CasHMC_Destroy(CasHMC_Handle *handle)
+{
+	delete handle;
+}
+
+double CasHMC_ClockPeriod(CasHMC_Handle *handle)
+{
+	return CPU_CLK_PERIOD;
+}
+
+unsigned CasHMC_QueueSize(CasHMC_Handle *handle)
+{
+	return MAX_REQ_BUF;
+}
+
+unsigned CasHMC_TransactionSize(CasHMC_Handle *handle)
+{
+	return TRANSACTION_SIZE;
+}
+
+uint64_t CasHMC_CurrentCycle(CasHMC_Handle *handle)
+{
+	return handle->casHMCWrapper->currentClockCycle;
+}
+
+unsigned CasHMC_Submit(CasHMC_Handle *handle, const CasHMC_Request *requests, unsigned count)
+{
+	CasHMCWrapper *wrapper = handle->casHMCWrapper;
+	unsigned accepted = 0;
+	while(accepted < count && wrapper->CanAcceptTran()) {
+		const CasHMC_Request &req = requests[accepted];
+		unsigned size = (req.size == 0) ? TRANSACTION_SIZE : req.size;
+		if(!wrapper->ReceiveTran((TransactionType)req.type, req.addr, size, NULL, req.priority))	break;
+		accepted++;
+	}
+	return accepted;
+}
+
+unsigned CasHMC_Drain(CasHMC_Handle *handle, CasHMC_Completion *completions, unsigned maxCount)
+{
+	unsigned drained = 0;
+	while(drained < maxCount && !handle->completions.empty()) {
+		completions[drained++] = handle->completions.front();
+		handle->completions.pop_front();
+	}
+	return drained;
+}
+
+unsigned CasHMC_PendingCompletions(CasHMC_Handle *handle)
+{
+	return handle->completions.size();
+}
+
+void CasHMC_Run(CasHMC_Handle *handle, uint64_t cycles)
+{
+	CasHMCWrapper *wrapper = handle->casHMCWrapper;
+	for(uint64_t c=0; c<cycles; c++) {
+		wrapper->Update();
+	}
+}
+
+int CasHMC_IsIdle(CasHMC_Handle *handle)
+{
+	//Every request in flight holds a tag until it is completed (including posted requests)
+	HMCController *hmcCont = handle->casHMCWrapper->hmcCont;
+	return hmcCont->downBuffers.empty() && hmcCont->tagPool->inFlight == 0;
+}
+
+void CasHMC_PrintStatistic(CasHMC_Handle *handle)
+{
+	handle->casHMCWrapper->PrintEpochStatistic();
+	handle->casHMCWrapper->PrintFinalStatistic();
+}
+
+void CasHMC_ResetStatistic(CasHMC_Handle *handle)
+{
+	handle->casHMCWrapper->ResetStatistic();
+}
+
+void CasHMC_DumpStatistic(CasHMC_Handle *handle)
+{
+	handle->casHMCWrapper->SnapshotStatistic();
+}
+
+void CasHMC_BeginROI(CasHMC_Handle *handle)
+{
+	handle->casHMCWrapper->BeginROI();
+}
+
+void CasHMC_EndROI(CasHMC_Handle *handle)
+{
+	handle->casHMCWrapper->EndROI();
+}
+
+}
@@ -0,0 +1,85 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef CASHMCAPI_H
+#define CASHMCAPI_H
+
+//CasHMCApi.h
+//
+//C interface of libcashmc for host simulators (gem5 and the other integration layers)
+// All functions take the handle returned by CasHMC_Create, and a handle is used by one thread at a time.
+//
+
+#include <stdint.h>		//uint64_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CASHMC_API_VERSION	1
+
+//Request types (the same values as CasHMC::TransactionType, and the other atomic types can be used as well)
+#define CASHMC_DATA_READ	0
+#define CASHMC_DATA_WRITE	1
+
+typedef struct CasHMC_Handle CasHMC_Handle;
+
+//One request of a batch
+typedef struct CasHMC_Request
+{
+	uint64_t addr;
+	uint32_t size;		//[byte] 16 ~ 128 (multiple of 16) or 256
+	uint16_t type;		//CASHMC_DATA_READ, CASHMC_DATA_WRITE, or CasHMC::TransactionType
+	uint16_t priority;	//QoS class (smaller than QOS_CLASSES)
+} CasHMC_Request;
+
+//One completed request (read/write completion callback of HMC controller)
+typedef struct CasHMC_Completion
+{
+	uint64_t addr;
+	uint64_t cycle;		//[CPU clock] Completion time
+	uint32_t isWrite;
+	uint32_t reserved;
+} CasHMC_Completion;
+
+int CasHMC_ApiVersion(void);
+CasHMC_Handle *CasHMC_Create(const char *simCfg, const char *dramCfg);
+void CasHMC_Destroy(CasHMC_Handle *handle);
+
+//Explicit configuration queries (instead of parsing ini files)
+double CasHMC_ClockPeriod(CasHMC_Handle *handle);		//[ns] CPU clock period of one CasHMC_Run cycle
+unsigned CasHMC_QueueSize(CasHMC_Handle *handle);		//[transaction] HMC controller request buffer (MAX_REQ_BUF)
+unsigned CasHMC_TransactionSize(CasHMC_Handle *handle);	//[byte] Default request size (TRANSACTION_SIZE)
+uint64_t CasHMC_CurrentCycle(CasHMC_Handle *handle);
+
+//Batched request submission (requests are accepted in order, and the number of accepted requests is returned)
+unsigned CasHMC_Submit(CasHMC_Handle *handle, const CasHMC_Request *requests, unsigned count);
+//Completion draining (up to maxCount completions in completion order, and the number of drained completions is returned)
+unsigned CasHMC_Drain(CasHMC_Handle *handle, CasHMC_Completion *completions, unsigned maxCount);
+unsigned CasHMC_PendingCompletions(CasHMC_Handle *handle);
+
+//Advance the simulation by the given CPU cycles in one call
+void CasHMC_Run(CasHMC_Handle *handle, uint64_t cycles);
+//No request is waiting or in flight (the host can skip ticks until the next request and catch up with CasHMC_Run)
+int CasHMC_IsIdle(CasHMC_Handle *handle);
+
+void CasHMC_PrintStatistic(CasHMC_Handle *handle);
+//Statistics control (region of interest of the host workload, and the result log without reset)
+void CasHMC_ResetStatistic(CasHMC_Handle *handle);
+void CasHMC_DumpStatistic(CasHMC_Handle *handle);
+void CasHMC_BeginROI(CasHMC_Handle *handle);
+void CasHMC_EndROI(CasHMC_Handle *handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
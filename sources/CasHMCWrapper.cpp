@@ -28,17 +28,32 @@ CasHMCWrapper::CasHMCWrapper(string simCfg, string dramCfg)
 	ReadIniFile(simCfg);
 	ReadIniFile(dramCfg);
 	PushStatisPerLink();
+	PushStatisPerClass();
 	
 	//
 	//Class variable initialization
 	//
 	currentClockCycle = 0;
+	printEpoch = true;
+	laneEnergyLast = 0;
+	metricsOut = NULL;
+	statStartCycle = 0;
+	epochStartCycle = 0;
+	roiActive = false;
+	roiNum = 0;
+	snapshotNum = 0;
+	logDebug = DEBUG_SIM;
+	logState = STATE_SIM;
 	dramTuner = 1;
 	downLinkTuner = 1;
 	downLinkClock = 1;
 	upLinkTuner = 1;
 	upLinkClock = 1;
 	linkPeriod = (1/LINK_SPEED);
+#ifdef PROFILE
+	profStartTSC = ReadTSC();
+	profStartWall = ReadWallNs();
+#endif
 	
 	//Make class objects
 	downstreamLinks.reserve(NUM_LINKS);
@@ -49,6 +64,11 @@ CasHMCWrapper::CasHMCWrapper(string simCfg, string dramCfg)
 	}
 	hmcCont = new HMCController(debugOut, stateOut);
 	hmc = new HMC(debugOut, stateOut);
+	hmcCont->addressMap = hmc->addressMap;
+	hmc->crossbarSwitch->tagPool = hmcCont->tagPool;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		hmc->vaultControllers[v]->tagPool = hmcCont->tagPool;
+	}
 	
 	//Link master, Link, and Link slave are linked each other by respective lanes
 	for(int l=0; l<NUM_LINKS; l++) {
@@ -68,6 +88,36 @@ CasHMCWrapper::CasHMCWrapper(string simCfg, string dramCfg)
 		hmcCont->upLinkSlaves[l]->upBufferDest = hmcCont;
 		hmcCont->upLinkSlaves[l]->localLinkMaster = hmcCont->downLinkMasters[l];
 	}
+	
+	//Host side and cube side are connected by cycle-stamped pipes in pipeline simulation
+	downPipe = NULL;
+	upPipe = NULL;
+	stopCube = false;
+	cubeRandSeed = 1;
+	if(PIPELINE_SIM) {
+		if(DEBUG_SIM || STATE_SIM) {
+			ERROR(" == Error - DEBUG_SIM and STATE_SIM should be false in pipeline simulation (PIPELINE_SIM)");
+			exit(0);
+		}
+		downPipe = new LinkPipe();
+		upPipe = new LinkPipe();
+		cubeStatis.PushStatisPerLink();
+		cubeRandSeed = rand();
+		for(int l=0; l<NUM_LINKS; l++) {
+			downstreamLinks[l]->pipe = downPipe;
+			upstreamLinks[l]->pipe = upPipe;
+			upstreamLinks[l]->statis = &cubeStatis;
+		}
+		hmc->crossbarSwitch->upPipe = upPipe;
+		for(int v=0; v<NUM_VAULTS; v++) {
+			hmc->vaultControllers[v]->upPipe = upPipe;
+		}
+	}
+	//Debug and state logs are opened at the beginning of region of interest
+	if(ROI_LOG_ONLY) {
+		DEBUG_SIM = false;
+		STATE_SIM = false;
+	}
 
 	//Check CPU clock cycle and link speed
 	if(CPU_CLK_PERIOD < linkPeriod) {	//Check CPU clock cycle and link speed
@@ -218,12 +268,28 @@ CasHMCWrapper::CasHMCWrapper(string simCfg, string dramCfg)
 	logName.erase(logName.find("_s"));
 	logNum = 0;
 	PrintEpochHeader();
+	if(METRICS_OUT) {
+		InitMetrics();
+	}
+	
+	if(PIPELINE_SIM) {
+		cubeThread = thread(&CasHMCWrapper::CubeLoop, this);
+	}
 }
 
 CasHMCWrapper::~CasHMCWrapper()
 {
+	//Region of interest open at the end of simulation is closed
+	if(roiActive)	EndROI();
+	if(PIPELINE_SIM) {
+		SyncCube();
+		if(currentClockCycle > 0)	DrainUpPipe(currentClockCycle-1);
+		stopCube = true;
+		cubeThread.join();
+	}
 	PrintEpochStatistic();
 	PrintFinalStatistic();
+	delete metricsOut;
 	debugOut.flush();		debugOut.close();
 	stateOut.flush();		stateOut.close();
 	plotDataOut.flush();	plotDataOut.close();
@@ -240,6 +306,8 @@ CasHMCWrapper::~CasHMCWrapper()
 	hmcCont = NULL;
 	delete hmc;
 	hmc = NULL;
+	delete downPipe;
+	delete upPipe;
 }
 
 //
@@ -253,9 +321,9 @@ void CasHMCWrapper::RegisterCallbacks(TransCompCB *readCB, TransCompCB *writeCB)
 //
 //Check buffer available space and receive transaction
 //
-bool CasHMCWrapper::ReceiveTran(TransactionType tranType, uint64_t addr, unsigned size)
+bool CasHMCWrapper::ReceiveTran(TransactionType tranType, uint64_t addr, unsigned size, uint8_t *data, unsigned priority)
 {
-	Transaction *newTran = new Transaction(tranType, addr, size, this);
+	Transaction *newTran = new Transaction(tranType, addr, size, this, data, priority);
 
 	if(hmcCont->ReceiveDown(newTran)) {
 		DE_CR(ALI(18)<<" (BUS)"<<ALI(15)<<*newTran<<"Down) SENDING transaction to HMC controller (HC)");
@@ -298,13 +366,22 @@ void CasHMCWrapper::UpdateMSHR(unsigned mshr)
 //
 void CasHMCWrapper::Update()
 {
+	//Statistics are collected after the cube thread catches up with the host
+	if(PIPELINE_SIM && currentClockCycle > 0
+	&& (((BANDWIDTH_PLOT || METRICS_OUT) && currentClockCycle%PLOT_SAMPLING == 0) || currentClockCycle%LOG_EPOCH == 0)) {
+		SyncCube();
+	}
+	
 	if(BANDWIDTH_PLOT && currentClockCycle > 0 && currentClockCycle%PLOT_SAMPLING == 0) {
 		MakePlotData();
 	}
+	if(METRICS_OUT && currentClockCycle > 0 && currentClockCycle%PLOT_SAMPLING == 0 && (!ROI_LOG_ONLY || roiActive)) {
+		MakeMetricsData();
+	}
 	
 #ifdef DEBUG_LOG
 	if(currentClockCycle > 0 && currentClockCycle%LOG_EPOCH == 0) {
-		cout<<"\n   === Simulation ["<<currentClockCycle/LOG_EPOCH<<"] epoch starts  ( CPU clk:"<<currentClockCycle<<" ) ===   "<<endl;
+		if(printEpoch)	cout<<"\n   === Simulation ["<<currentClockCycle/LOG_EPOCH<<"] epoch starts  ( CPU clk:"<<currentClockCycle<<" ) ===   "<<endl;
 		PrintEpochStatistic();
 		if(DEBUG_SIM) {
 			debugOut.flush();	debugOut.close();
@@ -322,10 +399,11 @@ void CasHMCWrapper::Update()
 	//update all class (HMC controller, links, and HMC block)
 	//Roughly synchronize CPU clock cycle, link speed, and HMC clock cycle
 	//
-	hmcCont->Update();
+	if(PIPELINE_SIM)	downPipe->producerCycle = currentClockCycle;
+	PROFILE_CALL(hmcCont->profile, hmcCont->Update());
 	//Link master and slave are separately updated to flow packet from master to slave regardless of downstream or upstream
 	for(int l=0; l<NUM_LINKS; l++) {
-		hmcCont->downLinkMasters[l]->Update();
+		PROFILE_CALL(hmcCont->downLinkMasters[l]->profile, hmcCont->downLinkMasters[l]->Update());
 	}
 	
 		//Downstream links update at CPU clock cycle (depending on ratio of CPU cycle to Link cycle)
@@ -339,43 +417,20 @@ void CasHMCWrapper::Update()
 		}
 		DownLinkUpdate(true);
 	
-			//HMC update at CPU clock cycle
-			if(CPU_CLK_PERIOD <= tCK) {
-				if(CPU_CLK_PERIOD*dramTuner > tCK*hmc->clockTuner) {
-					hmc->Update();
-				}
-				else if(CPU_CLK_PERIOD*dramTuner == tCK*hmc->clockTuner) {
-					dramTuner = 0;
-					hmc->clockTuner = 0;
-					hmc->Update();
-				}
-			}
-			else {
-				while(CPU_CLK_PERIOD*dramTuner > tCK*(hmc->clockTuner + 1)) {
-					hmc->Update();
-				}
-				if(CPU_CLK_PERIOD*dramTuner == tCK*(hmc->clockTuner + 1)) {
-					hmc->Update();
-					dramTuner = 0;
-					hmc->clockTuner = 0;
-				}
-				hmc->Update();
-			}
-		
-		//Upstream links update at CPU clock cycle (depending on ratio of CPU cycle to Link cycle)
-		while(CPU_CLK_PERIOD*upLinkTuner > linkPeriod*(upLinkClock + 1)) {
-			UpLinkUpdate(false);
-		}
-		if(CPU_CLK_PERIOD*upLinkTuner == linkPeriod*(upLinkClock + 1)) {
-			UpLinkUpdate(false);
-			upLinkTuner = 0;
-			upLinkClock = 0;
-		}
-		UpLinkUpdate(true);
+	if(PIPELINE_SIM) {
+		//HMC and upstream links of this cycle are updated on the cube thread,
+		// and the host receives what the cube thread sent in the previous cycle
+		downPipe->Finish(currentClockCycle + 1);
+		upPipe->Wait(currentClockCycle, stopCube);
+		if(currentClockCycle > 0)	DrainUpPipe(currentClockCycle-1);
+	}
+	else {
+		CubeUpdate();
+	}
 	
 	//Link master and slave are separately updated to flow packet from master to slave regardless of downstream or upstream
 	for(int l=0; l<NUM_LINKS; l++) {
-		hmcCont->upLinkSlaves[l]->Update();
+		PROFILE_CALL(hmcCont->upLinkSlaves[l]->profile, hmcCont->upLinkSlaves[l]->Update());
 	}
 	
 #ifndef DEBUG_LOG
@@ -389,9 +444,11 @@ void CasHMCWrapper::Update()
 		for(int l=0; l<NUM_LINKS; l++) {
 			downstreamLinks[l]->PrintState();
 		}
+		if(!PIPELINE_SIM) {
 			hmc->PrintState();
-		for(int l=0; l<NUM_LINKS; l++) {
-			upstreamLinks[l]->PrintState();
+			for(int l=0; l<NUM_LINKS; l++) {
+				upstreamLinks[l]->PrintState();
+			}
 		}
 	for(int l=0; l<NUM_LINKS; l++) {
 		hmcCont->upLinkSlaves[l]->PrintState();
@@ -399,9 +456,108 @@ void CasHMCWrapper::Update()
 	
 	currentClockCycle++;
 	downLinkTuner++;
+	DE_ST("\n---------------------------------------[ CPU clk:"<<currentClockCycle<<" / HMC clk:"<<hmc->currentClockCycle<<" ]---------------------------------------");
+}
+
+//
+//Updates HMC block and upstream links (cube side of a CPU clock cycle)
+//
+void CasHMCWrapper::CubeUpdate()
+{
+	//HMC update at CPU clock cycle
+	if(CPU_CLK_PERIOD <= tCK) {
+		if(CPU_CLK_PERIOD*dramTuner > tCK*hmc->clockTuner) {
+			PROFILE_CALL(hmc->profile, hmc->Update());
+		}
+		else if(CPU_CLK_PERIOD*dramTuner == tCK*hmc->clockTuner) {
+			dramTuner = 0;
+			hmc->clockTuner = 0;
+			PROFILE_CALL(hmc->profile, hmc->Update());
+		}
+	}
+	else {
+		while(CPU_CLK_PERIOD*dramTuner > tCK*(hmc->clockTuner + 1)) {
+			PROFILE_CALL(hmc->profile, hmc->Update());
+		}
+		if(CPU_CLK_PERIOD*dramTuner == tCK*(hmc->clockTuner + 1)) {
+			PROFILE_CALL(hmc->profile, hmc->Update());
+			dramTuner = 0;
+			hmc->clockTuner = 0;
+		}
+		PROFILE_CALL(hmc->profile, hmc->Update());
+	}
+	
+	//Upstream links update at CPU clock cycle (depending on ratio of CPU cycle to Link cycle)
+	while(CPU_CLK_PERIOD*upLinkTuner > linkPeriod*(upLinkClock + 1)) {
+		UpLinkUpdate(false);
+	}
+	if(CPU_CLK_PERIOD*upLinkTuner == linkPeriod*(upLinkClock + 1)) {
+		UpLinkUpdate(false);
+		upLinkTuner = 0;
+		upLinkClock = 0;
+	}
+	UpLinkUpdate(true);
+	
 	upLinkTuner++;
 	dramTuner++;
-	DE_ST("\n---------------------------------------[ CPU clk:"<<currentClockCycle<<" / HMC clk:"<<hmc->currentClockCycle<<" ]---------------------------------------");
+}
+
+//
+//Cube thread of pipeline simulation (a cycle starts after the host hands off the downstream packets of the cycle)
+//
+void CasHMCWrapper::CubeLoop()
+{
+	simRandSeed = &cubeRandSeed;
+	for(uint64_t cycle=0; ; cycle++) {
+		if(!downPipe->Wait(cycle + 1, stopCube))	return;
+		upPipe->producerCycle = cycle;
+		//Downstream packets sent by the host in the previous cycle
+		PipeEntry *entry;
+		while(cycle > 0 && (entry = downPipe->Front(cycle-1)) != NULL) {
+			hmc->downLinkSlaves[entry->index]->linkRxTx.push_back(entry->packet);
+			downPipe->Pop();
+		}
+		CubeUpdate();
+		upPipe->Finish(cycle + 1);
+	}
+}
+
+//
+//Receive upstream packets, posted tags, and traces that the cube thread sent until the given cycle
+//
+void CasHMCWrapper::DrainUpPipe(uint64_t cycle)
+{
+	PipeEntry *entry;
+	while((entry = upPipe->Front(cycle)) != NULL) {
+		switch(entry->type) {
+			case PIPE_PACKET:
+				hmcCont->upLinkSlaves[entry->index]->linkRxTx.push_back(entry->packet);
+				if(entry->packet->packetType == RESPONSE)
+					entry->packet->trace->linkFullLat = entry->cycle - entry->packet->trace->linkTransmitTime;
+				break;
+			case PIPE_TAG_SEGMENT:
+				hmcCont->tagPool->AddSegment(entry->index, entry->value);
+				break;
+			case PIPE_TAG_FREE:
+				hmcCont->tagPool->Free(entry->index);
+				break;
+			case PIPE_TRACE:
+				delete entry->trace;
+				break;
+		}
+		upPipe->Pop();
+	}
+}
+
+//
+//Wait until the cube thread finishes every cycle before the current cycle, and collect its link statistics
+// (the cube thread does not start the current cycle until Update is called)
+//
+void CasHMCWrapper::SyncCube()
+{
+	if(!PIPELINE_SIM)	return;
+	upPipe->Wait(currentClockCycle, stopCube);
+	MergeLinkStatis(cubeStatis);
 }
 
 //
@@ -410,7 +566,7 @@ void CasHMCWrapper::Update()
 void CasHMCWrapper::DownLinkUpdate(bool lastUpdate)
 {
 	for(int l=0; l<NUM_LINKS; l++) {
-		downstreamLinks[l]->Update(lastUpdate);
+		PROFILE_CALL(downstreamLinks[l]->profile, downstreamLinks[l]->Update(lastUpdate));
 	}
 	downLinkClock++;
 }
@@ -418,7 +574,7 @@ void CasHMCWrapper::DownLinkUpdate(bool lastUpdate)
 void CasHMCWrapper::UpLinkUpdate(bool lastUpdate)
 {
 	for(int l=0; l<NUM_LINKS; l++) {
-		upstreamLinks[l]->Update(lastUpdate);
+		PROFILE_CALL(upstreamLinks[l]->profile, upstreamLinks[l]->Update(lastUpdate));
 	}
 	upLinkClock++;
 }
@@ -539,9 +695,19 @@ void CasHMCWrapper::PrintSetting(struct tm t)
 	
 	settingOut<<endl<<"        ==== Memory transaction setting ===="<<endl;
 	settingOut<<ALI(36)<<" CPU cycles to be simulated : "<<numSimCycles<<endl;
+	settingOut<<ALI(36)<<" Pipeline simulation (host/cube) : "<<(PIPELINE_SIM ? "Enable" : "Disable")<<endl;
+	settingOut<<ALI(36)<<" Metrics time-series (CSV/binary) : "<<(METRICS_CSV ? "Enable" : "Disable")<<" / "<<(METRICS_BINARY ? "Enable" : "Disable")<<endl;
+	settingOut<<ALI(36)<<" Logs only in region of interest : "<<(ROI_LOG_ONLY ? "Enable" : "Disable")<<endl;
 	settingOut<<ALI(36)<<" CPU clock period [ns] : "<<CPU_CLK_PERIOD<<endl;
 	settingOut<<ALI(36)<<" Data size of DRAM request [byte] : "<<TRANSACTION_SIZE<<endl;
 	settingOut<<ALI(36)<<" Request buffer max size : "<<MAX_REQ_BUF<<endl;
+	settingOut<<ALI(36)<<" Host issue width : "<<HOST_ISSUE_WIDTH<<endl;
+	settingOut<<ALI(36)<<" Host retire width : "<<HOST_RETIRE_WIDTH<<endl;
+	settingOut<<ALI(36)<<" Request tag pool size : "<<NUM_TAGS<<endl;
+	settingOut<<ALI(36)<<" QoS priority classes : "<<QOS_CLASSES<<endl;
+	if(QOS_CLASSES > 1) {
+		settingOut<<ALI(36)<<" QoS bypass limit : "<<QOS_BYPASS_LIMIT<<endl;
+	}
 	settingOut<<ALI(36)<<" Trace type : "<<traceType<<endl;
 	if(traceType == "random") {
 		settingOut<<ALI(36)<<" Frequency of requests : "<<memUtil<<endl;
@@ -558,6 +724,17 @@ void CasHMCWrapper::PrintSetting(struct tm t)
 	settingOut<<ALI(36)<<" Link speed [Gb/s] : "<<LINK_SPEED<<endl;
 	settingOut<<ALI(36)<<" Link master/slave max buffer size: "<<MAX_LINK_BUF<<endl;
 	settingOut<<ALI(36)<<" Crossbar switch buffer size : "<<MAX_CROSS_BUF<<endl;
+	if(CROSSBAR_MODEL == VOQ) {
+		settingOut<<ALI(36)<<" Crossbar switch model : "<<"VOQ"<<endl;
+		settingOut<<ALI(36)<<" Crossbar switch allocator : "<<(CROSSBAR_ALLOC == ISLIP ? "ISLIP" : "WAVEFRONT")<<endl;
+		if(CROSSBAR_ALLOC == ISLIP) {
+			settingOut<<ALI(36)<<" iSLIP iterations : "<<CROSSBAR_ITER<<endl;
+		}
+		settingOut<<ALI(36)<<" VOQ input buffer size : "<<MAX_VOQ_BUF<<endl;
+	}
+	else {
+		settingOut<<ALI(36)<<" Crossbar switch model : "<<"SHARED_BUF"<<endl;
+	}
 	settingOut<<ALI(36)<<" Retry buffer max size : "<<MAX_RETRY_BUF<<endl;
 	settingOut<<ALI(36)<<" Time to calculate CRC [clk] : "<<CRC_CAL_CYCLE<<endl;
 	settingOut<<ALI(36)<<" The number of IRTRY packet : "<<NUM_OF_IRTRY<<endl;
@@ -570,6 +747,15 @@ void CasHMCWrapper::PrintSetting(struct tm t)
 	case BUFFER_AWARE:
 		settingOut<<ALI(36)<<" Link priority scheme : "<<"BUFFER_AWARE"<<endl;
 		break;
+	case ADDRESS_HASH:
+		settingOut<<ALI(36)<<" Link priority scheme : "<<"ADDRESS_HASH"<<endl;
+		break;
+	case LEAST_FLITS:
+		settingOut<<ALI(36)<<" Link priority scheme : "<<"LEAST_FLITS"<<endl;
+		break;
+	case LATENCY_AWARE:
+		settingOut<<ALI(36)<<" Link priority scheme : "<<"LATENCY_AWARE"<<endl;
+		break;
 	default:
 		settingOut<<ALI(36)<<" Link priority scheme : "<<LINK_PRIORITY<<endl;
 		break;
@@ -601,23 +787,59 @@ void CasHMCWrapper::PrintSetting(struct tm t)
 		settingOut<<ALI(36)<<" Scaling factor of MSHR : "<<MSHR_SCALING<<endl;
 		settingOut<<ALI(36)<<" Scaling factor of link monitor : "<<LINK_SCALING<<endl;
 	}
+	settingOut<<ALI(36)<<" Lane power [mW/Gb] : "<<PowPerLane<<endl;
+	settingOut<<ALI(36)<<" Flit energy [pJ/bit] : "<<FlitEnergy<<endl;
 	
 	settingOut<<endl<<"              ==== DRAM general setting ===="<<endl;
 	settingOut<<ALI(36)<<" Memory density : "<<MEMORY_DENSITY<<endl;
 	settingOut<<ALI(36)<<" The number of vaults : "<<NUM_VAULTS<<endl;
 	settingOut<<ALI(36)<<" The number of banks : "<<NUM_BANKS<<endl;
+	settingOut<<ALI(36)<<" Bank state scan kernel : "<<hmc->drams[0]->bankStates.KernelName()<<endl;
 	settingOut<<ALI(36)<<" The number of rows : "<<NUM_ROWS<<endl;
 	settingOut<<ALI(36)<<" The number of columns : "<<NUM_COLS<<endl;
 	settingOut<<ALI(36)<<" Address mapping (Max block size) : "<<ADDRESS_MAPPING<<endl;
+	settingOut<<ALI(36)<<" Address field order (MSB-LSB) : "<<ADDRESS_ORDER<<endl;
+	settingOut<<ALI(36)<<" Vault index XOR hashing : "<<VAULT_HASH<<endl;
+	settingOut<<ALI(36)<<" Bank index XOR hashing : "<<BANK_HASH<<endl;
 	settingOut<<ALI(36)<<" Vault controller max buffer size : "<<MAX_VLT_BUF<<endl;
 	settingOut<<ALI(36)<<" Command queue max size : "<<MAX_CMD_QUE<<endl;
 	settingOut<<ALI(36)<<" Command queue structure : "<<(QUE_PER_BANK ? "Bank-level command queue (Bank-Level parallelism)" : "Vault-level command queue (Non bank-Level parallelism)")<<endl;
 	settingOut<<ALI(36)<<" Memory scheduling : "<<(OPEN_PAGE ? "open page policy" : "close page policy" )<<endl;
 	settingOut<<ALI(36)<<" The maximum row buffer accesses : "<<MAX_ROW_ACCESSES<<endl;
+	switch(ROW_POLICY) {
+	case STATIC:
+		settingOut<<ALI(36)<<" Row-buffer management : "<<"STATIC"<<endl;
+		break;
+	case TIMEOUT:
+		settingOut<<ALI(36)<<" Row-buffer management : "<<"TIMEOUT ("<<ROW_TIMEOUT<<" clk)"<<endl;
+		break;
+	case PREDICT:
+		settingOut<<ALI(36)<<" Row-buffer management : "<<"PREDICT"<<endl;
+		break;
+	case HIT_RATE:
+		settingOut<<ALI(36)<<" Row-buffer management : "<<"HIT_RATE ("<<ROW_HIT_THRESHOLD<<" % / "<<ROW_WINDOW<<" accesses)"<<endl;
+		break;
+	}
 	settingOut<<ALI(36)<<" Power-down mode : "<<(USE_LOW_POWER ? "Enable" : "Disable")<<endl;
+	settingOut<<ALI(36)<<" Functional memory : "<<(FUNCTIONAL_MEM ? "Enable" : "Disable")<<endl;
+	settingOut<<ALI(36)<<" Write-drain scheduling : "<<(WRITE_DRAIN ? "Enable" : "Disable")<<endl;
+	if(WRITE_DRAIN) {
+		settingOut<<ALI(36)<<" Write high / low watermark : "<<WRITE_HIGH_WATERMARK<<" / "<<WRITE_LOW_WATERMARK<<endl;
+	}
 	
 	settingOut<<endl<<" ==== DRAM timing setting ===="<<endl;
 	settingOut<<" Refresh period : "<<REFRESH_PERIOD<<endl;
+	switch(REFRESH_POLICY) {
+	case ALL_BANK:
+		settingOut<<" Refresh policy : "<<"ALL_BANK"<<endl;
+		break;
+	case PER_BANK:
+		settingOut<<" Refresh policy : "<<"PER_BANK"<<endl;
+		break;
+	case ELASTIC:
+		settingOut<<" Refresh policy : "<<"ELASTIC (max postponed : "<<REFRESH_MAX_POSTPONE<<")"<<endl;
+		break;
+	}
 	settingOut<<" tCK    [ns] : "<<tCK<<endl;
 	settingOut<<" CWL   [clk] : "<<CWL<<endl;
 	settingOut<<"  CL   [clk] : "<<CL<<endl;
@@ -633,6 +855,7 @@ void CasHMCWrapper::PrintSetting(struct tm t)
 	settingOut<<" tWR   [clk] : "<<tWR<<endl;
 	settingOut<<" tRTRS [clk] : "<<tRTRS<<endl;
 	settingOut<<" tRFC  [clk] : "<<tRFC<<endl;
+	settingOut<<"tRFCpb [clk] : "<<tRFCpb<<endl;
 	settingOut<<" tFAW  [clk] : "<<tFAW<<endl;
 	settingOut<<" tCKE  [clk] : "<<tCKE<<endl;
 	settingOut<<" tXP   [clk] : "<<tXP<<endl;
@@ -641,6 +864,16 @@ void CasHMCWrapper::PrintSetting(struct tm t)
 	settingOut<<"  WL   [clk] : "<<WL<<endl;
 	settingOut<<"  BL   [clk] : "<<BL<<endl;
 	
+	settingOut<<endl<<" ==== DRAM current setting (per vault) ===="<<endl;
+	settingOut<<" VDD    [V] : "<<VDD<<endl;
+	settingOut<<" IDD0  [mA] : "<<IDD0<<endl;
+	settingOut<<" IDD2P [mA] : "<<IDD2P<<endl;
+	settingOut<<" IDD2N [mA] : "<<IDD2N<<endl;
+	settingOut<<" IDD3N [mA] : "<<IDD3N<<endl;
+	settingOut<<" IDD4R [mA] : "<<IDD4R<<endl;
+	settingOut<<" IDD4W [mA] : "<<IDD4W<<endl;
+	settingOut<<" IDD5B [mA] : "<<IDD5B<<endl;
+	
 	settingOut.flush();		settingOut.close();
 }
 
@@ -675,17 +908,109 @@ void CasHMCWrapper::MakePlotData()
 }
 
 //
-//Print transaction traced statistic on epoch boundaries
+//Open metrics time-series files with the column names of every sample
 //
-void CasHMCWrapper::PrintEpochStatistic()
+void CasHMCWrapper::InitMetrics()
 {
-	uint64_t elapsedCycles;
-	if(currentClockCycle%LOG_EPOCH == 0) {
-		elapsedCycles = LOG_EPOCH;
+	vector<string> columns;
+	columns.push_back("cycle");
+	for(int i=0; i<NUM_LINKS; i++) {
+		stringstream link;
+		link<<"link"<<i<<"_";
+		columns.push_back(link.str() + "down_GBps");
+		columns.push_back(link.str() + "up_GBps");
+		columns.push_back(link.str() + "buffer");
+		columns.push_back(link.str() + "errors");
+		columns.push_back(link.str() + "state");
 	}
-	else {
-		elapsedCycles = currentClockCycle%LOG_EPOCH;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		stringstream vault;
+		vault<<"vault"<<v<<"_";
+		columns.push_back(vault.str() + "GBps");
+		columns.push_back(vault.str() + "queue");
+		columns.push_back(vault.str() + "row_hit");
+		for(int b=0; b<NUM_BANKS; b++) {
+			stringstream bank;
+			bank<<"bank"<<v<<"_"<<b<<"_";
+			columns.push_back(bank.str() + "GBps");
+			columns.push_back(bank.str() + "queue");
+			columns.push_back(bank.str() + "row_hit");
+		}
 	}
+	metricsLast = vector<uint64_t>(NUM_LINKS*3 + NUM_VAULTS*NUM_BANKS*3, 0);
+	metricsOut = new MetricsStream(logName + "_metrics", columns, METRICS_CSV, METRICS_BINARY);
+}
+
+//
+//Add a metrics sample of the last PLOT_SAMPLING cycles (values are formatted and written by the writer thread)
+//
+void CasHMCWrapper::MakeMetricsData()
+{
+	double elapsedPlotTime = (double)(PLOT_SAMPLING*CPU_CLK_PERIOD*1E-9);
+	double *row = metricsOut->Row();
+	unsigned c = 0;		//Column index
+	unsigned m = 0;		//Counter index of metricsLast
+	row[c++] = currentClockCycle;
+	
+	//Link bandwidth includes packet header, tail, and flow packets
+	for(int i=0; i<NUM_LINKS; i++) {
+		uint64_t down = totalDownLinkTransmitSize[i] + downLinkTransmitSize[i];
+		uint64_t up = totalUpLinkTransmitSize[i] + upLinkTransmitSize[i];
+		uint64_t errors = totalErrorPerLink[i] + errorPerLink[i];
+		row[c++] = (down - metricsLast[m]) / elapsedPlotTime / (1<<30);		metricsLast[m++] = down;
+		row[c++] = (up - metricsLast[m]) / elapsedPlotTime / (1<<30);		metricsLast[m++] = up;
+		row[c++] = hmcCont->downLinkMasters[i]->Buffers.size();
+		row[c++] = errors - metricsLast[m];									metricsLast[m++] = errors;
+		row[c++] = hmcCont->downLinkMasters[i]->currentState;
+	}
+	
+	//Vault and bank bandwidth by 32-byte column commands, command queue depth, and row-hit rate [%]
+	for(int v=0; v<NUM_VAULTS; v++) {
+		CommandQueue *cmdQue = hmc->vaultControllers[v]->commandQueue;
+		DRAM *dram = hmc->drams[v];
+		unsigned vaultCol = c;
+		uint64_t vaultBytes = 0, vaultHit = 0, vaultAccess = 0, vaultQueue = 0;
+		c += 3;
+		for(int b=0; b<NUM_BANKS; b++) {
+			uint64_t bytes = dram->columnAccess[b]*32;
+			RowStat &rs = cmdQue->rowStat[b];
+			uint64_t access = rs.hit + rs.miss + rs.conflict;
+			uint64_t queue = 0;
+			if(QUE_PER_BANK) {
+				queue = cmdQue->queue[b].size();
+			}
+			else {
+				for(int q=0; q<cmdQue->queue[0].size(); q++) {
+					if(cmdQue->queue[0][q]->bank == b)	queue++;
+				}
+			}
+			uint64_t bankBytes = bytes - metricsLast[m];		metricsLast[m++] = bytes;
+			uint64_t bankHit = rs.hit - metricsLast[m];			metricsLast[m++] = rs.hit;
+			uint64_t bankAccess = access - metricsLast[m];		metricsLast[m++] = access;
+			row[c++] = bankBytes / elapsedPlotTime / (1<<30);
+			row[c++] = queue;
+			row[c++] = (bankAccess==0 ? 0 : (double)bankHit/bankAccess*100);
+			vaultBytes += bankBytes;
+			vaultHit += bankHit;
+			vaultAccess += bankAccess;
+			vaultQueue += queue;
+		}
+		row[vaultCol] = vaultBytes / elapsedPlotTime / (1<<30);
+		row[vaultCol+1] = vaultQueue;
+		row[vaultCol+2] = (vaultAccess==0 ? 0 : (double)vaultHit/vaultAccess*100);
+	}
+	metricsOut->Commit();
+}
+
+//
+//Print transaction traced statistic on epoch boundaries
+//
+void CasHMCWrapper::PrintEpochStatistic()
+{
+	//An epoch ends at every LOG_EPOCH, statistic reset, and ROI boundary
+	uint64_t elapsedCycles = currentClockCycle - epochStartCycle;
+	uint64_t statCycles = currentClockCycle - statStartCycle;
+	if(elapsedCycles == 0)	return;
 	
 	//Count transaction and packet type
 	uint64_t epochReads = 0;
@@ -795,14 +1120,28 @@ void CasHMCWrapper::PrintEpochStatistic()
 	vector<double> linkSleepMode = vector<double>(NUM_LINKS, 0);
 	vector<double> linkDownMode = vector<double>(NUM_LINKS, 0);
 	for(int i=0; i<NUM_LINKS; i++) {
-		linkSleepMode[i] = ((double)hmcCont->linkSleepTime[i]/currentClockCycle)*100;
-		linkDownMode[i] = ((double)hmcCont->linkDownTime[i]/currentClockCycle)*100;
+		linkSleepMode[i] = ((double)hmcCont->linkSleepTime[i]/statCycles)*100;
+		linkDownMode[i] = ((double)hmcCont->linkDownTime[i]/statCycles)*100;
 		SleepModeAve += linkSleepMode[i];
 		DownModeAve += linkDownMode[i];
 	}
 	SleepModeAve /= NUM_LINKS;
 	DownModeAve /= NUM_LINKS;
 	
+	//DRAM energy of all vaults and link energy (lane power and transmitted flit bits)
+	EnergyStat energyStat;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		energyStat += hmc->drams[v]->epochEnergyStat;
+	}
+	uint64_t flitBytes = 0;
+	for(int i=0; i<NUM_LINKS; i++) {
+		flitBytes += downLinkTransmitSize[i] + upLinkTransmitSize[i];
+	}
+	double laneEnergy = LaneEnergy();
+	double dramEnergy = energyStat.TotalEnergy();
+	double linkEnergy = (laneEnergy - laneEnergyLast) + flitBytes*8*FlitEnergy;
+	laneEnergyLast = laneEnergy;
+	
 	
 	//Print epoch statistic result
 	STATE(endl<<endl<<"  ============= ["<<currentClockCycle/LOG_EPOCH<<"] Epoch statistic result ============="<<endl);
@@ -813,6 +1152,12 @@ void CasHMCWrapper::PrintEpochStatistic()
 	STATE("       Link bandwidth : "<<ALI(7)<<linkBandwidthSum<<" GB/s  (Included flow packet)");
 	STATE("     Transmitted data : "<<ALI(7)<<DataScaling(hmcTransmitSize)<<" ("<<hmcTransmitSize<<" B)"<<endl);
 	
+	STATE("          DRAM energy : "<<ALI(7)<<dramEnergy/1000<<" nJ  (ACT : "<<energyStat.ActEnergy()/1000<<" / RD : "<<energyStat.ReadEnergy()/1000
+			<<" / WR : "<<energyStat.WriteEnergy()/1000<<" / REF : "<<energyStat.RefreshEnergy()/1000<<" / BG : "<<energyStat.BackgroundEnergy()/1000<<")");
+	STATE("          Link energy : "<<ALI(7)<<linkEnergy/1000<<" nJ  (flit : "<<flitBytes*8*FlitEnergy/1000<<")");
+	STATE("         Total energy : "<<ALI(7)<<(dramEnergy+linkEnergy)/1000<<" nJ  ("<<(hmcTransmitSize==0 ? 0 : (dramEnergy+linkEnergy)/(hmcTransmitSize*8))<<" pJ/bit, "
+			<<(dramEnergy+linkEnergy)/(elapsedCycles*CPU_CLK_PERIOD)<<" mW)"<<endl);
+	
 	if(LINK_POWER != NO_MANAGEMENT) {
 		STATE("     Sleep mode ratio : "<<ALI(7)<<SleepModeAve<<" %");
 		STATE("      Down mode ratio : "<<ALI(7)<<DownModeAve<<" %");
@@ -846,6 +1191,65 @@ void CasHMCWrapper::PrintEpochStatistic()
 	STATE("    Error abort count : "<<epochError);
 	STATE("    Error retry count : "<<errorCount<<endl);
 	
+	//Issue and retire slot utilization of HMC controller
+	IssueStat &issueStat = hmcCont->epochIssueStat;
+	uint64_t hostCycles = 0;
+	stringstream issueHist;
+	for(int i=0; i<issueStat.issueHist.size(); i++) {
+		hostCycles += issueStat.issueHist[i];
+		issueHist<<(i>0 ? " / " : "")<<issueStat.issueHist[i];
+	}
+	STATE("   Issued transaction : "<<issueStat.issued<<"  (issue slot utilization : "<<(hostCycles==0 ? 0 : (double)issueStat.issued/(hostCycles*HOST_ISSUE_WIDTH)*100)
+			<<" %, "<<(issueStat.busyCycles==0 ? 0 : (double)issueStat.issued/(issueStat.busyCycles*HOST_ISSUE_WIDTH)*100)<<" % in busy cycles)");
+	STATE("  Issue cycle (0 ~ "<<HOST_ISSUE_WIDTH<<") : "<<issueHist.str());
+	STATE("     Retired response : "<<issueStat.retired<<"  (retire slot utilization : "<<(hostCycles==0 ? 0 : (double)issueStat.retired/(hostCycles*HOST_RETIRE_WIDTH)*100)<<" %)");
+	
+	//Request tag occupancy of HMC controller
+	TagStat &tagStat = hmcCont->tagPool->epochTagStat;
+	STATE("        Allocated tag : "<<tagStat.allocated<<"  (tags in use  mean : "<<(tagStat.cycles==0 ? 0 : (double)tagStat.occupancySum/tagStat.cycles)
+			<<" / max : "<<tagStat.occupancyMax<<" / pool : "<<NUM_TAGS<<")");
+	STATE("  Tag exhaustion stall : "<<tagStat.exhaustCycles<<" cycles"<<endl);
+	
+	//Read/write turnaround, write queue occupancy, refresh stall, and row-buffer access of all vaults
+	TurnaroundStat turnStat;
+	RefreshStat refStat;
+	RowStat rowStat;
+	unsigned openModeVaults = 0;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		turnStat += hmc->vaultControllers[v]->commandQueue->epochTurnStat;
+		refStat += hmc->vaultControllers[v]->commandQueue->epochRefStat;
+		rowStat += hmc->vaultControllers[v]->commandQueue->epochRowStat;
+		if(hmc->vaultControllers[v]->commandQueue->openMode)	openModeVaults++;
+	}
+	uint64_t rowAccess = rowStat.hit + rowStat.miss + rowStat.conflict;
+	STATE("        Row hit count : "<<rowStat.hit);
+	STATE("       Row miss count : "<<rowStat.miss);
+	STATE("   Row conflict count : "<<rowStat.conflict);
+	if(ROW_POLICY == HIT_RATE) {
+		STATE("     Open-mode vaults : "<<openModeVaults<<" / "<<NUM_VAULTS);
+	}
+	STATE("         Row hit rate : "<<(rowAccess==0 ? 0 : (double)rowStat.hit/rowAccess*100)<<" %"<<endl);
+	STATE("  RD-to-WR turnaround : "<<turnStat.readToWrite);
+	STATE("  WR-to-RD turnaround : "<<turnStat.writeToRead);
+	if(WRITE_DRAIN) {
+		STATE("    Write drain burst : "<<turnStat.drainBurst);
+	}
+	STATE("   Write queue (mean) : "<<(turnStat.cycles==0 ? 0 : (double)turnStat.writeQueSum/turnStat.cycles)<<"  (max : "<<turnStat.writeQueMax<<") per vault");
+	STATE("        Refresh count : "<<refStat.refreshCnt);
+	if(REFRESH_POLICY == ELASTIC) {
+		STATE("Max postponed refresh : "<<refStat.postponedMax);
+	}
+	STATE("  Refresh stall cycle : "<<refStat.stallCycles<<"  ("<<(turnStat.cycles==0 ? 0 : (double)refStat.stallCycles/turnStat.cycles*100)<<" % of vault cycles)"<<endl);
+	
+	//Crossbar switch allocation and head-of-line blocking
+	CrossbarStat &crossStat = hmc->crossbarSwitch->epochCrossStat;
+	STATE("    Crossbar switched : "<<crossStat.switched<<"  ("<<(crossStat.busyCycles==0 ? 0 : (double)crossStat.switched/crossStat.busyCycles)<<" per busy cycle)");
+	STATE(" Crossbar vault block : "<<crossStat.outputBlock);
+	if(CROSSBAR_MODEL == VOQ) {
+		STATE("   Crossbar arb. loss : "<<crossStat.arbLoss);
+	}
+	STATE(" Crossbar input block : "<<crossStat.inputBlock<<"  (HOL blocking : "<<crossStat.holBlock<<")"<<endl);
+	
 	for(int i=0; i<NUM_LINKS; i++) {
 		STATE("  ----------------------  [Link "<<i<<"]");
 		STATE("  |               Read per link : "<<readPerLink[i]);
@@ -871,6 +1275,23 @@ void CasHMCWrapper::PrintEpochStatistic()
 		STATE("  -----  Total transmitted data : "<<ALI(7)<<DataScaling(linkDataSize[i])<<" ("<<linkDataSize[i]<<" B)"<<endl);
 	}
 	STATE("  * Effec bandwidth takes data transmission into account regardless of packet header and tail");
+	
+	//Per-stage latency breakdown (stacked attribution of transaction latency)
+	vector<double> stageMean = vector<double>(NUM_STAGES, 0);
+	STATE(endl<<"  ----------------------  [Latency stage breakdown]");
+	for(int s=0; s<NUM_STAGES; s++) {
+		stageMean[s] = (stageCount==0 ? 0 : (double)stageSum[s]/stageCount);
+		STATE("  |"<<ALI(15)<<StageName(s)<<" mean : "<<ALI(9)<<stageMean[s]*CPU_CLK_PERIOD<<" ns"
+				<<"  p99 : "<<ALI(7)<<HistPercentile(stageHist[s], stageCount, 99)*CPU_CLK_PERIOD<<" ns"
+				<<"  max : "<<stageMax[s]*CPU_CLK_PERIOD<<" ns");
+	}
+	epochStageMean.push_back(stageMean);
+	vector<double> energy;
+	energy.push_back(hmcBandwidth);
+	energy.push_back(dramEnergy);
+	energy.push_back(linkEnergy);
+	energy.push_back(hmcTransmitSize*8);
+	epochEnergy.push_back(energy);
 
 	//One epoch simulation statistic results are accumulated
 	totalTranCount += tranCount;
@@ -921,6 +1342,35 @@ void CasHMCWrapper::PrintEpochStatistic()
 	totalLinkStdSum += linkStdSum;
 	totalVaultStdSum += vaultStdSum;
 	totalErrorStdSum += errorStdSum;
+	
+	totalStageCount += stageCount;
+	stageCount = 0;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		CommandQueue *cmdQue = hmc->vaultControllers[v]->commandQueue;
+		cmdQue->totalTurnStat += cmdQue->epochTurnStat;
+		cmdQue->epochTurnStat = TurnaroundStat();
+		cmdQue->totalRefStat += cmdQue->epochRefStat;
+		cmdQue->epochRefStat = RefreshStat();
+		cmdQue->epochRowStat = RowStat();
+	}
+	hmcCont->totalIssueStat += hmcCont->epochIssueStat;
+	hmcCont->epochIssueStat = IssueStat(HOST_ISSUE_WIDTH);
+	hmcCont->tagPool->totalTagStat += hmcCont->tagPool->epochTagStat;
+	hmcCont->tagPool->epochTagStat = TagStat();
+	hmc->crossbarSwitch->totalCrossStat += hmc->crossbarSwitch->epochCrossStat;
+	hmc->crossbarSwitch->epochCrossStat = CrossbarStat();
+	epochStartCycle = currentClockCycle;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		hmc->drams[v]->totalEnergyStat += hmc->drams[v]->epochEnergyStat;
+		hmc->drams[v]->epochEnergyStat = EnergyStat();
+	}
+	for(int s=0; s<NUM_STAGES; s++) {
+		totalStageSum[s] += stageSum[s];	stageSum[s] = 0;
+		totalStageMax[s] = max(stageMax[s], totalStageMax[s]);	stageMax[s] = 0;
+		for(int b=0; b<NUM_STAGE_HIST; b++) {
+			totalStageHist[s][b] += stageHist[s][b];	stageHist[s][b] = 0;
+		}
+	}
 
 	if(BANDWIDTH_PLOT) {
 		hmcTransmitSizeTemp = 0;
@@ -934,19 +1384,26 @@ void CasHMCWrapper::PrintEpochStatistic()
 //
 //Print final transaction traced statistic accumulated on every epoch
 //
-void CasHMCWrapper::PrintFinalStatistic()
+void CasHMCWrapper::PrintFinalStatistic(string logSuffix)
 {
 	time_t now;
     struct tm t;
     time(&now);
     t = *localtime(&now);
 	
-	string resName = logName + "_result.log";
+	string resName = logName + logSuffix + ".log";
 	resultOut.open(resName.c_str());
-	cout<<"\n   === Simulation finished  ( CPU clk:"<<currentClockCycle<<" ) ===   "<<endl;
-	cout<<"  [ "<<resName<<" ] is generated"<<endl<<endl;
+	if(logSuffix == "_result") {
+		cout<<"\n   === Simulation finished  ( CPU clk:"<<currentClockCycle<<" ) ===   "<<endl;
+		cout<<"  [ "<<resName<<" ] is generated"<<endl<<endl;
+	}
+	else if(printEpoch) {
+		cout<<"  [ "<<resName<<" ] is generated  ( CPU clk:"<<currentClockCycle<<" )"<<endl;
+	}
 	
-	double elapsedTime = (double)(currentClockCycle*CPU_CLK_PERIOD*1E-9);
+	//Statistics are accumulated from the last reset
+	uint64_t statCycles = currentClockCycle - statStartCycle;
+	double elapsedTime = (double)(statCycles*CPU_CLK_PERIOD*1E-9);
 	double hmcBandwidth = totalHmcTransmitSize/elapsedTime/(1<<30);
 	vector<double> downLinkBandwidth = vector<double>(NUM_LINKS, 0);
 	vector<double> upLinkBandwidth = vector<double>(NUM_LINKS, 0);
@@ -1003,11 +1460,11 @@ void CasHMCWrapper::PrintFinalStatistic()
 	vector<double> linkSleepMode = vector<double>(NUM_LINKS, 0);
 	vector<double> linkDownMode = vector<double>(NUM_LINKS, 0);
 	for(int i=0; i<NUM_LINKS; i++) {
-		linkSleepMode[i] = ((double)hmcCont->linkSleepTime[i]/currentClockCycle)*100;
-		linkDownMode[i] = ((double)hmcCont->linkDownTime[i]/currentClockCycle)*100;
+		linkSleepMode[i] = ((double)hmcCont->linkSleepTime[i]/statCycles)*100;
+		linkDownMode[i] = ((double)hmcCont->linkDownTime[i]/statCycles)*100;
 		SleepModeAve += linkSleepMode[i];
 		DownModeAve += linkDownMode[i];
-		ActModeTotal += currentClockCycle - (hmcCont->linkSleepTime[i] + hmcCont->linkDownTime[i]);
+		ActModeTotal += statCycles - (hmcCont->linkSleepTime[i] + hmcCont->linkDownTime[i]);
 		SleepModeTotal += hmcCont->linkSleepTime[i];
 		DownModeTotal += hmcCont->linkDownTime[i];
 	}
@@ -1016,12 +1473,25 @@ void CasHMCWrapper::PrintFinalStatistic()
 	double SlpPowPerSec = (double)PowPerLane*LINK_SPEED*SleepPow/100;
 	double DwnPowPerSec = (double)PowPerLane*LINK_SPEED*DownPow/100;
 	
-	double ActPower = (double)ActModeTotal*ActPowPerSec/currentClockCycle;
-	double SleepPower = (double)SleepModeTotal*SlpPowPerSec/currentClockCycle;
-	double DownPower = (double)DownModeTotal*DwnPowPerSec/currentClockCycle;
+	double ActPower = (double)ActModeTotal*ActPowPerSec/statCycles;
+	double SleepPower = (double)SleepModeTotal*SlpPowPerSec/statCycles;
+	double DownPower = (double)DownModeTotal*DwnPowPerSec/statCycles;
 
 	SleepModeAve /= NUM_LINKS;
 	DownModeAve /= NUM_LINKS;
+	
+	EnergyStat energyStat;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		energyStat += hmc->drams[v]->totalEnergyStat;
+	}
+	uint64_t flitBytes = 0;
+	for(int i=0; i<NUM_LINKS; i++) {
+		flitBytes += totalDownLinkTransmitSize[i] + totalUpLinkTransmitSize[i];
+	}
+	double dramEnergy = energyStat.TotalEnergy();
+	double flitEnergy = flitBytes*8*FlitEnergy;
+	double linkEnergy = LaneEnergy() + flitEnergy;
+	double totalEnergy = dramEnergy + linkEnergy;
 
 
 	//Print statistic result
@@ -1044,12 +1514,29 @@ void CasHMCWrapper::PrintFinalStatistic()
 	
 	resultOut<<"  ============= CasHMC statistic result ============="<<endl<<endl;
 	resultOut<<"  Elapsed epoch : "<<currentClockCycle/LOG_EPOCH<<endl;
-	resultOut<<"  Elapsed clock : "<<currentClockCycle<<endl<<endl;
+	resultOut<<"  Elapsed clock : "<<currentClockCycle<<endl;
+	if(statStartCycle > 0) {
+		resultOut<<"  Statistic clock : "<<statCycles<<"  (reset at "<<statStartCycle<<")"<<endl;
+	}
+	resultOut<<endl;
 	
 	resultOut<<"        HMC bandwidth : "<<ALI(7)<<hmcBandwidth<<" GB/s  (Considered only data size)"<<endl;
 	resultOut<<"       Link bandwidth : "<<ALI(7)<<linkBandwidthSum<<" GB/s  (Included flow packet)"<<endl;
 	resultOut<<"     Transmitted data : "<<ALI(7)<<DataScaling(totalHmcTransmitSize)<<" ("<<totalHmcTransmitSize<<" B)"<<endl<<endl;
 	
+	resultOut<<"  DRAM ACT/PRE energy : "<<ALI(7)<<energyStat.ActEnergy()/1000<<" nJ  ("<<energyStat.activates<<" ACT)"<<endl;
+	resultOut<<"     DRAM read energy : "<<ALI(7)<<energyStat.ReadEnergy()/1000<<" nJ  ("<<energyStat.reads<<" RD)"<<endl;
+	resultOut<<"    DRAM write energy : "<<ALI(7)<<energyStat.WriteEnergy()/1000<<" nJ  ("<<energyStat.writes<<" WR)"<<endl;
+	resultOut<<"  DRAM refresh energy : "<<ALI(7)<<energyStat.RefreshEnergy()/1000<<" nJ  ("<<energyStat.refreshes<<" REF, "<<energyStat.bankRefreshes<<" per-bank REF)"<<endl;
+	resultOut<<"      DRAM background : "<<ALI(7)<<energyStat.BackgroundEnergy()/1000<<" nJ"<<endl;
+	resultOut<<"    Total DRAM energy : "<<ALI(7)<<dramEnergy/1000<<" nJ"<<endl;
+	resultOut<<"     Link lane energy : "<<ALI(7)<<(linkEnergy-flitEnergy)/1000<<" nJ"<<endl;
+	resultOut<<"     Link flit energy : "<<ALI(7)<<flitEnergy/1000<<" nJ  ("<<DataScaling(flitBytes)<<" transmitted)"<<endl;
+	resultOut<<"    Total link energy : "<<ALI(7)<<linkEnergy/1000<<" nJ"<<endl;
+	resultOut<<"         Total energy : "<<ALI(7)<<totalEnergy/1000<<" nJ  ("<<(elapsedTime==0 ? 0 : totalEnergy*1E-9/elapsedTime)<<" mW)"<<endl;
+	resultOut<<"       Energy per bit : "<<ALI(7)<<(totalHmcTransmitSize==0 ? 0 : totalEnergy/(totalHmcTransmitSize*8))<<" pJ/bit  (DRAM : "
+			<<(totalHmcTransmitSize==0 ? 0 : dramEnergy/(totalHmcTransmitSize*8))<<" / link : "<<(totalHmcTransmitSize==0 ? 0 : linkEnergy/(totalHmcTransmitSize*8))<<")"<<endl<<endl;
+	
 	if(LINK_POWER != NO_MANAGEMENT) {
 		resultOut<<"    Active link power : "<<ALI(7)<<ActPower<<" mW"<<endl;
 		resultOut<<"     Sleep link power : "<<ALI(7)<<SleepPower<<" mW"<<endl;
@@ -1090,6 +1577,77 @@ void CasHMCWrapper::PrintFinalStatistic()
 	resultOut<<"    Error abort count : "<<epochError<<endl;
 	resultOut<<"    Error retry count : "<<totalErrorCount<<endl<<endl;
 	
+	IssueStat &issueStat = hmcCont->totalIssueStat;
+	uint64_t hostCycles = 0;
+	stringstream issueHist;
+	for(int i=0; i<issueStat.issueHist.size(); i++) {
+		hostCycles += issueStat.issueHist[i];
+		issueHist<<(i>0 ? " / " : "")<<issueStat.issueHist[i];
+	}
+	resultOut<<"   Issued transaction : "<<issueStat.issued<<"  (issue slot utilization : "<<(hostCycles==0 ? 0 : (double)issueStat.issued/(hostCycles*HOST_ISSUE_WIDTH)*100)
+			<<" %, "<<(issueStat.busyCycles==0 ? 0 : (double)issueStat.issued/(issueStat.busyCycles*HOST_ISSUE_WIDTH)*100)<<" % in busy cycles)"<<endl;
+	resultOut<<"  Issue cycle (0 ~ "<<HOST_ISSUE_WIDTH<<") : "<<issueHist.str()<<endl;
+	resultOut<<"     Retired response : "<<issueStat.retired<<"  (retire slot utilization : "<<(hostCycles==0 ? 0 : (double)issueStat.retired/(hostCycles*HOST_RETIRE_WIDTH)*100)<<" %)"<<endl;
+	
+	TagStat &tagStat = hmcCont->tagPool->totalTagStat;
+	resultOut<<"        Allocated tag : "<<tagStat.allocated<<"  (tags in use  mean : "<<(tagStat.cycles==0 ? 0 : (double)tagStat.occupancySum/tagStat.cycles)
+			<<" / max : "<<tagStat.occupancyMax<<" / pool : "<<NUM_TAGS<<")"<<endl;
+	resultOut<<"  Tag exhaustion stall : "<<tagStat.exhaustCycles<<" cycles"<<endl<<endl;
+	
+	TurnaroundStat turnStat;
+	RefreshStat refStat;
+	RowStat rowStat;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		turnStat += hmc->vaultControllers[v]->commandQueue->totalTurnStat;
+		refStat += hmc->vaultControllers[v]->commandQueue->totalRefStat;
+		for(int b=0; b<NUM_BANKS; b++) {
+			rowStat += hmc->vaultControllers[v]->commandQueue->rowStat[b];
+		}
+	}
+	uint64_t rowAccess = rowStat.hit + rowStat.miss + rowStat.conflict;
+	resultOut<<"        Row hit count : "<<rowStat.hit<<endl;
+	resultOut<<"       Row miss count : "<<rowStat.miss<<endl;
+	resultOut<<"   Row conflict count : "<<rowStat.conflict<<endl;
+	resultOut<<"         Row hit rate : "<<(rowAccess==0 ? 0 : (double)rowStat.hit/rowAccess*100)<<" %"<<endl<<endl;
+	resultOut<<"  RD-to-WR turnaround : "<<turnStat.readToWrite<<endl;
+	resultOut<<"  WR-to-RD turnaround : "<<turnStat.writeToRead<<endl;
+	if(WRITE_DRAIN) {
+		resultOut<<"    Write drain burst : "<<turnStat.drainBurst<<endl;
+	}
+	resultOut<<"   Write queue (mean) : "<<(turnStat.cycles==0 ? 0 : (double)turnStat.writeQueSum/turnStat.cycles)<<"  (max : "<<turnStat.writeQueMax<<") per vault"<<endl;
+	resultOut<<"        Refresh count : "<<refStat.refreshCnt<<endl;
+	if(REFRESH_POLICY == ELASTIC) {
+		resultOut<<"Max postponed refresh : "<<refStat.postponedMax<<endl;
+	}
+	resultOut<<"  Refresh stall cycle : "<<refStat.stallCycles<<"  ("<<(turnStat.cycles==0 ? 0 : (double)refStat.stallCycles/turnStat.cycles*100)<<" % of vault cycles)"<<endl<<endl;
+	
+	CrossbarStat &crossStat = hmc->crossbarSwitch->totalCrossStat;
+	resultOut<<"    Crossbar switched : "<<crossStat.switched<<"  ("<<(crossStat.busyCycles==0 ? 0 : (double)crossStat.switched/crossStat.busyCycles)<<" per busy cycle)"<<endl;
+	resultOut<<" Crossbar vault block : "<<crossStat.outputBlock<<endl;
+	if(CROSSBAR_MODEL == VOQ) {
+		resultOut<<"   Crossbar arb. loss : "<<crossStat.arbLoss<<endl;
+	}
+	resultOut<<" Crossbar input block : "<<crossStat.inputBlock<<"  (HOL blocking : "<<crossStat.holBlock<<")"<<endl<<endl;
+	
+	if(FUNCTIONAL_MEM) {
+		uint64_t memPages = 0, memRead = 0, memWrite = 0, memAtomic = 0, memFlag = 0, memSkip = 0;
+		for(int v=0; v<NUM_VAULTS; v++) {
+			VaultMemory *vaultMem = hmc->vaultControllers[v]->vaultMemory;
+			memPages += vaultMem->pages.size();
+			memRead += vaultMem->readBytes;
+			memWrite += vaultMem->writeBytes;
+			memAtomic += vaultMem->atomicCnt;
+			memFlag += vaultMem->atomicFlagCnt;
+			memSkip += vaultMem->atomicSkipCnt;
+		}
+		resultOut<<"  Functional mem size : "<<ALI(7)<<DataScaling(memPages*MEM_PAGE_SIZE)<<" ("<<memPages<<" pages)"<<endl;
+		resultOut<<"  Functional mem read : "<<ALI(7)<<DataScaling(memRead)<<" ("<<memRead<<" B)"<<endl;
+		resultOut<<" Functional mem write : "<<ALI(7)<<DataScaling(memWrite)<<" ("<<memWrite<<" B)"<<endl;
+		resultOut<<"  Atomic executed cnt : "<<memAtomic<<endl;
+		resultOut<<"  Atomic flag set cnt : "<<memFlag<<endl;
+		resultOut<<"Atomic write skip cnt : "<<memSkip<<endl<<endl;
+	}
+	
 	for(int i=0; i<NUM_LINKS; i++) {
 		resultOut<<"  ----------------------  [Link "<<i<<"]"<<endl;
 		resultOut<<"  |               Read per link : "<<totalReadPerLink[i]<<endl;
@@ -1114,9 +1672,292 @@ void CasHMCWrapper::PrintFinalStatistic()
 		resultOut<<"  |   Upstream transmitted data : "<<ALI(7)<<DataScaling(totalUpLinkDataSize[i])<<" ("<<totalUpLinkDataSize[i]<<" B)"<<endl;
 		resultOut<<"  -----  Total transmitted data : "<<ALI(7)<<DataScaling(totalLinkDataSize[i])<<" ("<<totalLinkDataSize[i]<<" B)"<<endl<<endl;
 	}
-	resultOut<<"  * Effec bandwidth takes data transmission into account regardless of packet header and tail"<<endl;
+	resultOut<<"  * Effec bandwidth takes data transmission into account regardless of packet header and tail"<<endl<<endl;
+	
+	//Per-stage latency breakdown
+	double stageTotalMean = (totalTranCount==0 ? 0 : (double)totalTranFullSum/totalTranCount);
+	resultOut<<"  ----------------------  [Latency stage breakdown]"<<endl;
+	for(int s=0; s<NUM_STAGES; s++) {
+		double stageMean = (totalStageCount==0 ? 0 : (double)totalStageSum[s]/totalStageCount);
+		resultOut<<"  |"<<ALI(15)<<StageName(s)<<" mean : "<<ALI(9)<<stageMean*CPU_CLK_PERIOD<<" ns ("<<ALI(7)
+				<<(stageTotalMean==0 ? 0 : stageMean/stageTotalMean*100)<<" %)"
+				<<"  p50 : "<<ALI(7)<<HistPercentile(totalStageHist[s], totalStageCount, 50)*CPU_CLK_PERIOD<<" ns"
+				<<"  p99 : "<<ALI(7)<<HistPercentile(totalStageHist[s], totalStageCount, 99)*CPU_CLK_PERIOD<<" ns"
+				<<"  max : "<<totalStageMax[s]*CPU_CLK_PERIOD<<" ns"<<endl;
+	}
+	resultOut<<"  * Percentiles are lower bounds of log-linear histogram buckets"<<endl<<endl;
+	
+	//Latency per QoS priority class
+	if(QOS_CLASSES > 1) {
+		resultOut<<"  ----------------------  [Latency per QoS class]"<<endl;
+		for(int c=QOS_CLASSES-1; c>=0; c--) {
+			resultOut<<"  |  Class "<<ALI(3)<<c<<" count : "<<ALI(9)<<classCount[c]
+					<<"  mean : "<<ALI(9)<<(classCount[c]==0 ? 0 : (double)classSum[c]/classCount[c])*CPU_CLK_PERIOD<<" ns"
+					<<"  p50 : "<<ALI(7)<<HistPercentile(&classHist[c][0], classCount[c], 50)*CPU_CLK_PERIOD<<" ns"
+					<<"  p99 : "<<ALI(7)<<HistPercentile(&classHist[c][0], classCount[c], 99)*CPU_CLK_PERIOD<<" ns"
+					<<"  p99.9 : "<<ALI(7)<<HistPercentile(&classHist[c][0], classCount[c], 99.9)*CPU_CLK_PERIOD<<" ns"
+					<<"  max : "<<classMax[c]*CPU_CLK_PERIOD<<" ns"<<endl;
+		}
+		//Latency histogram (only non-empty buckets are printed)
+		resultOut<<"  "<<ALI(14)<<"Latency [ns]";
+		for(int c=QOS_CLASSES-1; c>=0; c--) {
+			resultOut<<ALI(8)<<"Class"<<ALI(6)<<c;
+		}
+		resultOut<<endl;
+		for(int b=0; b<NUM_STAGE_HIST; b++) {
+			uint64_t bucketCount = 0;
+			for(int c=0; c<QOS_CLASSES; c++) {
+				bucketCount += classHist[c][b];
+			}
+			if(bucketCount == 0)	continue;
+			resultOut<<"  "<<ALI(14)<<HistBucketValue(b)*CPU_CLK_PERIOD;
+			for(int c=QOS_CLASSES-1; c>=0; c--) {
+				resultOut<<ALI(14)<<classHist[c][b];
+			}
+			resultOut<<endl;
+		}
+		resultOut<<"  * Requests bypassed more than QOS_BYPASS_LIMIT times are served above all classes"<<endl<<endl;
+	}
+	
+	//Stacked latency attribution per epoch
+	resultOut<<"  ----------------------  [Stacked latency attribution per epoch (mean ns)]"<<endl;
+	resultOut<<"  "<<ALI(7)<<"Epoch";
+	for(int s=0; s<NUM_STAGES; s++) {
+		resultOut<<ALI(14)<<StageName(s);
+	}
+	resultOut<<ALI(14)<<"Total"<<endl;
+	for(int e=0; e<epochStageMean.size(); e++) {
+		double epochTotal = 0;
+		resultOut<<"  "<<ALI(7)<<e;
+		for(int s=0; s<NUM_STAGES; s++) {
+			resultOut<<ALI(14)<<epochStageMean[e][s]*CPU_CLK_PERIOD;
+			epochTotal += epochStageMean[e][s]*CPU_CLK_PERIOD;
+		}
+		resultOut<<ALI(14)<<epochTotal<<endl;
+	}
+	
+	//Bandwidth and energy per epoch
+	resultOut<<endl<<"  ----------------------  [Bandwidth and energy per epoch]"<<endl;
+	resultOut<<"  "<<ALI(7)<<"Epoch"<<ALI(14)<<"HMC [GB/s]"<<ALI(14)<<"DRAM [nJ]"<<ALI(14)<<"Link [nJ]"<<ALI(14)<<"Total [nJ]"<<ALI(14)<<"[pJ/bit]"<<endl;
+	for(int e=0; e<epochEnergy.size(); e++) {
+		double epochTotal = epochEnergy[e][1] + epochEnergy[e][2];
+		resultOut<<"  "<<ALI(7)<<e<<ALI(14)<<epochEnergy[e][0]<<ALI(14)<<epochEnergy[e][1]/1000<<ALI(14)<<epochEnergy[e][2]/1000
+				<<ALI(14)<<epochTotal/1000<<ALI(14)<<(epochEnergy[e][3]==0 ? 0 : epochTotal/epochEnergy[e][3])<<endl;
+	}
+	
+	//Row-buffer access counters per vault and bank
+	resultOut<<endl<<"  ----------------------  [Row-buffer access per vault (hit/miss/conflict of each bank)]"<<endl;
+	for(int v=0; v<NUM_VAULTS; v++) {
+		CommandQueue *cmdQue = hmc->vaultControllers[v]->commandQueue;
+		RowStat vaultRow;
+		for(int b=0; b<NUM_BANKS; b++) {
+			vaultRow += cmdQue->rowStat[b];
+		}
+		uint64_t vaultAccess = vaultRow.hit + vaultRow.miss + vaultRow.conflict;
+		resultOut<<"  | Vault "<<ALI(3)<<v<<" hit rate : "<<ALI(8)<<(vaultAccess==0 ? 0 : (double)vaultRow.hit/vaultAccess*100)<<" % |";
+		for(int b=0; b<NUM_BANKS; b++) {
+			resultOut<<" "<<cmdQue->rowStat[b].hit<<"/"<<cmdQue->rowStat[b].miss<<"/"<<cmdQue->rowStat[b].conflict;
+		}
+		resultOut<<endl;
+	}
+#ifdef PROFILE
+	PrintProfile();
+#endif
+	resultOut.flush();	resultOut.close();
 }
 
+//
+//Clear every statistic counter after the partial epoch statistic (statistics restart from the current clock)
+//
+void CasHMCWrapper::ResetStatistic()
+{
+	//Cube side counters are touched after the cube thread catches up with the host
+	SyncCube();
+	PrintEpochStatistic();
+	ResetStatis();
+	if(PIPELINE_SIM) {
+		cubeStatis = TranStatistic();
+		cubeStatis.PushStatisPerLink();
+	}
+	
+	hmcCont->epochIssueStat = IssueStat(HOST_ISSUE_WIDTH);
+	hmcCont->totalIssueStat = IssueStat(HOST_ISSUE_WIDTH);
+	hmcCont->tagPool->epochTagStat = TagStat();
+	hmcCont->tagPool->totalTagStat = TagStat();
+	for(int i=0; i<NUM_LINKS; i++) {
+		hmcCont->linkSleepTime[i] = 0;
+		hmcCont->linkDownTime[i] = 0;
+	}
+	hmc->crossbarSwitch->epochCrossStat = CrossbarStat();
+	hmc->crossbarSwitch->totalCrossStat = CrossbarStat();
+	for(int v=0; v<NUM_VAULTS; v++) {
+		CommandQueue *cmdQue = hmc->vaultControllers[v]->commandQueue;
+		VaultMemory *vaultMem = hmc->vaultControllers[v]->vaultMemory;
+		DRAM *dram = hmc->drams[v];
+		cmdQue->epochTurnStat = TurnaroundStat();
+		cmdQue->totalTurnStat = TurnaroundStat();
+		cmdQue->epochRefStat = RefreshStat();
+		cmdQue->totalRefStat = RefreshStat();
+		cmdQue->epochRowStat = RowStat();
+		for(int b=0; b<NUM_BANKS; b++) {
+			cmdQue->rowStat[b] = RowStat();
+			dram->columnAccess[b] = 0;
+		}
+		dram->epochEnergyStat = EnergyStat();
+		dram->totalEnergyStat = EnergyStat();
+		if(vaultMem != NULL) {
+			vaultMem->readBytes = 0;
+			vaultMem->writeBytes = 0;
+			vaultMem->atomicCnt = 0;
+			vaultMem->atomicFlagCnt = 0;
+			vaultMem->atomicSkipCnt = 0;
+		}
+	}
+	
+	if(BANDWIDTH_PLOT) {
+		hmcTransmitSizeTemp = 0;
+		for(int i=0; i<NUM_LINKS; i++) {
+			downLinkDataSizeTemp[i] = 0;
+			upLinkDataSizeTemp[i] = 0;
+		}
+	}
+	if(METRICS_OUT) {
+		metricsLast.assign(metricsLast.size(), 0);
+	}
+	laneEnergyLast = 0;
+	statStartCycle = currentClockCycle;
+	epochStartCycle = currentClockCycle;
+}
+
+//
+//Print the result log of statistics until the current clock without reset (*_snapshot[k].log)
+//
+void CasHMCWrapper::SnapshotStatistic()
+{
+	SyncCube();
+	PrintEpochStatistic();
+	stringstream suffix;
+	suffix << "_snapshot" << snapshotNum++;
+	PrintFinalStatistic(suffix.str());
+}
+
+//
+//Region of interest begins (statistics of warm-up are discarded)
+//
+void CasHMCWrapper::BeginROI()
+{
+	if(roiActive)	return;
+	ResetStatistic();
+	roiActive = true;
+	if(ROI_LOG_ONLY) {
+		DEBUG_SIM = logDebug;
+		STATE_SIM = logState;
+		if(DEBUG_SIM || STATE_SIM) {
+			PrintEpochHeader();
+		}
+	}
+	if(printEpoch)	cout<<"\n   === Region of interest ["<<roiNum<<"] begins  ( CPU clk:"<<currentClockCycle<<" ) ===   "<<endl;
+}
+
+//
+//Region of interest ends (*_roi[k].log is printed)
+//
+void CasHMCWrapper::EndROI()
+{
+	if(!roiActive)	return;
+	SyncCube();
+	PrintEpochStatistic();
+	stringstream suffix;
+	suffix << "_roi" << roiNum++;
+	PrintFinalStatistic(suffix.str());
+	roiActive = false;
+	if(ROI_LOG_ONLY) {
+		if(DEBUG_SIM) {
+			debugOut.flush();	debugOut.close();
+		}
+		if(STATE_SIM) {
+			stateOut.flush();	stateOut.close();
+		}
+		DEBUG_SIM = false;
+		STATE_SIM = false;
+	}
+}
+
+#ifdef PROFILE
+//
+//Print self-profiling result (wall-clock time and call count of each component)
+//
+void CasHMCWrapper::PrintProfile()
+{
+	uint64_t totalTicks = ReadTSC() - profStartTSC;
+	uint64_t totalWall = ReadWallNs() - profStartWall;
+	double tscPerNs = (totalWall==0 ? 1 : (double)totalTicks/totalWall);
+	
+	ProfileStat downMaster, downLink, downSlave, upMaster, upLink, upSlave;
+	ProfileStat vaultCont, cmdQueue, dram;
+	for(int l=0; l<NUM_LINKS; l++) {
+		downMaster += hmcCont->downLinkMasters[l]->profile;
+		downLink += downstreamLinks[l]->profile;
+		downSlave += hmc->downLinkSlaves[l]->profile;
+		upMaster += hmc->upLinkMasters[l]->profile;
+		upLink += upstreamLinks[l]->profile;
+		upSlave += hmcCont->upLinkSlaves[l]->profile;
+	}
+	for(int v=0; v<NUM_VAULTS; v++) {
+		vaultCont += hmc->vaultControllers[v]->profile;
+		cmdQueue += hmc->vaultControllers[v]->commandQueue->profile;
+		dram += hmc->drams[v]->profile;
+	}
+	
+	resultOut.setf(ios::left);
+	resultOut<<endl<<"  ============= CasHMC profile result ============="<<endl<<endl;
+	resultOut<<"  Profiled wall-clock time : "<<totalWall/1E6<<" ms"<<endl;
+	resultOut<<"  Simulation speed : "<<(totalWall==0 ? 0 : currentClockCycle/(totalWall/1E9))<<" CPU clk/s"<<endl<<endl;
+	resultOut<<"  "<<ALI(26)<<"Component"<<ALI(12)<<"Calls"<<ALI(12)<<"Time [ms]"<<ALI(10)<<"Ratio [%]"<<"ns/call"<<endl;
+	PrintProfileLine("HMC controller", hmcCont->profile, tscPerNs, totalTicks);
+	PrintProfileLine("Downstream link master", downMaster, tscPerNs, totalTicks);
+	PrintProfileLine("Downstream link", downLink, tscPerNs, totalTicks);
+	PrintProfileLine("HMC (total)", hmc->profile, tscPerNs, totalTicks);
+	PrintProfileLine(" Downstream link slave", downSlave, tscPerNs, totalTicks);
+	PrintProfileLine(" Crossbar switch", hmc->crossbarSwitch->profile, tscPerNs, totalTicks);
+	PrintProfileLine(" Vault controller", vaultCont, tscPerNs, totalTicks);
+	PrintProfileLine("  Command queue", cmdQueue, tscPerNs, totalTicks);
+	PrintProfileLine(" DRAM", dram, tscPerNs, totalTicks);
+	PrintProfileLine(" Upstream link master", upMaster, tscPerNs, totalTicks);
+	PrintProfileLine("Upstream link", upLink, tscPerNs, totalTicks);
+	PrintProfileLine("Upstream link slave", upSlave, tscPerNs, totalTicks);
+	resultOut<<"  * Vault controller time includes its command queue (CmdPop and Update)"<<endl<<endl;
+	
+	for(int l=0; l<NUM_LINKS; l++) {
+		stringstream linkNum;
+		linkNum << l;
+		resultOut<<"  ----------------------  [Link "<<l<<"]"<<endl;
+		PrintProfileLine("LM_D"+linkNum.str(), hmcCont->downLinkMasters[l]->profile, tscPerNs, totalTicks);
+		PrintProfileLine("LK_D"+linkNum.str(), downstreamLinks[l]->profile, tscPerNs, totalTicks);
+		PrintProfileLine("LS_D"+linkNum.str(), hmc->downLinkSlaves[l]->profile, tscPerNs, totalTicks);
+		PrintProfileLine("LM_U"+linkNum.str(), hmc->upLinkMasters[l]->profile, tscPerNs, totalTicks);
+		PrintProfileLine("LK_U"+linkNum.str(), upstreamLinks[l]->profile, tscPerNs, totalTicks);
+		PrintProfileLine("LS_U"+linkNum.str(), hmcCont->upLinkSlaves[l]->profile, tscPerNs, totalTicks);
+	}
+	for(int v=0; v<NUM_VAULTS; v++) {
+		stringstream vaultNum;
+		vaultNum << v;
+		resultOut<<"  ----------------------  [Vault "<<v<<"]"<<endl;
+		PrintProfileLine("VC_"+vaultNum.str(), hmc->vaultControllers[v]->profile, tscPerNs, totalTicks);
+		PrintProfileLine("CQ_"+vaultNum.str(), hmc->vaultControllers[v]->commandQueue->profile, tscPerNs, totalTicks);
+		PrintProfileLine("DR_"+vaultNum.str(), hmc->drams[v]->profile, tscPerNs, totalTicks);
+	}
+}
+
+void CasHMCWrapper::PrintProfileLine(string name, ProfileStat &stat, double tscPerNs, uint64_t totalTicks)
+{
+	double timeNs = stat.ticks / tscPerNs;
+	resultOut<<"  "<<ALI(26)<<name<<ALI(12)<<stat.calls<<ALI(12)<<timeNs/1E6
+			<<ALI(10)<<(totalTicks==0 ? 0 : (double)stat.ticks/totalTicks*100)
+			<<(stat.calls==0 ? 0 : timeNs/stat.calls)<<endl;
+}
+#endif
+
 //
 //Transmitted data size scaling
 //
@@ -1138,6 +1979,23 @@ string CasHMCWrapper::DataScaling(double dataScale)
 	return outStr;
 }
 
+//
+//Lane energy of all links from the last statistic reset [pJ] (active, sleep, and down mode power over time)
+//
+double CasHMCWrapper::LaneEnergy()
+{
+	uint64_t ActModeTotal = 0;
+	uint64_t SleepModeTotal = 0;
+	uint64_t DownModeTotal = 0;
+	for(int i=0; i<NUM_LINKS; i++) {
+		ActModeTotal += (currentClockCycle - statStartCycle) - (hmcCont->linkSleepTime[i] + hmcCont->linkDownTime[i]);
+		SleepModeTotal += hmcCont->linkSleepTime[i];
+		DownModeTotal += hmcCont->linkDownTime[i];
+	}
+	//mW x ns = pJ
+	return (ActModeTotal + SleepModeTotal*SleepPow/100 + DownModeTotal*DownPow/100)*PowPerLane*LINK_SPEED*CPU_CLK_PERIOD;
+}
+
 } //namespace CasHMC
 
 
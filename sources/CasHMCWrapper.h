@@ -21,6 +21,8 @@
 #include <sstream>		//stringstream
 #include <fstream>		//ofstream
 #include <vector>		//vector
+#include <atomic>		//atomic
+#include <thread>		//thread
 
 #include "ConfigReader.h"
 #include "ConfigValue.h"
@@ -28,7 +30,10 @@
 #include "CallBack.h"
 #include "HMCController.h"
 #include "Link.h"
+#include "LinkPipe.h"
+#include "MetricsStream.h"
 #include "HMC.h"
+#include "Profiler.h"
 
 using namespace std;
 
@@ -44,19 +49,34 @@ public:
 	CasHMCWrapper(string simCfg, string dramCfg);
 	virtual ~CasHMCWrapper();
 	void RegisterCallbacks(TransCompCB *readCB, TransCompCB *writeCB);
-	bool ReceiveTran(TransactionType tranType, uint64_t addr, unsigned size);
+	bool ReceiveTran(TransactionType tranType, uint64_t addr, unsigned size, uint8_t *data=NULL, unsigned priority=0);
 	bool ReceiveTran(Transaction *tran);
 	bool CanAcceptTran();
 	void UpdateMSHR(unsigned mshr);
 	void Update();
+	void CubeUpdate();
+	void CubeLoop();
+	void DrainUpPipe(uint64_t cycle);
+	void SyncCube();
 	void DownLinkUpdate(bool lastUpdate);
 	void UpLinkUpdate(bool lastUpdate);
 	void PrintEpochHeader();
 	void PrintSetting(struct tm t);
 	void MakePlotData();
+	void InitMetrics();
+	void MakeMetricsData();
 	void PrintEpochStatistic();
-	void PrintFinalStatistic();
+	void PrintFinalStatistic(string logSuffix="_result");
+	void ResetStatistic();
+	void SnapshotStatistic();
+	void BeginROI();
+	void EndROI();
 	string DataScaling(double dataScale);
+	double LaneEnergy();
+#ifdef PROFILE
+	void PrintProfile();
+	void PrintProfileLine(string name, ProfileStat &stat, double tscPerNs, uint64_t totalTicks);
+#endif
 	
 	//
 	//Fields
@@ -75,17 +95,46 @@ public:
 	double linkPeriod;
 	string logName;
 	int logNum;
+	bool printEpoch;		//Print epoch progress on the console
+	double laneEnergyLast;	//[pJ] Lane energy of links until the last epoch
+	uint64_t statStartCycle;	//Clock of the last statistic reset
+	uint64_t epochStartCycle;	//Clock of the last epoch statistic
+	
+	//Region of interest (statistics are reset at the beginning, and the ROI result log is printed at the end)
+	bool roiActive;
+	unsigned roiNum;
+	unsigned snapshotNum;
+	bool logDebug;			//DEBUG_SIM and STATE_SIM of the configuration (ROI_LOG_ONLY turns them on only in ROI)
+	bool logState;
+	
+	//Pipeline simulation (PIPELINE_SIM : HMC and upstream links are updated on the cube thread)
+	LinkPipe *downPipe;				//Host thread -> cube thread (downstream packets)
+	LinkPipe *upPipe;				//Cube thread -> host thread (upstream packets, posted tags and traces)
+	TranStatistic cubeStatis;		//Link statistics counted on the cube thread
+	thread cubeThread;
+	atomic<bool> stopCube;
+	unsigned cubeRandSeed;
 	
 	unsigned cpu_link_ratio;
 	unsigned cpu_link_tune;
 	unsigned clockTuner_link;
 	unsigned clockTuner_HMC;
 	
+#ifdef PROFILE
+	//Start time of self-profiling
+	uint64_t profStartTSC;
+	uint64_t profStartWall;
+#endif
+	
 	//Temporary variable for plot data
 	uint64_t hmcTransmitSizeTemp;
 	vector<uint64_t> downLinkDataSizeTemp;
 	vector<uint64_t> upLinkDataSizeTemp;
 	
+	//Metrics time-series (METRICS_CSV and METRICS_BINARY)
+	MetricsStream *metricsOut;
+	vector<uint64_t> metricsLast;		//Counter values at the last metrics sample
+	
 	//Output log files
 	ofstream settingOut;
 	ofstream debugOut;
@@ -24,12 +24,31 @@ CommandQueue::CommandQueue(ofstream &debugOut_, ofstream &stateOut_, unsigned id
 	header = "        (CQ_" + classID.str();
 	
 	refreshWaiting = false;
+	refreshBank = 0;
+	refreshPending = 0;
 	issuedBank = 0;
+	drainMode = false;
+	readQueCnt = 0;
+	writeQueCnt = 0;
+	lastColumnCMD = -1;
 	
 	atomicLock = vector<bool>(NUM_BANKS,false);
 	atomicLockTag = vector<unsigned>(NUM_BANKS,0);
 	tFAWCountdown.reserve(4);
 	rowAccessCounter = vector<unsigned>(NUM_BANKS,0);
+	rowStat = vector<RowStat>(NUM_BANKS, RowStat());
+	rowConflict = vector<bool>(NUM_BANKS, false);
+	closedRow = vector<unsigned>(NUM_BANKS, -1);
+	lastRowAccess = vector<uint64_t>(NUM_BANKS, 0);
+	rowKept = vector<bool>(NUM_BANKS, false);
+	rowPredictor = vector<unsigned>(NUM_BANKS, 2);
+	openMode = true;
+	windowAccess = 0;
+	windowHit = 0;
+	if(ROW_POLICY != STATIC && !OPEN_PAGE) {
+		ERROR(header<<"  == Error - ROW_POLICY except STATIC needs OPEN_PAGE (rows are closed by auto-precharge in close page policy)");
+		exit(0);
+	}
 	if(QUE_PER_BANK) {
 		bufPopDelayPerBank = vector<int>(NUM_BANKS, 0);
 		queue = vector< vector<DRAMCommand *> >(NUM_BANKS, vector<DRAMCommand *>());
@@ -56,6 +75,12 @@ CommandQueue::~CommandQueue()
 	queue.clear();
 	tFAWCountdown.clear();
 	rowAccessCounter.clear();
+	rowStat.clear();
+	rowConflict.clear();
+	closedRow.clear();
+	lastRowAccess.clear();
+	rowKept.clear();
+	rowPredictor.clear();
 }
 
 //
@@ -100,6 +125,7 @@ void CommandQueue::Enqueue(unsigned bank, DRAMCommand *enqCMD)
 		POPCYCLE(bank) = (POPCYCLE(bank)>0) ? POPCYCLE(bank) : 1;
 	}
 	ACCESSQUE(bank).push_back(enqCMD);
+	CountPending(enqCMD, 1);
 }
 
 //
@@ -116,11 +142,17 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 		tFAWCountdown.erase(tFAWCountdown.begin());
 	}
 
+	//Bank state is not changed until the popped command is sent to DRAM
+	bankReady = BANKSTATE.ReadyMask(currentClockCycle);
+	
+	//Per-bank refresh (only the bank to be refreshed is closed, and the other banks keep scheduling)
+	bool perBankRefresh = (refreshWaiting && REFRESH_POLICY == PER_BANK) ? PerBankRefresh(popedCMD) : false;
+
 	//HMC command scheduling policy
 	//Close page
-	if(OPEN_PAGE == false) {
+	if(perBankRefresh == false && OPEN_PAGE == false) {
 		bool foundIssuable = false;
-		if(refreshWaiting) {
+		if(refreshWaiting && REFRESH_POLICY != PER_BANK) {
 			//Look into all bank
 			bool refreshPossible = true;
 			for(int b=0; b<NUM_BANKS; b++) {
@@ -142,13 +174,13 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 				}
 				else {
 					//Need to check whether bank is open or not
-					if(BANKSTATE(b)->currentBankState == ROW_ACTIVE) {
+					if(BANKSTATE.currentBankState[b] == ROW_ACTIVE) {
 						refreshPossible = false;
 						
 						for(int i=0; i<ACCESSQUE(b).size(); i++) {
 							DRAMCommand *tempCMD = ACCESSQUE(b)[i];
 							//If a command in the queue is going to the same bank and row
-							if(b==tempCMD->bank && BANKSTATE(b)->openRowAddress==tempCMD->row) {
+							if(b==tempCMD->bank && BANKSTATE.openRowAddress[b]==tempCMD->row) {
 								//and is not an activate
 								if(tempCMD->commandType != ACTIVATE) {
 									//and can be issued
@@ -172,13 +204,13 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 						break;
 					}
 					//The next ACT and next REF can be issued at the same. nextActivate is considered as nextRefresh
-					else if(BANKSTATE(b)->nextActivate > currentClockCycle) {
+					else if(BANKSTATE.nextActivate[b] > currentClockCycle) {
 						refreshPossible = false;
 						break;
 					}
 				}
 			}
-			if(refreshPossible && BANKSTATE(0)->currentBankState!=POWERDOWN) {
+			if(refreshPossible && BANKSTATE.currentBankState[0]!=POWERDOWN) {
 				*popedCMD = new DRAMCommand(REFRESH, 0, 0, 0, 0, 0, false, NULL, true, NULL_, false, false);
 				foundIssuable = true;
 				refreshWaiting = false;
@@ -208,33 +240,42 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 						}
 						break;
 					}
-					else {
+					//Bank queue is searched only if the bank accepts any command
+					else if(!QUE_PER_BANK || (bankReady.Any() >> issuedBank & 1)) {
 						//Search from beginning to find first issuable command
-						for(int i=0; i<ACCESSQUE(issuedBank).size(); i++) {
-							if(isIssuable(ACCESSQUE(issuedBank)[i])) {
-								//Check to make sure not removing a read/write that is paired with an activate
-								int j;
-								bool dependencyFound = false;
-									for(j=0; j<i; j++) {
-										DRAMCommand *prevCMD = ACCESSQUE(issuedBank)[j];
-										if(prevCMD->commandType==ACTIVATE
-										&& prevCMD->packetTAG==ACCESSQUE(issuedBank)[i]->packetTAG) {
-											dependencyFound = true;
-											break;
+						//(commands of higher QoS classes are searched first)
+						for(int q=QOS_TOP_CLASS; q>=0 && !foundIssuable; q--) {
+							for(int i=0; i<ACCESSQUE(issuedBank).size(); i++) {
+								if(QOS_CLASS(ACCESSQUE(issuedBank)[i]) != (unsigned)q || isBypassing(issuedBank, i))	continue;
+								if(isIssuable(ACCESSQUE(issuedBank)[i]) && !isDeferred(issuedBank, i)) {
+									//Check to make sure not removing a read/write that is paired with an activate
+									int j;
+									bool dependencyFound = false;
+										for(j=0; j<i; j++) {
+											DRAMCommand *prevCMD = ACCESSQUE(issuedBank)[j];
+											if(prevCMD->commandType==ACTIVATE
+											&& prevCMD->packetTAG==ACCESSQUE(issuedBank)[i]->packetTAG) {
+												dependencyFound = true;
+												break;
+											}
 										}
-									}
-								if(dependencyFound) continue;
+									if(dependencyFound) continue;
 								
-								if(ACCESSQUE(issuedBank)[i]->atomic
-								&& (ACCESSQUE(issuedBank)[i]->packetCMD != EQ16
-								&& ACCESSQUE(issuedBank)[i]->packetCMD != EQ8)) {
-									atomicLock[ACCESSQUE(issuedBank)[i]->bank] = true;
-									atomicLockTag[ACCESSQUE(issuedBank)[i]->bank] = ACCESSQUE(issuedBank)[i]->packetTAG;
+									if(ACCESSQUE(issuedBank)[i]->atomic
+									&& (ACCESSQUE(issuedBank)[i]->packetCMD != EQ16
+									&& ACCESSQUE(issuedBank)[i]->packetCMD != EQ8)) {
+										atomicLock[ACCESSQUE(issuedBank)[i]->bank] = true;
+										atomicLockTag[ACCESSQUE(issuedBank)[i]->bank] = ACCESSQUE(issuedBank)[i]->packetTAG;
+									}
+									//Older commands of lower class are bypassed (starvation guard)
+									for(j=0; j<i; j++) {
+										if(QOS_CLASS(ACCESSQUE(issuedBank)[j]) < (unsigned)q)	ACCESSQUE(issuedBank)[j]->bypassed++;
+									}
+									*popedCMD = ACCESSQUE(issuedBank)[i];
+									ACCESSQUE(issuedBank).erase(ACCESSQUE(issuedBank).begin()+i);
+									foundIssuable = true;
+									break;
 								}
-								*popedCMD = ACCESSQUE(issuedBank)[i];
-								ACCESSQUE(issuedBank).erase(ACCESSQUE(issuedBank).begin()+i);
-								foundIssuable = true;
-								break;
 							}
 						}
 					}
@@ -249,9 +290,9 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 		}
 	}
 	//Open page
-	else {
+	else if(perBankRefresh == false) {
 		bool sendingREForPRE = false;
-		if(refreshWaiting) {
+		if(refreshWaiting && REFRESH_POLICY != PER_BANK) {
 			//Look into all bank
 			bool refreshPossible = true;
 			for(int b=0; b<NUM_BANKS; b++) {
@@ -273,14 +314,14 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 				}
 				else {
 					//Need to check whether bank is open or not
-					if(BANKSTATE(b)->currentBankState == ROW_ACTIVE) {
+					if(BANKSTATE.currentBankState[b] == ROW_ACTIVE) {
 						refreshPossible = false;
 						bool closeRow = true;
 
 						for(int i=0; i<ACCESSQUE(b).size(); i++) {
 							DRAMCommand *tempCMD = ACCESSQUE(b)[i];
 							//If a command in the queue is going to the same bank and row
-							if(b==tempCMD->bank && BANKSTATE(b)->openRowAddress==tempCMD->row) {
+							if(b==tempCMD->bank && BANKSTATE.openRowAddress[b]==tempCMD->row) {
 								//and is not an activate
 								if(tempCMD->commandType != ACTIVATE) {
 									closeRow = false;
@@ -302,7 +343,7 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 								}
 							}
 						}
-						if(closeRow && BANKSTATE(b)->nextPrecharge<=currentClockCycle) {
+						if(closeRow && BANKSTATE.nextPrecharge[b]<=currentClockCycle) {
 							rowAccessCounter[b]=0;
 							*popedCMD = new DRAMCommand(PRECHARGE, 0, b, 0, 0, 0, false, NULL, true, NULL_, false, false);
 							sendingREForPRE = true;
@@ -310,14 +351,14 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 						break;
 					}
 					//The next ACT and next REF can be issued at the same. nextActivate is considered as nextRefresh
-					else if(BANKSTATE(b)->nextActivate > currentClockCycle) {
+					else if(BANKSTATE.nextActivate[b] > currentClockCycle) {
 						refreshPossible = false;
 						break;
 					}
 				}
 			}
 			
-			if(refreshPossible && BANKSTATE(0)->currentBankState!=POWERDOWN) {
+			if(refreshPossible && BANKSTATE.currentBankState[0]!=POWERDOWN) {
 				*popedCMD = new DRAMCommand(REFRESH, 0, 0, 0, 0, 0, false, NULL, true, NULL_, false, false);
 				sendingREForPRE = true;
 				refreshWaiting = false;
@@ -346,41 +387,51 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 							}
 						}
 					}
-					else {
+					//Bank queue is searched only if the bank accepts any command
+					else if(!QUE_PER_BANK || (bankReady.Any() >> issuedBank & 1)) {
 						//Search from beginning to find first issuable command
-						for(int i=0; i<ACCESSQUE(issuedBank).size(); i++) {
-							if(isIssuable(ACCESSQUE(issuedBank)[i])) {
-								//Check for dependencies
-								int j;
-								bool dependencyFound = false;
-								for(j=0; j<i; j++) {
-									DRAMCommand *prevCMD = ACCESSQUE(issuedBank)[j];
-									if(prevCMD->commandType != ACTIVATE
-									&& prevCMD->bank == ACCESSQUE(issuedBank)[i]->bank
-									&& prevCMD->row == ACCESSQUE(issuedBank)[i]->row) {
-										dependencyFound = true;
-										break;
+						//(commands of higher QoS classes are searched first)
+						for(int q=QOS_TOP_CLASS; q>=0 && !foundIssuable; q--) {
+							for(int i=0; i<ACCESSQUE(issuedBank).size(); i++) {
+								if(QOS_CLASS(ACCESSQUE(issuedBank)[i]) != (unsigned)q || isBypassing(issuedBank, i))	continue;
+								if(isIssuable(ACCESSQUE(issuedBank)[i]) && !isDeferred(issuedBank, i)) {
+									//Check for dependencies
+									int j;
+									bool dependencyFound = false;
+									for(j=0; j<i; j++) {
+										DRAMCommand *prevCMD = ACCESSQUE(issuedBank)[j];
+										if(prevCMD->commandType != ACTIVATE
+										&& prevCMD->bank == ACCESSQUE(issuedBank)[i]->bank
+										&& prevCMD->row == ACCESSQUE(issuedBank)[i]->row) {
+											dependencyFound = true;
+											break;
+										}
 									}
+									if(dependencyFound) continue;
+									if(ACCESSQUE(issuedBank)[i]->atomic
+									&& (ACCESSQUE(issuedBank)[i]->packetCMD != EQ16 && ACCESSQUE(issuedBank)[i]->packetCMD != EQ8)) {
+										atomicLock[issuedBank] = true;
+										atomicLockTag[issuedBank] = ACCESSQUE(issuedBank)[i]->packetTAG;
+									}
+									//Older commands of lower class are bypassed (starvation guard)
+									for(j=0; j<i; j++) {
+										if(QOS_CLASS(ACCESSQUE(issuedBank)[j]) < (unsigned)q)	ACCESSQUE(issuedBank)[j]->bypassed++;
+									}
+									*popedCMD = ACCESSQUE(issuedBank)[i];
+									//If the previous bus packet is an activate, that activate have to be removed
+									//(check i>0 because if i==0 then theres nothing before it)
+									if(i>0 && ACCESSQUE(issuedBank)[i-1]->commandType==ACTIVATE) {
+										rowAccessCounter[issuedBank]++;
+										RecordRowAccess((*popedCMD)->bank, ROW_HIT, true);
+										delete ACCESSQUE(issuedBank)[i-1];
+										ACCESSQUE(issuedBank).erase(ACCESSQUE(issuedBank).begin()+i-1, ACCESSQUE(issuedBank).begin()+i+1);
+									}
+									else{
+										ACCESSQUE(issuedBank).erase(ACCESSQUE(issuedBank).begin()+i);
+									}
+									foundIssuable = true;
+									break;
 								}
-								if(dependencyFound) continue;
-								if(ACCESSQUE(issuedBank)[i]->atomic
-								&& (ACCESSQUE(issuedBank)[i]->packetCMD != EQ16 && ACCESSQUE(issuedBank)[i]->packetCMD != EQ8)) {
-									atomicLock[issuedBank] = true;
-									atomicLockTag[issuedBank] = ACCESSQUE(issuedBank)[i]->packetTAG;
-								}
-								*popedCMD = ACCESSQUE(issuedBank)[i];
-								//If the previous bus packet is an activate, that activate have to be removed
-								//(check i>0 because if i==0 then theres nothing before it)
-								if(i>0 && ACCESSQUE(issuedBank)[i-1]->commandType==ACTIVATE) {
-									rowAccessCounter[issuedBank]++;
-									delete ACCESSQUE(issuedBank)[i-1];
-									ACCESSQUE(issuedBank).erase(ACCESSQUE(issuedBank).begin()+i-1, ACCESSQUE(issuedBank).begin()+i+1);
-								}
-								else{
-									ACCESSQUE(issuedBank).erase(ACCESSQUE(issuedBank).begin()+i);
-								}
-								foundIssuable = true;
-								break;
 							}
 						}
 					}
@@ -398,18 +449,35 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 				
 				for(int b=0; b<NUM_BANKS; b++) {
 					bool found = false;
-					if(BANKSTATE(b)->currentBankState == ROW_ACTIVE) {
+					if(BANKSTATE.currentBankState[b] == ROW_ACTIVE) {
 						if(!atomicLock[b]) {
+							bool deferredHit = false;
+							bool otherWaiting = false;
 							for(int i=0; i<ACCESSQUE(b).size(); i++) {
 								//If there is something going to opened bank and row, don't send PRE command
-								if(ACCESSQUE(b)[i]->bank==b && ACCESSQUE(b)[i]->row == BANKSTATE(b)->openRowAddress) {
-									found = true;
-									break;
+								if(ACCESSQUE(b)[i]->bank==b && ACCESSQUE(b)[i]->row == BANKSTATE.openRowAddress[b]) {
+									if(!isDeferred(b, i)) {
+										found = true;
+										break;
+									}
+									deferredHit = true;
+								}
+								else if(ACCESSQUE(b)[i]->bank==b && !isDeferred(b, i)) {
+									otherWaiting = true;
 								}
 							}
+							//Deferred write-drain command keeps the row open unless other request is waiting for the bank
+							if(deferredHit && !otherWaiting) {
+								found = true;
+							}
+							//The idle row can be kept open by adaptive row-buffer management
+							bool keepRow = (!found && !otherWaiting && KeepRowOpen(b));
+							if(keepRow) {
+								rowKept[b] = true;
+							}
 							//Too many accesses have happend, close it
-							if(!found || rowAccessCounter[b]>=MAX_ROW_ACCESSES) {
-								if(BANKSTATE(b)->nextPrecharge <= currentClockCycle) {
+							if((!found && !keepRow) || rowAccessCounter[b]>=MAX_ROW_ACCESSES) {
+								if(BANKSTATE.nextPrecharge[b] <= currentClockCycle) {
 									rowAccessCounter[b]=0;
 									*popedCMD = new DRAMCommand(PRECHARGE, 0, b, 0, 0, 0, false, NULL, true, NULL_, false, false);
 									sendingPRE = true;
@@ -428,6 +496,40 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 	if((*popedCMD)->commandType == ACTIVATE) {
 		tFAWCountdown.push_back(tFAW);
 	}
+	else if((*popedCMD)->commandType == REFRESH) {
+		epochRefStat.refreshCnt++;
+	}
+	
+	//Row-buffer access classification (row hit is recorded when its ACT is removed)
+	unsigned popBank = (*popedCMD)->bank;
+	if((*popedCMD)->commandType == ACTIVATE) {
+		RecordRowAccess(popBank, rowConflict[popBank] ? ROW_CONFLICT : ROW_MISS, (*popedCMD)->row == closedRow[popBank]);
+		rowConflict[popBank] = false;
+		lastRowAccess[popBank] = currentClockCycle;
+	}
+	else if((*popedCMD)->commandType == PRECHARGE) {
+		closedRow[popBank] = BANKSTATE.openRowAddress[popBank];
+		for(int i=0; i<ACCESSQUE(popBank).size(); i++) {
+			if(ACCESSQUE(popBank)[i]->bank == popBank && ACCESSQUE(popBank)[i]->row != closedRow[popBank]) {
+				rowConflict[popBank] = true;
+				break;
+			}
+		}
+	}
+	else if((*popedCMD)->commandType != REFRESH) {
+		lastRowAccess[popBank] = currentClockCycle;
+	}
+	CountPending(*popedCMD, -1);
+	
+	//Read/write turnaround on the vault data bus
+	if((*popedCMD)->commandType == READ || (*popedCMD)->commandType == READ_P) {
+		if(lastColumnCMD == 1)	epochTurnStat.writeToRead++;
+		lastColumnCMD = 0;
+	}
+	else if((*popedCMD)->commandType == WRITE || (*popedCMD)->commandType == WRITE_P) {
+		if(lastColumnCMD == 0)	epochTurnStat.readToWrite++;
+		lastColumnCMD = 1;
+	}
 
 	if(QUE_PER_BANK) {
 		classID.str( string() );	classID.clear();
@@ -440,6 +542,105 @@ bool CommandQueue::CmdPop(DRAMCommand **popedCMD)
 	return true;
 }
 
+//
+//Close and refresh the bank in turn (the other banks are not blocked)
+//
+bool CommandQueue::PerBankRefresh(DRAMCommand **popedCMD)
+{
+	unsigned b = refreshBank;
+	//Writing-back atomic command is issued by normal scheduling
+	if(atomicLock[b])	return false;
+	
+	if(BANKSTATE.currentBankState[b] == ROW_ACTIVE) {
+		//Auto-precharge command of the opened row closes the bank
+		if(!OPEN_PAGE)	return false;
+		
+		for(int i=0; i<ACCESSQUE(b).size(); i++) {
+			DRAMCommand *tempCMD = ACCESSQUE(b)[i];
+			//A command going to the opened row is issued first by normal scheduling
+			if(tempCMD->bank == b && tempCMD->row == BANKSTATE.openRowAddress[b]) {
+				if(tempCMD->commandType != ACTIVATE) {
+					return false;
+				}
+				else {
+					break;
+				}
+			}
+		}
+		if(BANKSTATE.nextPrecharge[b] <= currentClockCycle) {
+			rowAccessCounter[b] = 0;
+			*popedCMD = new DRAMCommand(PRECHARGE, 0, b, 0, 0, 0, false, NULL, true, NULL_, false, false);
+			return true;
+		}
+	}
+	//The next ACT and next REF can be issued at the same. nextActivate is considered as nextRefresh
+	else if(BANKSTATE.currentBankState[b] == IDLE && BANKSTATE.nextActivate[b] <= currentClockCycle) {
+		*popedCMD = new DRAMCommand(REFRESH, 0, b, 0, 0, 0, false, NULL, true, NULL_, false, false);
+		refreshWaiting = false;
+		refreshBank = (b<NUM_BANKS-1) ? b+1 : 0;
+		return true;
+	}
+	return false;
+}
+
+//
+//Decide whether the opened row without pending access is kept open (adaptive row-buffer management)
+//
+bool CommandQueue::KeepRowOpen(unsigned bank)
+{
+	switch(ROW_POLICY) {
+		case TIMEOUT:
+			return currentClockCycle < lastRowAccess[bank] + ROW_TIMEOUT;
+		case PREDICT:
+			return rowPredictor[bank] >= 2;
+		case HIT_RATE:
+			return openMode;
+		default:
+			return false;
+	}
+}
+
+//
+//Count row-buffer access and train the open/close predictors
+//
+void CommandQueue::RecordRowAccess(unsigned bank, RowAccessType type, bool sameRow)
+{
+	switch(type) {
+		case ROW_HIT:		rowStat[bank].hit++;		epochRowStat.hit++;			break;
+		case ROW_MISS:		rowStat[bank].miss++;		epochRowStat.miss++;		break;
+		case ROW_CONFLICT:	rowStat[bank].conflict++;	epochRowStat.conflict++;	break;
+	}
+	
+	//Only the accesses after open/close decisions train the predictors (back-to-back hits of queued requests are not counted)
+	//The hit of the row kept open and the miss of the previously closed row vote for keeping the row open
+	bool decision = (type != ROW_HIT) || rowKept[bank];
+	bool openVote = (type == ROW_HIT) || (type == ROW_MISS && sameRow);
+	rowKept[bank] = false;
+	if(!decision)	return;
+	
+	if(openVote) {
+		rowPredictor[bank] = (rowPredictor[bank]<3) ? rowPredictor[bank]+1 : 3;
+	}
+	else {
+		rowPredictor[bank] = (rowPredictor[bank]>0) ? rowPredictor[bank]-1 : 0;
+	}
+	
+	//Vault mode is decided by the open votes of every window (including the misses that an open row would have hit)
+	if(ROW_POLICY == HIT_RATE) {
+		windowAccess++;
+		if(openVote)	windowHit++;
+		if(windowAccess >= ROW_WINDOW) {
+			bool nextMode = (windowHit*100 >= ROW_HIT_THRESHOLD*windowAccess);
+			if(nextMode != openMode) {
+				DEBUG(ALI(33)<<(header+")")<<"Down) Row-buffer mode is changed to "<<(nextMode ? "OPEN" : "CLOSE")<<"  (row-hit rate : "<<windowHit*100/windowAccess<<" %)");
+			}
+			openMode = nextMode;
+			windowAccess = 0;
+			windowHit = 0;
+		}
+	}
+}
+
 //
 //Check command able to be issued
 //
@@ -449,9 +650,9 @@ bool CommandQueue::isIssuable(DRAMCommand *issueCMD)
 		case REFRESH:
 			break;
 		case ACTIVATE:
-			if((BANKSTATE(issueCMD->bank)->currentBankState == IDLE || BANKSTATE(issueCMD->bank)->currentBankState == REFRESHING) 
-			&& BANKSTATE(issueCMD->bank)->nextActivate <= currentClockCycle 
-			&& tFAWCountdown.size() < 4) {
+			if((bankReady.activate >> issueCMD->bank & 1)
+			&& tFAWCountdown.size() < 4
+			&& !(refreshWaiting && REFRESH_POLICY == PER_BANK && issueCMD->bank == refreshBank)) {
 				return true;
 			}
 			else {
@@ -460,9 +661,8 @@ bool CommandQueue::isIssuable(DRAMCommand *issueCMD)
 			break;
 		case WRITE:
 		case WRITE_P:
-			if(BANKSTATE(issueCMD->bank)->currentBankState == ROW_ACTIVE 
-			&& BANKSTATE(issueCMD->bank)->nextWrite <= currentClockCycle
-			&& BANKSTATE(issueCMD->bank)->openRowAddress == issueCMD->row
+			if((bankReady.write >> issueCMD->bank & 1)
+			&& BANKSTATE.openRowAddress[issueCMD->bank] == issueCMD->row
 			&& !(!issueCMD->atomic && rowAccessCounter[issueCMD->bank] >= MAX_ROW_ACCESSES)) {
 				//Check the available buffer space of the vault controller with regard to read/write return data
 				if(issueCMD->atomic) {
@@ -486,9 +686,8 @@ bool CommandQueue::isIssuable(DRAMCommand *issueCMD)
 			break;
 		case READ:
 		case READ_P:
-			if(BANKSTATE(issueCMD->bank)->currentBankState == ROW_ACTIVE
-			&& BANKSTATE(issueCMD->bank)->nextRead <= currentClockCycle
-			&& BANKSTATE(issueCMD->bank)->openRowAddress == issueCMD->row
+			if((bankReady.read >> issueCMD->bank & 1)
+			&& BANKSTATE.openRowAddress[issueCMD->bank] == issueCMD->row
 			&& rowAccessCounter[issueCMD->bank] < MAX_ROW_ACCESSES) {
 				//Check the available buffer space of the vault controller with regard to read/write return data
 				if(vaultContP->pendingDataSize+(issueCMD->dataSize/16)+1 <= (vaultContP->upBufferMax)-(vaultContP->upBuffers.size())) {
@@ -503,8 +702,7 @@ bool CommandQueue::isIssuable(DRAMCommand *issueCMD)
 			}
 			break;
 		case PRECHARGE:
-			if(BANKSTATE(issueCMD->bank)->currentBankState == ROW_ACTIVE
-			&& BANKSTATE(issueCMD->bank)->nextPrecharge <= currentClockCycle) {
+			if(bankReady.precharge >> issueCMD->bank & 1) {
 				return true;
 			}
 			else {
@@ -518,6 +716,92 @@ bool CommandQueue::isIssuable(DRAMCommand *issueCMD)
 	return false;
 }
 
+//
+//Check whether command belongs to a write request (atomic commands are regarded as read)
+//
+bool CommandQueue::isWriteCMD(DRAMCommand *cmd)
+{
+	if(cmd->atomic)	return false;
+	
+	switch(cmd->packetCMD) {
+		case WR16:	case WR32:	case WR48:	case WR64:	case WR80:	case WR96:	case WR112:	case WR128:	case WR256:	case MD_WR:
+		case P_WR16:	case P_WR32:	case P_WR48:	case P_WR64:	case P_WR80:	case P_WR96:	case P_WR112:	case P_WR128:	case P_WR256:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//
+//Check whether command is held back by write-drain scheduling
+//
+bool CommandQueue::isDeferred(unsigned bank, int index)
+{
+	if(!WRITE_DRAIN)	return false;
+	
+	//Writes wait while reads are pending (read mode), and reads wait while writes are drained (drain mode)
+	DRAMCommand *cmd = ACCESSQUE(bank)[index];
+	bool write = isWriteCMD(cmd);
+	if(write ? (drainMode || readQueCnt == 0) : (!drainMode || writeQueCnt == 0)) {
+		return false;
+	}
+	//Command whose ACT is already issued is not held back (the row is opened for it)
+	if(cmd->commandType != ACTIVATE) {
+		bool actWaiting = false;
+		for(int i=0; i<index; i++) {
+			if(ACCESSQUE(bank)[i]->commandType == ACTIVATE && ACCESSQUE(bank)[i]->packetTAG == cmd->packetTAG) {
+				actWaiting = true;
+				break;
+			}
+		}
+		if(!actWaiting)	return false;
+	}
+	//Deferred command is released when a request of the other type is waiting for the same row behind it (request order is kept)
+	for(int i=index+1; i<ACCESSQUE(bank).size(); i++) {
+		DRAMCommand *nextCMD = ACCESSQUE(bank)[i];
+		if(nextCMD->bank == cmd->bank && nextCMD->row == cmd->row && isWriteCMD(nextCMD) != write) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//
+//Check whether command bypasses an older command of lower QoS class to the same row (request order is kept)
+//
+bool CommandQueue::isBypassing(unsigned bank, int index)
+{
+	if(QOS_CLASSES <= 1)	return false;
+	
+	DRAMCommand *cmd = ACCESSQUE(bank)[index];
+	//Atomic command locks the bank until its write-back command is issued from the head of queue
+	bool lockBank = cmd->atomic && cmd->packetCMD != EQ16 && cmd->packetCMD != EQ8;
+	for(int i=0; i<index; i++) {
+		DRAMCommand *prevCMD = ACCESSQUE(bank)[i];
+		if(prevCMD->packetTAG == cmd->packetTAG)	continue;
+		if(lockBank && prevCMD->bank == cmd->bank)	return true;
+		if(prevCMD->bank == cmd->bank && prevCMD->row == cmd->row && QOS_CLASS(prevCMD) < QOS_CLASS(cmd)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//
+//Count pending read/write requests in command queue (the last column command represents the request)
+//
+void CommandQueue::CountPending(DRAMCommand *cmd, int delta)
+{
+	if(!cmd->lastCMD)	return;
+	
+	if(cmd->commandType == READ || cmd->commandType == READ_P) {
+		readQueCnt += delta;
+	}
+	else if((cmd->commandType == WRITE || cmd->commandType == WRITE_P) && !cmd->atomic) {
+		writeQueCnt += delta;
+	}
+}
+
 //
 //Check whether command queue is empty or not
 //
@@ -540,6 +824,31 @@ void CommandQueue::Update()
 		POPCYCLE(b) = (POPCYCLE(b)>0) ? POPCYCLE(b)-1 : 0;
 		if(!QUE_PER_BANK)	break;	
 	}
+	
+	//Write-drain mode transition by the watermarks of pending write requests
+	if(WRITE_DRAIN) {
+		if(!drainMode && writeQueCnt >= WRITE_HIGH_WATERMARK) {
+			drainMode = true;
+			epochTurnStat.drainBurst++;
+			DEBUG(ALI(33)<<(header+")")<<"Down) Write-drain mode START  (pending write : "<<writeQueCnt<<", pending read : "<<readQueCnt<<")");
+		}
+		else if(drainMode && writeQueCnt <= WRITE_LOW_WATERMARK) {
+			drainMode = false;
+			DEBUG(ALI(33)<<(header+")")<<"Down) Write-drain mode END  (pending write : "<<writeQueCnt<<", pending read : "<<readQueCnt<<")");
+		}
+	}
+	epochTurnStat.writeQueSum += writeQueCnt;
+	epochTurnStat.writeQueMax = max(epochTurnStat.writeQueMax, (uint64_t)writeQueCnt);
+	epochTurnStat.cycles++;
+	
+	//Refresh-induced stall (pending commands wait for a refreshing bank or a bank to be refreshed)
+	for(int b=0; b<NUM_BANKS; b++) {
+		if(ACCESSQUE(b).size() > 0 && (BANKSTATE.currentBankState[b] == REFRESHING
+		|| (refreshWaiting && (REFRESH_POLICY != PER_BANK || b == refreshBank)))) {
+			epochRefStat.stallCycles++;
+			break;
+		}
+	}
 
 	Step();
 }
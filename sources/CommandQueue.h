@@ -15,19 +15,85 @@
 //CommandQueue.h
 
 #include <vector>		//vector
+#include <algorithm>	//max
 
 #include "SimulatorObject.h"
+#include "BankState.h"
 #include "ConfigValue.h"
 #include "DRAMCommand.h"
 
 #define ACCESSQUE(b) (QUE_PER_BANK==true ? queue[b] : queue[0])
 #define POPCYCLE(b) (QUE_PER_BANK==true ? bufPopDelayPerBank[b] : bufPopDelayPerBank[0])
-#define BANKSTATE(b) vaultContP->dramP->bankStates[b]
+#define BANKSTATE vaultContP->dramP->bankStates
 
 using namespace std;
 
 namespace CasHMC
 {
+//Read/write turnaround and write queue statistic of one vault
+class TurnaroundStat
+{
+public:
+	TurnaroundStat():readToWrite(0), writeToRead(0), drainBurst(0), writeQueSum(0), writeQueMax(0), cycles(0) {}
+	TurnaroundStat &operator+=(const TurnaroundStat &t) {
+		readToWrite += t.readToWrite;
+		writeToRead += t.writeToRead;
+		drainBurst += t.drainBurst;
+		writeQueSum += t.writeQueSum;
+		writeQueMax = max(writeQueMax, t.writeQueMax);
+		cycles += t.cycles;
+		return *this;
+	}
+
+	uint64_t readToWrite;	//The number of READ followed by WRITE on the vault data bus
+	uint64_t writeToRead;	//The number of WRITE followed by READ on the vault data bus
+	uint64_t drainBurst;	//The number of write-drain mode entries
+	uint64_t writeQueSum;	//Pending write requests accumulated every cycle
+	uint64_t writeQueMax;
+	uint64_t cycles;
+};
+
+//Refresh statistic of one vault
+class RefreshStat
+{
+public:
+	RefreshStat():refreshCnt(0), stallCycles(0), postponedMax(0) {}
+	RefreshStat &operator+=(const RefreshStat &r) {
+		refreshCnt += r.refreshCnt;
+		stallCycles += r.stallCycles;
+		postponedMax = max(postponedMax, r.postponedMax);
+		return *this;
+	}
+
+	uint64_t refreshCnt;	//The number of issued REFRESH commands
+	uint64_t stallCycles;	//Cycles that pending commands wait for a refreshing (or to be refreshed) bank
+	uint64_t postponedMax;	//The maximum number of postponed refreshes (ELASTIC)
+};
+
+enum RowAccessType
+{
+	ROW_HIT,		//The row is already opened
+	ROW_MISS,		//The bank is closed
+	ROW_CONFLICT	//The other row is closed for the access
+};
+
+//Row-buffer access statistic of one bank (or one vault)
+class RowStat
+{
+public:
+	RowStat():hit(0), miss(0), conflict(0) {}
+	RowStat &operator+=(const RowStat &r) {
+		hit += r.hit;
+		miss += r.miss;
+		conflict += r.conflict;
+		return *this;
+	}
+
+	uint64_t hit;
+	uint64_t miss;
+	uint64_t conflict;
+};
+
 //forward declaration
 class VaultController;
 class CommandQueue : public SimulatorObject
@@ -41,7 +107,14 @@ public:
 	bool AvailableSpace(unsigned bank, unsigned cmdN);
 	void Enqueue(unsigned bank, DRAMCommand *enqCMD);
 	bool CmdPop(DRAMCommand **popedCMD);
+	bool PerBankRefresh(DRAMCommand **popedCMD);
+	bool KeepRowOpen(unsigned bank);
+	void RecordRowAccess(unsigned bank, RowAccessType type, bool sameRow);
 	bool isIssuable(DRAMCommand *issueCMD);
+	bool isWriteCMD(DRAMCommand *cmd);
+	bool isDeferred(unsigned bank, int index);
+	bool isBypassing(unsigned bank, int index);
+	void CountPending(DRAMCommand *cmd, int delta);
 	bool isEmpty();
 	void Update();
 	void PrintState();
@@ -52,7 +125,32 @@ public:
 	unsigned cmdQueID;
 	unsigned issuedBank;
 	bool refreshWaiting;
+	unsigned refreshBank;		//The next bank to be refreshed (PER_BANK)
+	unsigned refreshPending;	//The number of postponed refreshes (ELASTIC)
 	VaultController *vaultContP;
+	BankReadyMask bankReady;	//Banks able to accept each command type in this cycle (made at CmdPop)
+
+	//Write-drain scheduling
+	bool drainMode;				//Writes are drained while true, reads are prioritized while false
+	unsigned readQueCnt;		//The number of pending read requests (including atomic)
+	unsigned writeQueCnt;		//The number of pending write requests
+	int lastColumnCMD;			//-1:none, 0:READ, 1:WRITE
+	TurnaroundStat epochTurnStat;
+	TurnaroundStat totalTurnStat;
+	RefreshStat epochRefStat;
+	RefreshStat totalRefStat;
+	
+	//Adaptive row-buffer management
+	vector<RowStat> rowStat;			//Row-hit/miss/conflict counters per bank
+	RowStat epochRowStat;
+	vector<bool> rowConflict;			//The bank is precharged while requests to the other row are waiting
+	vector<unsigned> closedRow;			//The last row closed by PRECHARGE
+	vector<uint64_t> lastRowAccess;		//Clock of the last ACT or column command (TIMEOUT)
+	vector<bool> rowKept;				//The idle row is kept open by the policy
+	vector<unsigned> rowPredictor;		//2-bit saturating counter (0,1:close  2,3:keep open) (PREDICT)
+	bool openMode;						//Rows are kept open while true (HIT_RATE)
+	unsigned windowAccess;
+	unsigned windowHit;
 
 	
 	vector<bool> atomicLock;
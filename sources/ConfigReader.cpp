@@ -13,9 +13,10 @@
 	
 //Configure values that are extern vaules
 
-//The unique identifier for transaction and packet
-unsigned tranGlobalID = 0;
-unsigned packetGlobalTAG = 0;
+//The unique identifier for transaction
+thread_local unsigned tranGlobalID = 0;	//Per simulation thread (multi-channel driver)
+//Random seed of the cube thread (NULL uses rand())
+thread_local unsigned *simRandSeed = NULL;
 
 //
 //SimConfig.ini
@@ -24,8 +25,12 @@ uint64_t LOG_EPOCH;
 bool DEBUG_SIM;
 bool ONLY_CR;
 bool STATE_SIM;
+bool ROI_LOG_ONLY;
 int PLOT_SAMPLING;
 bool BANDWIDTH_PLOT;
+bool PIPELINE_SIM;
+bool METRICS_CSV;
+bool METRICS_BINARY;
 
 double CPU_CLK_PERIOD;
 int TRANSACTION_SIZE;
@@ -54,6 +59,7 @@ double LINK_SCALING;
 double PowPerLane;
 double SleepPow;
 double DownPow;
+double FlitEnergy;
 
 double tPST;
 double tSME;
@@ -68,6 +74,16 @@ double tRESP1;
 double tRESP2;
 double tPSC;
 
+CROSSBAR_SCHEME CROSSBAR_MODEL;
+CROSSBAR_ALLOCATOR CROSSBAR_ALLOC;
+int CROSSBAR_ITER;
+int MAX_VOQ_BUF;
+int HOST_ISSUE_WIDTH;
+int HOST_RETIRE_WIDTH;
+int NUM_TAGS;
+int QOS_CLASSES;
+int QOS_BYPASS_LIMIT;
+
 //
 //DRAMConfig.ini
 //
@@ -77,12 +93,24 @@ int NUM_BANKS;
 int NUM_ROWS;
 int NUM_COLS;
 MAPPING_SCHEME ADDRESS_MAPPING;
+string ADDRESS_ORDER = "RO_CO_BA_VA";
+string VAULT_HASH = "NONE";
+string BANK_HASH = "NONE";
 bool QUE_PER_BANK;
 bool OPEN_PAGE;
 int MAX_ROW_ACCESSES;
+ROW_SCHEME ROW_POLICY;
+int ROW_HIT_THRESHOLD;
+int ROW_WINDOW;
 bool USE_LOW_POWER;
+bool FUNCTIONAL_MEM;
+bool WRITE_DRAIN;
+int WRITE_HIGH_WATERMARK;
+int WRITE_LOW_WATERMARK;
 
 int REFRESH_PERIOD;
+REFRESH_SCHEME REFRESH_POLICY;
+int REFRESH_MAX_POSTPONE;
 
 double tCK;
 unsigned CWL;
@@ -99,10 +127,21 @@ unsigned tWTR;
 unsigned tWR;
 unsigned tRTRS;
 unsigned tRFC;
+unsigned tRFCpb;
 unsigned tFAW;
 unsigned tCKE;
 unsigned tXP;
 unsigned tCMD;
+unsigned ROW_TIMEOUT;
+
+double VDD;
+double IDD0;
+double IDD2P;
+double IDD2N;
+double IDD3N;
+double IDD4R;
+double IDD4W;
+double IDD5B;
 
 #define DEFINE_PARAM(type, name) {#name, &name, type, false}
 
@@ -115,6 +154,8 @@ static ConfigMap configMap[] =
 	DEFINE_PARAM(UINT64, LOG_EPOCH),		DEFINE_PARAM(BOOL, DEBUG_SIM),
 	DEFINE_PARAM(BOOL, ONLY_CR),			DEFINE_PARAM(BOOL, STATE_SIM),
 	DEFINE_PARAM(INT, PLOT_SAMPLING),		DEFINE_PARAM(BOOL, BANDWIDTH_PLOT),
+	DEFINE_PARAM(BOOL, PIPELINE_SIM),		DEFINE_PARAM(BOOL, METRICS_CSV),
+	DEFINE_PARAM(BOOL, METRICS_BINARY),		DEFINE_PARAM(BOOL, ROI_LOG_ONLY),
 	DEFINE_PARAM(DOUBLE, CPU_CLK_PERIOD),	DEFINE_PARAM(INT, TRANSACTION_SIZE),
 	DEFINE_PARAM(INT, MAX_REQ_BUF),			DEFINE_PARAM(INT, NUM_LINKS),
 	DEFINE_PARAM(INT, LINK_WIDTH),			DEFINE_PARAM(DOUBLE, LINK_SPEED),
@@ -133,6 +174,11 @@ static ConfigMap configMap[] =
 	DEFINE_PARAM(DOUBLE, tOP),				DEFINE_PARAM(DOUBLE, tQUIESCE),
 	DEFINE_PARAM(DOUBLE, tTXD),				DEFINE_PARAM(DOUBLE, tRESP1),
 	DEFINE_PARAM(DOUBLE, tRESP2),			DEFINE_PARAM(DOUBLE, tPSC),
+	DEFINE_PARAM(STRING, CROSSBAR_MODEL),	DEFINE_PARAM(STRING, CROSSBAR_ALLOC),
+	DEFINE_PARAM(INT, CROSSBAR_ITER),		DEFINE_PARAM(INT, MAX_VOQ_BUF),
+	DEFINE_PARAM(INT, HOST_ISSUE_WIDTH),	DEFINE_PARAM(INT, HOST_RETIRE_WIDTH),
+	DEFINE_PARAM(INT, NUM_TAGS),			DEFINE_PARAM(INT, QOS_CLASSES),
+	DEFINE_PARAM(INT, QOS_BYPASS_LIMIT),		DEFINE_PARAM(DOUBLE, FlitEnergy),
 	
 	//DRAMConfig.ini
 	DEFINE_PARAM(INT, MEMORY_DENSITY),		DEFINE_PARAM(INT, NUM_VAULTS),
@@ -150,6 +196,17 @@ static ConfigMap configMap[] =
 	DEFINE_PARAM(UNSIGNED_CLK, tRTRS),		DEFINE_PARAM(UNSIGNED_CLK, tRFC),
 	DEFINE_PARAM(UNSIGNED_CLK, tFAW),		DEFINE_PARAM(UNSIGNED_CLK, tCKE),
 	DEFINE_PARAM(UNSIGNED_CLK, tXP),		DEFINE_PARAM(UNSIGNED_CLK, tCMD),
+	DEFINE_PARAM(BOOL, FUNCTIONAL_MEM),		DEFINE_PARAM(STRING, ADDRESS_ORDER),
+	DEFINE_PARAM(STRING, VAULT_HASH),		DEFINE_PARAM(STRING, BANK_HASH),
+	DEFINE_PARAM(BOOL, WRITE_DRAIN),		DEFINE_PARAM(INT, WRITE_HIGH_WATERMARK),
+	DEFINE_PARAM(INT, WRITE_LOW_WATERMARK),	DEFINE_PARAM(STRING, REFRESH_POLICY),
+	DEFINE_PARAM(INT, REFRESH_MAX_POSTPONE),	DEFINE_PARAM(UNSIGNED_CLK, tRFCpb),
+	DEFINE_PARAM(STRING, ROW_POLICY),		DEFINE_PARAM(INT, ROW_HIT_THRESHOLD),
+	DEFINE_PARAM(INT, ROW_WINDOW),			DEFINE_PARAM(UNSIGNED_CLK, ROW_TIMEOUT),
+	DEFINE_PARAM(DOUBLE, VDD),				DEFINE_PARAM(DOUBLE, IDD0),
+	DEFINE_PARAM(DOUBLE, IDD2P),			DEFINE_PARAM(DOUBLE, IDD2N),
+	DEFINE_PARAM(DOUBLE, IDD3N),			DEFINE_PARAM(DOUBLE, IDD4R),
+	DEFINE_PARAM(DOUBLE, IDD4W),			DEFINE_PARAM(DOUBLE, IDD5B),
 	//end of list
 	{"", NULL, BOOL, false}
 };
@@ -237,6 +294,15 @@ void SetField(string field_name, string field_value)
 					else if(field_value == "BUFFER_AWARE") {
 						LINK_PRIORITY = BUFFER_AWARE;
 					}
+					else if(field_value == "ADDRESS_HASH") {
+						LINK_PRIORITY = ADDRESS_HASH;
+					}
+					else if(field_value == "LEAST_FLITS") {
+						LINK_PRIORITY = LEAST_FLITS;
+					}
+					else if(field_value == "LATENCY_AWARE") {
+						LINK_PRIORITY = LATENCY_AWARE;
+					}
 					else {
 						ERROR(" == Error - Unknown field_value ["<<field_value<<"] for field_name ["<<field_name<<"] in ini file");
 						exit(0);
@@ -264,6 +330,32 @@ void SetField(string field_name, string field_value)
 						exit(0);
 					}
 				}
+				//CROSSBAR_SCHEME
+				else if(configMap[i].fieldName == "CROSSBAR_MODEL") {
+					if(field_value == "SHARED_BUF") {
+						CROSSBAR_MODEL = SHARED_BUF;
+					}
+					else if(field_value == "VOQ") {
+						CROSSBAR_MODEL = VOQ;
+					}
+					else {
+						ERROR(" == Error - Unknown field_value ["<<field_value<<"] for field_name ["<<field_name<<"] in ini file");
+						exit(0);
+					}
+				}
+				//CROSSBAR_ALLOCATOR
+				else if(configMap[i].fieldName == "CROSSBAR_ALLOC") {
+					if(field_value == "ISLIP") {
+						CROSSBAR_ALLOC = ISLIP;
+					}
+					else if(field_value == "WAVEFRONT") {
+						CROSSBAR_ALLOC = WAVEFRONT;
+					}
+					else {
+						ERROR(" == Error - Unknown field_value ["<<field_value<<"] for field_name ["<<field_name<<"] in ini file");
+						exit(0);
+					}
+				}
 				//MAPPING_SCHEME
 				else if(configMap[i].fieldName == "ADDRESS_MAPPING") {
 					if(field_value == "MAX_BLOCK_32B") {
@@ -283,6 +375,51 @@ void SetField(string field_name, string field_value)
 						exit(0);
 					}
 				}
+				//REFRESH_SCHEME
+				else if(configMap[i].fieldName == "REFRESH_POLICY") {
+					if(field_value == "ALL_BANK") {
+						REFRESH_POLICY = ALL_BANK;
+					}
+					else if(field_value == "PER_BANK") {
+						REFRESH_POLICY = PER_BANK;
+					}
+					else if(field_value == "ELASTIC") {
+						REFRESH_POLICY = ELASTIC;
+					}
+					else {
+						ERROR(" == Error - Unknown field_value ["<<field_value<<"] for field_name ["<<field_name<<"] in ini file");
+						exit(0);
+					}
+				}
+				//ROW_SCHEME
+				else if(configMap[i].fieldName == "ROW_POLICY") {
+					if(field_value == "STATIC") {
+						ROW_POLICY = STATIC;
+					}
+					else if(field_value == "TIMEOUT") {
+						ROW_POLICY = TIMEOUT;
+					}
+					else if(field_value == "PREDICT") {
+						ROW_POLICY = PREDICT;
+					}
+					else if(field_value == "HIT_RATE") {
+						ROW_POLICY = HIT_RATE;
+					}
+					else {
+						ERROR(" == Error - Unknown field_value ["<<field_value<<"] for field_name ["<<field_name<<"] in ini file");
+						exit(0);
+					}
+				}
+				//Address mapping specification (parsed in AddressMap)
+				else if(configMap[i].fieldName == "ADDRESS_ORDER") {
+					ADDRESS_ORDER = field_value;
+				}
+				else if(configMap[i].fieldName == "VAULT_HASH") {
+					VAULT_HASH = field_value;
+				}
+				else if(configMap[i].fieldName == "BANK_HASH") {
+					BANK_HASH = field_value;
+				}
 				break;
 			}
 			case BOOL: {
@@ -15,7 +15,9 @@
 //ConfigValue.h
 
 #include <stdint.h>		//uint64_t
+#include <stdlib.h>		//rand_r
 #include <iostream>		//cerr
+#include <string>		//string
 
 //
 //Debug setting
@@ -46,7 +48,10 @@
 enum LINK_PRIORITY_SCHEME			//If you want to make new sceme, it is necessary to modify FindAvailableLink function
 {
 	ROUND_ROBIN,
-	BUFFER_AWARE
+	BUFFER_AWARE,
+	ADDRESS_HASH,					//Home link of the vault quadrant (the least loaded link if the home link is not available)
+	LEAST_FLITS,					//The least outstanding flits (unreturned tokens + buffered flits)
+	LATENCY_AWARE					//The least recent token round-trip time
 };
 
 enum LINK_POWER_MANAGEMENT			//Link power state management
@@ -58,6 +63,33 @@ enum LINK_POWER_MANAGEMENT			//Link power state management
 	AUTONOMOUS
 };
 
+enum CROSSBAR_SCHEME					//Crossbar switch input buffering
+{
+	SHARED_BUF,
+	VOQ
+};
+
+enum CROSSBAR_ALLOCATOR				//Separable allocator of VOQ crossbar switch
+{
+	ISLIP,
+	WAVEFRONT
+};
+
+enum REFRESH_SCHEME					//DRAM refresh scheduling
+{
+	ALL_BANK,
+	PER_BANK,
+	ELASTIC
+};
+
+enum ROW_SCHEME						//Row-buffer management
+{
+	STATIC,
+	TIMEOUT,
+	PREDICT,
+	HIT_RATE
+};
+
 enum MAPPING_SCHEME
 {
 	MAX_BLOCK_32B=32,
@@ -75,8 +107,12 @@ extern uint64_t LOG_EPOCH;
 extern bool DEBUG_SIM;
 extern bool ONLY_CR;
 extern bool STATE_SIM;
+extern bool ROI_LOG_ONLY;
 extern int PLOT_SAMPLING;
 extern bool BANDWIDTH_PLOT;
+extern bool PIPELINE_SIM;
+extern bool METRICS_CSV;
+extern bool METRICS_BINARY;
 
 extern double CPU_CLK_PERIOD;
 extern int TRANSACTION_SIZE;
@@ -105,6 +141,7 @@ extern double LINK_SCALING;
 extern double PowPerLane;
 extern double SleepPow;
 extern double DownPow;
+extern double FlitEnergy;
 
 extern double tPST;
 extern double tSME;
@@ -119,6 +156,16 @@ extern double tRESP1;
 extern double tRESP2;
 extern double tPSC;
 
+extern CROSSBAR_SCHEME CROSSBAR_MODEL;
+extern CROSSBAR_ALLOCATOR CROSSBAR_ALLOC;
+extern int CROSSBAR_ITER;
+extern int MAX_VOQ_BUF;
+extern int HOST_ISSUE_WIDTH;
+extern int HOST_RETIRE_WIDTH;
+extern int NUM_TAGS;
+extern int QOS_CLASSES;
+extern int QOS_BYPASS_LIMIT;
+
 //
 //DRAMConfig.ini
 //
@@ -128,12 +175,24 @@ extern int NUM_BANKS;
 extern int NUM_ROWS;
 extern int NUM_COLS;
 extern MAPPING_SCHEME ADDRESS_MAPPING;
+extern std::string ADDRESS_ORDER;
+extern std::string VAULT_HASH;
+extern std::string BANK_HASH;
 extern bool QUE_PER_BANK;
 extern bool OPEN_PAGE;
 extern int MAX_ROW_ACCESSES;
+extern ROW_SCHEME ROW_POLICY;
+extern int ROW_HIT_THRESHOLD;
+extern int ROW_WINDOW;
 extern bool USE_LOW_POWER;
+extern bool FUNCTIONAL_MEM;
+extern bool WRITE_DRAIN;
+extern int WRITE_HIGH_WATERMARK;
+extern int WRITE_LOW_WATERMARK;
 
 extern int REFRESH_PERIOD;
+extern REFRESH_SCHEME REFRESH_POLICY;
+extern int REFRESH_MAX_POSTPONE;
 
 extern double tCK;
 extern unsigned CWL;
@@ -150,14 +209,26 @@ extern unsigned tWTR;
 extern unsigned tWR;
 extern unsigned tRTRS;
 extern unsigned tRFC;
+extern unsigned tRFCpb;
 extern unsigned tFAW;
 extern unsigned tCKE;
 extern unsigned tXP;
 extern unsigned tCMD;
+extern unsigned ROW_TIMEOUT;
+
+extern double VDD;
+extern double IDD0;
+extern double IDD2P;
+extern double IDD2N;
+extern double IDD3N;
+extern double IDD4R;
+extern double IDD4W;
+extern double IDD5B;
 
 #define RL (AL+CL)
 #define WL (AL+CWL)
 #define BL ((unsigned)ADDRESS_MAPPING/32)
+#define METRICS_OUT (METRICS_CSV || METRICS_BINARY)
 
 #define READ_TO_PRE_DELAY (AL+BL/2+max(tRTP,tCCD)-tCCD)
 #define WRITE_TO_PRE_DELAY (WL+BL/2+tWR)
@@ -167,6 +238,17 @@ extern unsigned tCMD;
 #define WRITE_TO_READ_DELAY_B (WL+BL/2+tWTR)
 //#define WRITE_TO_READ_DELAY_R (WL+BL/2+tRTRS-RL)
 
+//QoS arbitration class (a request bypassed QOS_BYPASS_LIMIT times is promoted above the highest class)
+#define QOS_CLASS(req)	((QOS_CLASSES > 1 && (req)->bypassed >= (unsigned)QOS_BYPASS_LIMIT) ? (unsigned)QOS_CLASSES : (req)->priority)
+#define QOS_TOP_CLASS	((QOS_CLASSES > 1) ? QOS_CLASSES : 0)
+
+//Random number of the simulation thread (the cube thread of PIPELINE_SIM keeps its own sequence)
+extern thread_local unsigned *simRandSeed;
+int inline SimRand()
+{
+	return (simRandSeed == NULL) ? rand() : rand_r(simRandSeed);
+}
+
 
 namespace CasHMC
 {
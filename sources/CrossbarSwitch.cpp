@@ -20,13 +20,44 @@ CrossbarSwitch::CrossbarSwitch(ofstream &debugOut_, ofstream &stateOut_):
 	header = "        (CS)";
 	
 	inServiceLink = -1;
+	tagPool = NULL;
+	upPipe = NULL;
 
 	downBufferDest = vector<DualVectorObject<Packet, Packet> *>(NUM_VAULTS, NULL);
 	upBufferDest = vector<LinkMaster *>(NUM_LINKS, NULL);
+	
+	if(CROSSBAR_MODEL == VOQ) {
+		if(MAX_VOQ_BUF < 17) {
+			ERROR(header<<"  == Error - MAX_VOQ_BUF ("<<MAX_VOQ_BUF<<") should be bigger than the maximum packet length (17)");
+			exit(0);
+		}
+		if(CROSSBAR_ITER < 1) {
+			ERROR(header<<"  == Error - CROSSBAR_ITER ("<<CROSSBAR_ITER<<") should be bigger than 0");
+			exit(0);
+		}
+		voq = vector<vector<vector<Packet *> > >(NUM_LINKS, vector<vector<Packet *> >(NUM_VAULTS, vector<Packet *>()));
+		voqRequest = vector<vector<bool> >(NUM_LINKS, vector<bool>(NUM_VAULTS, false));
+		voqFlits = vector<unsigned>(NUM_LINKS, 0);
+		grantPointer = vector<unsigned>(NUM_VAULTS, 0);
+		acceptPointer = vector<unsigned>(NUM_LINKS, 0);
+	}
+	wavefrontPriority = 0;
 }
 
 CrossbarSwitch::~CrossbarSwitch()
 {	
+	for(int l=0; l<voq.size(); l++) {
+		for(int v=0; v<voq[l].size(); v++) {
+			for(int i=0; i<voq[l][v].size(); i++) {
+				delete voq[l][v][i];
+			}
+		}
+	}
+	for(int i=0; i<voqIngress.size(); i++) {
+		delete voqIngress[i];
+	}
+	voq.clear();
+	voqIngress.clear();
 	downBufferDest.clear();
 	upBufferDest.clear();
 	pendingSegTag.clear(); 
@@ -55,48 +86,174 @@ void CrossbarSwitch::CallbackReceiveUp(Packet *upEle, bool chkReceive)
 	}*/
 }
 
+//
+//Link slave packet is received in the shared buffer or the input buffer of its source link
+//
+bool CrossbarSwitch::ReceiveDown(Packet *downEle)
+{
+	bool chkReceive;
+	unsigned packetLNG = downEle->LNG();
+	if(CROSSBAR_MODEL == VOQ) {
+		//Input buffer space is reserved for the segment packets
+		if(downEle->reqDataSize > ADDRESS_MAPPING) {
+			int segPacket = ceil((double)downEle->reqDataSize/ADDRESS_MAPPING);
+			packetLNG = segPacket * ((downEle->LNG() > 1) ? 1 + ADDRESS_MAPPING/16 : 1);
+		}
+		chkReceive = (voqFlits[downEle->SLID()] + packetLNG <= MAX_VOQ_BUF);
+		if(chkReceive) {
+			voqIngress.push_back(downEle);
+			voqFlits[downEle->SLID()] += packetLNG;
+		}
+		CallbackReceiveDown(downEle, chkReceive);
+	}
+	else {
+		chkReceive = DualVectorObject<Packet, Packet>::ReceiveDown(downEle);
+	}
+	
+	//The refused packet is blocked by the other packets even though its vault controller has space
+	if(!chkReceive) {
+		epochCrossStat.inputBlock++;
+		if(VaultReady(addressMap->Vault(downEle->ADRS()), downEle)) {
+			epochCrossStat.holBlock++;
+		}
+	}
+	return chkReceive;
+}
+
+//
+//Check whether vault controller buffer has space for the packet (or its first segment packet)
+//
+bool CrossbarSwitch::VaultReady(unsigned vault, Packet *packet)
+{
+	unsigned packetLNG = packet->LNG();
+	if(packet->reqDataSize > ADDRESS_MAPPING && packet->LNG() > 1) {
+		packetLNG = 1 + ADDRESS_MAPPING/16;
+	}
+	return (downBufferDest[vault]->downBuffers.size() + packetLNG <= downBufferDest[vault]->downBufferMax);
+}
+
+//
+//The packet is divided into segment packets by max block size
+//
+void CrossbarSwitch::DivideSegment(Packet *packet, vector<Packet *> &segPackets)
+{
+	int segPacket = ceil((double)packet->reqDataSize/ADDRESS_MAPPING);
+	packet->reqDataSize = ADDRESS_MAPPING;
+	DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) Packet is DIVIDED into "<<segPacket<<" segment packets by max block size");
+	
+	if(packet->LNG() > 1)	packet->SetLNG(1 + ADDRESS_MAPPING/16);	//one flit is 16 bytes
+	//Posted segment packets are not returned, and each of them frees the request tag once
+	bool posted = packet->IsPosted();
+	if(posted && upPipe != NULL)		upPipe->PushTagSegment(packet->TAG(), segPacket-1);
+	else if(posted && tagPool != NULL)	tagPool->AddSegment(packet->TAG(), segPacket-1);
+	for(int j=0; j<segPacket; j++) {
+		Packet *vaultPacket = new Packet(*packet);
+		vaultPacket->SetADRS(vaultPacket->ADRS() + j*ADDRESS_MAPPING);
+		if(vaultPacket->payload != NULL)	vaultPacket->payload += j*ADDRESS_MAPPING;
+		if(j>0)	vaultPacket->trace = NULL;
+		vaultPacket->segment = true;
+		if(!posted)	pendingSegTag.push_back(vaultPacket->TAG());
+		segPackets.push_back(vaultPacket);
+	}
+	delete packet;
+}
+
+//
+//Check whether an older packet of lower QoS class is going to the same block (the packet should not bypass it)
+//
+bool CrossbarSwitch::BlockDependency(int index)
+{
+	unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
+	for(int j=0; j<index; j++) {
+		if(downBuffers[j] != NULL && QOS_CLASS(downBuffers[j]) < QOS_CLASS(downBuffers[index])
+		&& (downBuffers[j]->ADRS() >> maxBlockBit) == (downBuffers[index]->ADRS() >> maxBlockBit)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//
+//Move the oldest packet of the highest QoS class to the head of VOQ
+//
+void CrossbarSwitch::PromoteVOQ(vector<Packet *> &queue)
+{
+	unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
+	int sel = 0;
+	for(int i=1; i<queue.size(); i++) {
+		if(QOS_CLASS(queue[i]) <= QOS_CLASS(queue[sel]))	continue;
+		//A packet does not bypass an older packet to the same block
+		bool dependent = false;
+		for(int j=0; j<i; j++) {
+			if((queue[j]->ADRS() >> maxBlockBit) == (queue[i]->ADRS() >> maxBlockBit)) {
+				dependent = true;
+				break;
+			}
+		}
+		if(!dependent)	sel = i;
+	}
+	if(sel == 0)	return;
+	
+	Packet *packet = queue[sel];
+	for(int j=0; j<sel; j++) {
+		if(QOS_CLASS(queue[j]) < QOS_CLASS(packet))	queue[j]->bypassed++;
+	}
+	queue.erase(queue.begin()+sel);
+	queue.insert(queue.begin(), packet);
+	DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) PROMOTED to the head of VOQ (class "<<packet->priority<<")");
+}
+
 //
 //Update the state of crossbar switch
 //
 void CrossbarSwitch::Update()
 {	
 	//Downstream buffer state
-	if(bufPopDelay == 0) {
-		for(int i=0; i<downBuffers.size(); i++) {
-			if(downBuffers[i] != NULL) {
-				//Check request size and the maximum block size
-				if(downBuffers[i]->reqDataSize > ADDRESS_MAPPING) {
-					int segPacket = ceil((double)downBuffers[i]->reqDataSize/ADDRESS_MAPPING);
-					downBuffers[i]->reqDataSize = ADDRESS_MAPPING;
-					DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[i]<<"Down) Packet is DIVIDED into "<<segPacket<<" segment packets by max block size");
-					
-					//the packet is divided into segment packets.
-					Packet *tempPacket = downBuffers[i];
-					downBuffers.erase(downBuffers.begin()+i, downBuffers.begin()+i+downBuffers[i]->LNG);
-					if(tempPacket->LNG > 1)	tempPacket->LNG = 1 + ADDRESS_MAPPING/16;	//one flit is 16 bytes
-					for(int j=0; j<segPacket; j++) {
-						Packet *vaultPacket = new Packet(*tempPacket);
-						vaultPacket->ADRS += j*ADDRESS_MAPPING;
-						if(j>0)	vaultPacket->trace = NULL;
-						downBuffers.insert(downBuffers.begin()+i, vaultPacket);
-						for(int k=1; k<vaultPacket->LNG; k++) {		//Virtual tail packet
-							downBuffers.insert(downBuffers.begin()+i+1, NULL);
+	if(CROSSBAR_MODEL == VOQ) {
+		UpdateVOQ();
+	}
+	else if(bufPopDelay == 0) {
+		if(downBuffers.size() > 0)	epochCrossStat.busyCycles++;
+		//Packets of higher QoS classes are switched first
+		vector<int> switchedClass = vector<int>(NUM_VAULTS, -1);
+		for(int q=QOS_TOP_CLASS; q>=0; q--) {
+			for(int i=0; i<downBuffers.size(); i++) {
+				if(downBuffers[i] != NULL) {
+					if(QOS_CLASS(downBuffers[i]) != q)	continue;
+					if(QOS_CLASSES > 1 && BlockDependency(i))	continue;
+					//Check request size and the maximum block size
+					if(downBuffers[i]->reqDataSize > ADDRESS_MAPPING) {
+						//the packet is divided into segment packets.
+						Packet *tempPacket = downBuffers[i];
+						downBuffers.erase(downBuffers.begin()+i, downBuffers.begin()+i+downBuffers[i]->LNG());
+						vector<Packet *> segPackets;
+						DivideSegment(tempPacket, segPackets);
+						for(int j=0; j<segPackets.size(); j++) {
+							downBuffers.insert(downBuffers.begin()+i, segPackets[j]);
+							for(int k=1; k<segPackets[j]->LNG(); k++) {		//Virtual tail packet
+								downBuffers.insert(downBuffers.begin()+i+1, NULL);
+							}
+							i += segPackets[j]->LNG();
 						}
-						i += vaultPacket->LNG;
-						vaultPacket->segment = true;
-						pendingSegTag.push_back(vaultPacket->TAG);
-					}
-					delete tempPacket;
-				}
-				else {
-					unsigned vaultMap = (downBuffers[i]->ADRS >> _log2(ADDRESS_MAPPING)) & (NUM_VAULTS-1);
-					if(downBufferDest[vaultMap]->ReceiveDown(downBuffers[i])) {
-						DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[i]<<"Down) SENDING packet to vault controller "<<vaultMap<<" (VC_"<<vaultMap<<")");
-						downBuffers.erase(downBuffers.begin()+i, downBuffers.begin()+i+downBuffers[i]->LNG);
-						i--;
 					}
 					else {
-						//DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[i]<<"Down) Vault controller buffer FULL");	
+						unsigned vaultMap = addressMap->Vault(downBuffers[i]->ADRS());
+						if(downBufferDest[vaultMap]->ReceiveDown(downBuffers[i])) {
+							if(downBuffers[i]->trace != NULL) {
+								downBuffers[i]->trace->StampHMC(STAGE_VAULT_BUF, currentClockCycle);
+							}
+							DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[i]<<"Down) SENDING packet to vault controller "<<vaultMap<<" (VC_"<<vaultMap<<")");
+							switchedClass[vaultMap] = max(switchedClass[vaultMap], q);
+							downBuffers.erase(downBuffers.begin()+i, downBuffers.begin()+i+downBuffers[i]->LNG());
+							epochCrossStat.switched++;
+							i--;
+						}
+						else {
+							epochCrossStat.outputBlock++;
+							//The vault controller buffer is taken by a packet of higher class (starvation guard)
+							if(switchedClass[vaultMap] > q)	downBuffers[i]->bypassed++;
+							//DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[i]<<"Down) Vault controller buffer FULL");	
+						}
 					}
 				}
 			}
@@ -112,12 +269,12 @@ void CrossbarSwitch::Update()
 				bool foundSeg = false;
 				bool foundLastSeg = true;
 				for(int j=0; j<pendingSegTag.size(); j++) {
-					if(upBuffers[i]->TAG == pendingSegTag[j]) {
+					if(upBuffers[i]->TAG() == pendingSegTag[j]) {
 						pendingSegTag.erase(pendingSegTag.begin()+j);
 						foundSeg = true;
 						//Check whether upBuffers[i] packet is the last segment packet or not 
 						for(int k=j; k<pendingSegTag.size(); k++) {
-							if(upBuffers[i]->TAG == pendingSegTag[k]) {
+							if(upBuffers[i]->TAG() == pendingSegTag[k]) {
 								DEBUG(ALI(18)<<header<<ALI(15)<<*upBuffers[i]<<"Up)   Segment packet is WAITING for the others");
 								foundLastSeg = false;
 								break;
@@ -137,14 +294,14 @@ void CrossbarSwitch::Update()
 				//Segment packets are combined together
 				foundSeg = false;
 				for(int j=0; j<pendingSegPacket.size(); j++) {
-					if(upBuffers[i]->TAG == pendingSegPacket[j]->TAG) {
-						if(upBuffers[i]->LNG > 1)	pendingSegPacket[j]->LNG += ADDRESS_MAPPING/16;
+					if(upBuffers[i]->TAG() == pendingSegPacket[j]->TAG()) {
+						if(upBuffers[i]->LNG() > 1)	pendingSegPacket[j]->SetLNG(pendingSegPacket[j]->LNG() + ADDRESS_MAPPING/16);
 						if(upBuffers[i]->trace != NULL) { //It is the first segment packet
 							pendingSegPacket[j]->trace = upBuffers[i]->trace;
-							pendingSegPacket[j]->ADRS = upBuffers[i]->ADRS;
+							pendingSegPacket[j]->SetADRS(upBuffers[i]->ADRS());
 						}
 						//Delete a segment packet
-						int packetLNG = upBuffers[i]->LNG;
+						int packetLNG = upBuffers[i]->LNG();
 						delete upBuffers[i];
 						upBuffers.erase(upBuffers.begin()+i, upBuffers.begin()+i+packetLNG);
 						foundSeg = true;
@@ -155,7 +312,7 @@ void CrossbarSwitch::Update()
 							pendingSegPacket.erase(pendingSegPacket.begin()+j);
 							combPacket->segment = false;
 							upBuffers.insert(upBuffers.begin(), combPacket);
-							for(int k=1; k<combPacket->LNG; k++) {	//Virtual tail packet
+							for(int k=1; k<combPacket->LNG(); k++) {	//Virtual tail packet
 								upBuffers.insert(upBuffers.begin()+1, NULL);
 							}
 						}
@@ -168,13 +325,14 @@ void CrossbarSwitch::Update()
 				//Thr first arrived segment packet
 				if(!foundSeg) {
 					pendingSegPacket.push_back(upBuffers[i]);
-					upBuffers.erase(upBuffers.begin()+i, upBuffers.begin()+i+upBuffers[i]->LNG);
+					upBuffers.erase(upBuffers.begin()+i, upBuffers.begin()+i+upBuffers[i]->LNG());
 					i--;
 				}
 			}
 			else {
+				int vault = addressMap->Vault(upBuffers[i]->ADRS());
 				for(int l=0; l<NUM_LINKS; l++) {
-					int link = FindAvailableLink(inServiceLink, upBufferDest);
+					int link = FindAvailableLink(inServiceLink, upBufferDest, vault);
 					if(link == -1) {
 						//DEBUG(ALI(18)<<header<<ALI(15)<<*upBuffers[i]<<"Up)   all packet buffer FULL");
 					}
@@ -186,7 +344,7 @@ void CrossbarSwitch::Update()
 					else {
 						if(upBufferDest[link]->Receive(upBuffers[i])) {
 							DEBUG(ALI(18)<<header<<ALI(15)<<*upBuffers[i]<<"Up)   SENDING packet to link master "<<link<<" (LM_U"<<link<<")");
-							upBuffers.erase(upBuffers.begin()+i, upBuffers.begin()+i+upBuffers[i]->LNG);
+							upBuffers.erase(upBuffers.begin()+i, upBuffers.begin()+i+upBuffers[i]->LNG());
 							i--;
 							break;
 						}
@@ -202,6 +360,143 @@ void CrossbarSwitch::Update()
 	Step();
 }
 
+//
+//Virtual output queued switching (one packet per input link and per vault in a cycle)
+//
+void CrossbarSwitch::UpdateVOQ()
+{
+	//Head packet of each VOQ requests its vault controller
+	bool busy = false;
+	for(int l=0; l<NUM_LINKS; l++) {
+		if(voqFlits[l] == 0)	continue;
+		busy = true;
+		for(int v=0; v<NUM_VAULTS; v++) {
+			voqRequest[l][v] = false;
+			if(QOS_CLASSES > 1 && voq[l][v].size() > 1) {
+				PromoteVOQ(voq[l][v]);
+			}
+			if(voq[l][v].size() > 0) {
+				if(VaultReady(v, voq[l][v][0])) {
+					voqRequest[l][v] = true;
+				}
+				else {
+					epochCrossStat.outputBlock++;
+				}
+			}
+		}
+	}
+	
+	if(busy) {
+		epochCrossStat.busyCycles++;
+		vector<int> inMatch = vector<int>(NUM_LINKS, -1);
+		vector<int> outMatch = vector<int>(NUM_VAULTS, -1);
+		if(CROSSBAR_ALLOC == ISLIP) {
+			AllocISLIP(inMatch, outMatch);
+		}
+		else {
+			AllocWavefront(inMatch, outMatch);
+		}
+		
+		for(int l=0; l<NUM_LINKS; l++) {
+			if(voqFlits[l] == 0)	continue;
+			for(int v=0; v<NUM_VAULTS; v++) {
+				if(voqRequest[l][v] && inMatch[l] != v) {
+					epochCrossStat.arbLoss++;
+				}
+			}
+			if(inMatch[l] != -1) {
+				int v = inMatch[l];
+				Packet *packet = voq[l][v][0];
+				if(downBufferDest[v]->ReceiveDown(packet)) {
+					if(packet->trace != NULL) {
+						packet->trace->StampHMC(STAGE_VAULT_BUF, currentClockCycle);
+					}
+					DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) SENDING packet from VOQ "<<l<<" to vault controller "<<v<<" (VC_"<<v<<")");
+					voqFlits[l] -= packet->LNG();
+					voq[l][v].erase(voq[l][v].begin());
+					epochCrossStat.switched++;
+				}
+			}
+		}
+	}
+	
+	//Received packets are divided by max block size and distributed to VOQs
+	for(int i=0; i<voqIngress.size(); i++) {
+		Packet *packet = voqIngress[i];
+		unsigned link = packet->SLID();
+		if(packet->reqDataSize > ADDRESS_MAPPING) {
+			vector<Packet *> segPackets;
+			DivideSegment(packet, segPackets);
+			for(int j=0; j<segPackets.size(); j++) {
+				voq[link][addressMap->Vault(segPackets[j]->ADRS())].push_back(segPackets[j]);
+			}
+		}
+		else {
+			voq[link][addressMap->Vault(packet->ADRS())].push_back(packet);
+		}
+	}
+	voqIngress.clear();
+}
+
+//
+//iSLIP allocator (grant and accept pointers are updated only in the first iteration)
+//
+void CrossbarSwitch::AllocISLIP(vector<int> &inMatch, vector<int> &outMatch)
+{
+	vector<int> grant = vector<int>(NUM_VAULTS, -1);
+	for(int iter=0; iter<CROSSBAR_ITER; iter++) {
+		//Grant : each unmatched vault grants one of the requesting unmatched links
+		for(int v=0; v<NUM_VAULTS; v++) {
+			grant[v] = -1;
+			if(outMatch[v] != -1)	continue;
+			for(int k=0; k<NUM_LINKS; k++) {
+				int l = (grantPointer[v] + k) % NUM_LINKS;
+				if(inMatch[l] == -1 && voqRequest[l][v]) {
+					grant[v] = l;
+					break;
+				}
+			}
+		}
+		//Accept : each unmatched link accepts one of the granting vaults
+		bool newMatch = false;
+		for(int l=0; l<NUM_LINKS; l++) {
+			if(inMatch[l] != -1)	continue;
+			for(int k=0; k<NUM_VAULTS; k++) {
+				int v = (acceptPointer[l] + k) % NUM_VAULTS;
+				if(grant[v] == l) {
+					inMatch[l] = v;
+					outMatch[v] = l;
+					newMatch = true;
+					if(iter == 0) {
+						grantPointer[v] = (l + 1) % NUM_LINKS;
+						acceptPointer[l] = (v + 1) % NUM_VAULTS;
+					}
+					break;
+				}
+			}
+		}
+		if(!newMatch)	break;
+	}
+}
+
+//
+//Wavefront allocator (cells of one diagonal do not share any link or vault, and the first diagonal rotates every cycle)
+//
+void CrossbarSwitch::AllocWavefront(vector<int> &inMatch, vector<int> &outMatch)
+{
+	int size = max(NUM_LINKS, NUM_VAULTS);
+	for(int d=0; d<size; d++) {
+		for(int l=0; l<NUM_LINKS; l++) {
+			int v = (l + wavefrontPriority + d) % size;
+			if(v < NUM_VAULTS && inMatch[l] == -1 && outMatch[v] == -1 && voqRequest[l][v]) {
+				inMatch[l] = v;
+				outMatch[v] = l;
+			}
+		}
+	}
+	wavefrontPriority = (wavefrontPriority + 1) % size;
+}
+
 //
 //Print current state in state log file
 //
@@ -230,6 +525,23 @@ void CrossbarSwitch::PrintState()
 		STATEN(endl);
 	}
 	
+	for(int l=0; l<voq.size(); l++) {
+		if(voqFlits[l] == 0)	continue;
+		STATEN(ALI(17)<<header);
+		STATEN("VOQ"<<l<<" ");
+		int printed = 0;
+		for(int v=0; v<NUM_VAULTS; v++) {
+			for(int i=0; i<voq[l][v].size(); i++) {
+				if(printed>0 && printed%8==0) {
+					STATEN(endl<<"                      ");
+				}
+				STATEN(*voq[l][v][i]);
+				printed++;
+			}
+		}
+		STATEN(endl);
+	}
+	
 	if(upBuffers.size()>0) {
 		STATEN(ALI(17)<<header);
 		STATEN(" Up  ");
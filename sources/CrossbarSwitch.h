@@ -14,16 +14,43 @@
 
 //CrossbarSwitch.h
 
+#include <stdint.h>		//uint64_t
 #include <vector>		//vector
 
 #include "DualVectorObject.h"
 #include "ConfigValue.h"
 #include "LinkMaster.h"
+#include "AddressMap.h"
+#include "TagPool.h"
+#include "LinkPipe.h"
 
 using namespace std;
 
 namespace CasHMC
 {
+
+//Crossbar switch statistics
+class CrossbarStat
+{
+public:
+	CrossbarStat():switched(0), busyCycles(0), outputBlock(0), arbLoss(0), inputBlock(0), holBlock(0) {}
+	CrossbarStat &operator+=(const CrossbarStat &c) {
+		switched += c.switched;
+		busyCycles += c.busyCycles;
+		outputBlock += c.outputBlock;
+		arbLoss += c.arbLoss;
+		inputBlock += c.inputBlock;
+		holBlock += c.holBlock;
+		return *this;
+	}
+
+	uint64_t switched;		//Packets switched to vault controllers
+	uint64_t busyCycles;	//Cycles that any downstream packet is waiting in crossbar switch
+	uint64_t outputBlock;	//Waiting packets whose vault controller buffer is full (counted every cycle)
+	uint64_t arbLoss;		//VOQ head packets that lost the allocation (counted every cycle)
+	uint64_t inputBlock;	//Link slave packets refused by crossbar switch input buffer (counted every cycle)
+	uint64_t holBlock;		//Refused packets whose vault controller buffer has space (head-of-line blocking)
+};
 	
 class CrossbarSwitch : public DualVectorObject<Packet, Packet>
 {
@@ -35,7 +62,15 @@ public:
 	virtual ~CrossbarSwitch();
 	void CallbackReceiveDown(Packet *downEle, bool chkReceive);
 	void CallbackReceiveUp(Packet *upEle, bool chkReceive);
+	bool ReceiveDown(Packet *downEle);
+	bool VaultReady(unsigned vault, Packet *packet);
+	void DivideSegment(Packet *packet, vector<Packet *> &segPackets);
+	bool BlockDependency(int index);
+	void PromoteVOQ(vector<Packet *> &queue);
 	void Update();
+	void UpdateVOQ();
+	void AllocISLIP(vector<int> &inMatch, vector<int> &outMatch);
+	void AllocWavefront(vector<int> &inMatch, vector<int> &outMatch);
 	void PrintState();
 
 	//
@@ -43,9 +78,24 @@ public:
 	//
 	vector<DualVectorObject<Packet, Packet> *> downBufferDest;
 	vector<LinkMaster *> upBufferDest;
+	AddressMap *addressMap;				//Shared with vault controllers
+	TagPool *tagPool;					//Tag pool of HMC controller (posted segment packets)
+	LinkPipe *upPipe;					//Tag updates are handed to the host thread (PIPELINE_SIM)
 	int inServiceLink;
 	vector<unsigned> pendingSegTag;		//Store segment packet tag for returning
 	vector<Packet *> pendingSegPacket;	//Store segment packets
+	
+	//Virtual output queue (CROSSBAR_MODEL = VOQ)
+	vector<vector<vector<Packet *> > > voq;	//[input link][vault] Packets waiting for the vault controller
+	vector<vector<bool> > voqRequest;		//[input link][vault] VOQ head packet is ready to be switched
+	vector<Packet *> voqIngress;			//Packets received in this cycle (distributed to VOQs at the end of the cycle)
+	vector<unsigned> voqFlits;				//Occupied input buffer of each link (including ingress packets)
+	vector<unsigned> grantPointer;			//iSLIP grant pointer of each vault
+	vector<unsigned> acceptPointer;			//iSLIP accept pointer of each input link
+	unsigned wavefrontPriority;				//The first diagonal of wavefront allocator
+	
+	CrossbarStat epochCrossStat;
+	CrossbarStat totalCrossStat;
 };
 
 }
@@ -26,11 +26,8 @@ DRAM::DRAM(ofstream &debugOut_, ofstream &stateOut_, unsigned id, VaultControlle
 	readData = NULL;
 	dataCyclesLeft = 0;
 
-	bankStates.reserve(NUM_BANKS);
-	for(int b=0; b<NUM_BANKS; b++) {
-		bankStates.push_back(new BankState(b));
-	}
 	previousBankState = vector<BankStateType>(NUM_BANKS, IDLE);
+	columnAccess = vector<uint64_t>(NUM_BANKS, 0);
 }
 
 DRAM::~DRAM()
@@ -40,11 +37,6 @@ DRAM::~DRAM()
 	}
 	readReturnDATA.clear();
 	readReturnCountdown.clear();
-	
-	for(int b=0; b<NUM_BANKS; b++) {
-		delete bankStates[b];
-	}
-	bankStates.clear();
 }
 
 //
@@ -54,97 +46,117 @@ void DRAM::receiveCMD(DRAMCommand *recvCMD)
 {
 	switch(recvCMD->commandType) {
 		case ACTIVATE:
-			bankStates[recvCMD->bank]->currentBankState = ROW_ACTIVE;
-			bankStates[recvCMD->bank]->lastCommand = ACTIVATE;
-			bankStates[recvCMD->bank]->openRowAddress = recvCMD->row;
-			bankStates[recvCMD->bank]->nextActivate = max(currentClockCycle + tRC, bankStates[recvCMD->bank]->nextActivate);
-			bankStates[recvCMD->bank]->nextPrecharge = max(currentClockCycle + tRAS, bankStates[recvCMD->bank]->nextPrecharge);
-			bankStates[recvCMD->bank]->nextRead = max(currentClockCycle + (tRCD-AL), bankStates[recvCMD->bank]->nextRead);
-			bankStates[recvCMD->bank]->nextWrite = max(currentClockCycle + (tRCD-AL), bankStates[recvCMD->bank]->nextWrite);
+			epochEnergyStat.activates++;
+			bankStates.currentBankState[recvCMD->bank] = ROW_ACTIVE;
+			bankStates.lastCommand[recvCMD->bank] = ACTIVATE;
+			bankStates.openRowAddress[recvCMD->bank] = recvCMD->row;
+			bankStates.nextActivate[recvCMD->bank] = max(currentClockCycle + tRC, bankStates.nextActivate[recvCMD->bank]);
+			bankStates.nextPrecharge[recvCMD->bank] = max(currentClockCycle + tRAS, bankStates.nextPrecharge[recvCMD->bank]);
+			bankStates.nextRead[recvCMD->bank] = max(currentClockCycle + (tRCD-AL), bankStates.nextRead[recvCMD->bank]);
+			bankStates.nextWrite[recvCMD->bank] = max(currentClockCycle + (tRCD-AL), bankStates.nextWrite[recvCMD->bank]);
 			for(int b=0; b<NUM_BANKS; b++) {
 				if(recvCMD->bank != b) {
-					bankStates[b]->nextActivate = max(currentClockCycle + tRRD, bankStates[b]->nextActivate);
+					bankStates.nextActivate[b] = max(currentClockCycle + tRRD, bankStates.nextActivate[b]);
 				}
 			}
-			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      next READ or WRITE time : "<<bankStates[recvCMD->bank]->nextRead<<" [HMC clk]");
+			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      next READ or WRITE time : "<<bankStates.nextRead[recvCMD->bank]<<" [HMC clk]");
 			delete recvCMD;
 			break;
 		case READ:
-			bankStates[recvCMD->bank]->nextPrecharge = max(currentClockCycle + READ_TO_PRE_DELAY, bankStates[recvCMD->bank]->nextPrecharge);
-			bankStates[recvCMD->bank]->lastCommand = READ;
+			epochEnergyStat.reads++;
+			columnAccess[recvCMD->bank]++;
+			bankStates.nextPrecharge[recvCMD->bank] = max(currentClockCycle + READ_TO_PRE_DELAY, bankStates.nextPrecharge[recvCMD->bank]);
+			bankStates.lastCommand[recvCMD->bank] = READ;
 			for(int b=0; b<NUM_BANKS; b++) {
-				bankStates[b]->nextRead = max(currentClockCycle + max(tCCD, BL), bankStates[b]->nextRead);
-				bankStates[b]->nextWrite = max(currentClockCycle + READ_TO_WRITE_DELAY, bankStates[b]->nextWrite);
+				bankStates.nextRead[b] = max(currentClockCycle + max(tCCD, BL), bankStates.nextRead[b]);
+				bankStates.nextWrite[b] = max(currentClockCycle + READ_TO_WRITE_DELAY, bankStates.nextWrite[b]);
 			}
 			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      READ DATA return time : "<<currentClockCycle+RL+BL<<" [HMC clk]"
-													<<" / next PRECHARGE time : "<<bankStates[recvCMD->bank]->nextPrecharge<<" [HMC clk]");
+													<<" / next PRECHARGE time : "<<bankStates.nextPrecharge[recvCMD->bank]<<" [HMC clk]");
 			recvCMD->commandType = READ_DATA;
 			readReturnDATA.push_back(recvCMD);
 			readReturnCountdown.push_back(RL);
 			break;
 		case READ_P:
-			bankStates[recvCMD->bank]->nextActivate = max(currentClockCycle + READ_AUTOPRE_DELAY, bankStates[recvCMD->bank]->nextActivate);
-			bankStates[recvCMD->bank]->lastCommand = READ_P;
-			bankStates[recvCMD->bank]->stateChangeCountdown = READ_TO_PRE_DELAY;
+			epochEnergyStat.reads++;
+			columnAccess[recvCMD->bank]++;
+			bankStates.nextActivate[recvCMD->bank] = max(currentClockCycle + READ_AUTOPRE_DELAY, bankStates.nextActivate[recvCMD->bank]);
+			bankStates.lastCommand[recvCMD->bank] = READ_P;
+			bankStates.stateChangeCountdown[recvCMD->bank] = READ_TO_PRE_DELAY;
 			for(int b=0; b<NUM_BANKS; b++) {
-				bankStates[b]->nextRead = max(currentClockCycle + max(tCCD, BL), bankStates[b]->nextRead);
-				bankStates[b]->nextWrite = max(currentClockCycle + READ_TO_WRITE_DELAY, bankStates[b]->nextWrite);
+				bankStates.nextRead[b] = max(currentClockCycle + max(tCCD, BL), bankStates.nextRead[b]);
+				bankStates.nextWrite[b] = max(currentClockCycle + READ_TO_WRITE_DELAY, bankStates.nextWrite[b]);
 			}
 			if(recvCMD->commandType == READ_P) {
-				bankStates[recvCMD->bank]->nextRead = bankStates[recvCMD->bank]->nextActivate;
-				bankStates[recvCMD->bank]->nextWrite = bankStates[recvCMD->bank]->nextActivate;
+				bankStates.nextRead[recvCMD->bank] = bankStates.nextActivate[recvCMD->bank];
+				bankStates.nextWrite[recvCMD->bank] = bankStates.nextActivate[recvCMD->bank];
 			}	
 			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      READ DATA return time : "<<currentClockCycle+RL+BL<<" [HMC clk]"
-													<<" / next ACTIVATE time : "<<bankStates[recvCMD->bank]->nextActivate<<" [HMC clk]");
+													<<" / next ACTIVATE time : "<<bankStates.nextActivate[recvCMD->bank]<<" [HMC clk]");
 			recvCMD->commandType = READ_DATA;
 			readReturnDATA.push_back(recvCMD);
 			readReturnCountdown.push_back(RL);
 			break;
 		case WRITE:
-			bankStates[recvCMD->bank]->nextPrecharge = max(currentClockCycle + WRITE_TO_PRE_DELAY, bankStates[recvCMD->bank]->nextPrecharge);
-			bankStates[recvCMD->bank]->lastCommand = WRITE;
+			epochEnergyStat.writes++;
+			columnAccess[recvCMD->bank]++;
+			bankStates.nextPrecharge[recvCMD->bank] = max(currentClockCycle + WRITE_TO_PRE_DELAY, bankStates.nextPrecharge[recvCMD->bank]);
+			bankStates.lastCommand[recvCMD->bank] = WRITE;
 			for(int b=0; b<NUM_BANKS; b++) {
-				bankStates[b]->nextWrite = max(currentClockCycle + max(BL, tCCD), bankStates[b]->nextWrite);
-				bankStates[b]->nextRead = max(currentClockCycle + WRITE_TO_READ_DELAY_B, bankStates[b]->nextRead);
+				bankStates.nextWrite[b] = max(currentClockCycle + max(BL, tCCD), bankStates.nextWrite[b]);
+				bankStates.nextRead[b] = max(currentClockCycle + WRITE_TO_READ_DELAY_B, bankStates.nextRead[b]);
 			}
 			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      WRTIE DATA time : "<<currentClockCycle+WL+BL<<" [HMC clk]"
-													<<" / next PRECHARGE time : "<<bankStates[recvCMD->bank]->nextPrecharge<<" [HMC clk]");
+													<<" / next PRECHARGE time : "<<bankStates.nextPrecharge[recvCMD->bank]<<" [HMC clk]");
 			delete recvCMD;
 			break;
 		case WRITE_P:
-			bankStates[recvCMD->bank]->nextActivate = max(currentClockCycle + WRITE_AUTOPRE_DELAY, bankStates[recvCMD->bank]->nextActivate);
-			bankStates[recvCMD->bank]->lastCommand = WRITE_P;
-			bankStates[recvCMD->bank]->stateChangeCountdown = WRITE_TO_PRE_DELAY;
+			epochEnergyStat.writes++;
+			columnAccess[recvCMD->bank]++;
+			bankStates.nextActivate[recvCMD->bank] = max(currentClockCycle + WRITE_AUTOPRE_DELAY, bankStates.nextActivate[recvCMD->bank]);
+			bankStates.lastCommand[recvCMD->bank] = WRITE_P;
+			bankStates.stateChangeCountdown[recvCMD->bank] = WRITE_TO_PRE_DELAY;
 			for(int b=0; b<NUM_BANKS; b++) {
-				bankStates[b]->nextWrite = max(currentClockCycle + max(BL, tCCD), bankStates[b]->nextWrite);
-				bankStates[b]->nextRead = max(currentClockCycle + WRITE_TO_READ_DELAY_B, bankStates[b]->nextRead);
+				bankStates.nextWrite[b] = max(currentClockCycle + max(BL, tCCD), bankStates.nextWrite[b]);
+				bankStates.nextRead[b] = max(currentClockCycle + WRITE_TO_READ_DELAY_B, bankStates.nextRead[b]);
 			}
-			bankStates[recvCMD->bank]->nextRead = bankStates[recvCMD->bank]->nextActivate;
-			bankStates[recvCMD->bank]->nextWrite = bankStates[recvCMD->bank]->nextActivate;
+			bankStates.nextRead[recvCMD->bank] = bankStates.nextActivate[recvCMD->bank];
+			bankStates.nextWrite[recvCMD->bank] = bankStates.nextActivate[recvCMD->bank];
 			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      WRTIE DATA time : "<<currentClockCycle+WL+BL<<" [HMC clk]"
-													<<" / next ACTIVATE time : "<<bankStates[recvCMD->bank]->nextActivate<<" [HMC clk]");
+													<<" / next ACTIVATE time : "<<bankStates.nextActivate[recvCMD->bank]<<" [HMC clk]");
 			delete recvCMD; 
 			break;
 		case WRITE_DATA:
 			delete recvCMD;
 			break;
 		case PRECHARGE:
-			bankStates[recvCMD->bank]->currentBankState = PRECHARGING;
-			bankStates[recvCMD->bank]->lastCommand = PRECHARGE;
-			bankStates[recvCMD->bank]->openRowAddress = 0;
-			bankStates[recvCMD->bank]->stateChangeCountdown = tRP;
-			bankStates[recvCMD->bank]->nextActivate = max(currentClockCycle + tRP, bankStates[recvCMD->bank]->nextActivate);
-			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      next ACTIVATE time : "<<bankStates[recvCMD->bank]->nextActivate<<" [HMC clk]");
+			bankStates.currentBankState[recvCMD->bank] = PRECHARGING;
+			bankStates.lastCommand[recvCMD->bank] = PRECHARGE;
+			bankStates.openRowAddress[recvCMD->bank] = 0;
+			bankStates.stateChangeCountdown[recvCMD->bank] = tRP;
+			bankStates.nextActivate[recvCMD->bank] = max(currentClockCycle + tRP, bankStates.nextActivate[recvCMD->bank]);
+			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      next ACTIVATE time : "<<bankStates.nextActivate[recvCMD->bank]<<" [HMC clk]");
 			delete recvCMD;
 			break;	
 		case REFRESH:
-			for(int b=0; b<NUM_BANKS; b++) {
-				bankStates[b]->nextActivate = currentClockCycle + tRFC;
-				bankStates[b]->currentBankState = REFRESHING;
-				bankStates[b]->lastCommand = REFRESH;
-				bankStates[b]->stateChangeCountdown = tRFC;
+			//Per-bank refresh closes only the target bank
+			if(REFRESH_POLICY == PER_BANK) {
+				epochEnergyStat.bankRefreshes++;
+				bankStates.nextActivate[recvCMD->bank] = currentClockCycle + tRFCpb;
+				bankStates.currentBankState[recvCMD->bank] = REFRESHING;
+				bankStates.lastCommand[recvCMD->bank] = REFRESH;
+				bankStates.stateChangeCountdown[recvCMD->bank] = tRFCpb;
+			}
+			else {
+				epochEnergyStat.refreshes++;
+				for(int b=0; b<NUM_BANKS; b++) {
+					bankStates.nextActivate[b] = currentClockCycle + tRFC;
+					bankStates.currentBankState[b] = REFRESHING;
+					bankStates.lastCommand[b] = REFRESH;
+					bankStates.stateChangeCountdown[b] = tRFC;
+				}
 			}
-			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      next ACTIVATE time : "<<bankStates[recvCMD->bank]->nextActivate<<" [HMC clk]");
+			DEBUG(ALI(18)<<header<<ALI(15)<<*recvCMD<<"      next ACTIVATE time : "<<bankStates.nextActivate[recvCMD->bank]<<" [HMC clk]");
 			delete recvCMD;
 			break;
 		default:
@@ -162,15 +174,15 @@ bool DRAM::powerDown()
 	//check to make sure all banks are idle
 	bool allIdle = true;
 	for(int b=0; b<NUM_BANKS; b++) {
-		if(bankStates[b]->currentBankState != IDLE) {
+		if(bankStates.currentBankState[b] != IDLE) {
 			allIdle = false;
 			break;
 		}
 	}
 	if(allIdle) {
 		for(int b=0; b<NUM_BANKS; b++) {
-			bankStates[b]->currentBankState = POWERDOWN;
-			bankStates[b]->nextPowerUp = currentClockCycle + tCKE;
+			bankStates.currentBankState[b] = POWERDOWN;
+			bankStates.nextPowerUp[b] = currentClockCycle + tCKE;
 		}
 		return true;
 	}
@@ -185,12 +197,12 @@ bool DRAM::powerDown()
 void DRAM::powerUp()
 {
 	for(int b=0; b<NUM_BANKS; b++) {
-		bankStates[b]->lastCommand = POWERDOWN_EXIT;
-		bankStates[b]->currentBankState = AWAKING;
-		bankStates[b]->stateChangeCountdown = tXP;
-		bankStates[b]->nextActivate = currentClockCycle + tXP;
+		bankStates.lastCommand[b] = POWERDOWN_EXIT;
+		bankStates.currentBankState[b] = AWAKING;
+		bankStates.stateChangeCountdown[b] = tXP;
+		bankStates.nextActivate[b] = currentClockCycle + tXP;
 	}
-	DEBUG(ALI(39)<<header<<"AWAKE DRAM power down mode   nextActivate time : "<<bankStates[0]->nextActivate);
+	DEBUG(ALI(39)<<header<<"AWAKE DRAM power down mode   nextActivate time : "<<bankStates.nextActivate[0]);
 }
 
 //
@@ -198,33 +210,32 @@ void DRAM::powerUp()
 //
 void DRAM::Update()
 {
-	//update bank states
-	for(int b=0; b<NUM_BANKS; b++) {
-		if(bankStates[b]->stateChangeCountdown>0) {
-			//decrement counters
-			bankStates[b]->stateChangeCountdown--;
-
-			//if counter has reached 0, change state
-			if(bankStates[b]->stateChangeCountdown == 0) {
-				switch(bankStates[b]->lastCommand) {
-					//only these commands have an implicit state change
-					case WRITE_P:
-					case READ_P:
-						bankStates[b]->currentBankState = PRECHARGING;
-						bankStates[b]->lastCommand = PRECHARGE;
-						bankStates[b]->stateChangeCountdown = tRP;
-						break;
-					case REFRESH:
-					case PRECHARGE:
-					case POWERDOWN_EXIT:
-						bankStates[b]->currentBankState = IDLE;
-						break;
-					default:
-						break;
-				}
-			}
+	//update bank states (only the banks whose countdown reaches 0 change state)
+	uint64_t expired = bankStates.Countdown();
+	while(expired != 0) {
+		unsigned b = __builtin_ctzll(expired);
+		expired &= expired - 1;
+		switch(bankStates.lastCommand[b]) {
+			//only these commands have an implicit state change
+			case WRITE_P:
+			case READ_P:
+				bankStates.currentBankState[b] = PRECHARGING;
+				bankStates.lastCommand[b] = PRECHARGE;
+				bankStates.stateChangeCountdown[b] = tRP;
+				break;
+			case REFRESH:
+			case PRECHARGE:
+			case POWERDOWN_EXIT:
+				bankStates.currentBankState[b] = IDLE;
+				break;
+			default:
+				break;
 		}
 	}
+	//Background energy is accounted by the bank state of every cycle
+	for(int b=0; b<NUM_BANKS; b++) {
+		epochEnergyStat.stateCycles[bankStates.currentBankState[b]]++;
+	}
 	
 	UpdateState();
 	Step();
@@ -263,7 +274,7 @@ void DRAM::PrintState()
 {
 	bool printDR = false;
 	for(int b=0; b<NUM_BANKS; b++) {
-		if(previousBankState[b] != bankStates[b]->currentBankState) {
+		if(previousBankState[b] != bankStates.currentBankState[b]) {
 			printDR = true;
 			break;
 		}
@@ -273,11 +284,11 @@ void DRAM::PrintState()
 		STATEN(ALI(17)<<header);
 		STATEN("State");
 		for(int b=0; b<NUM_BANKS; b++) {
-			previousBankState[b] = bankStates[b]->currentBankState;
+			previousBankState[b] = bankStates.currentBankState[b];
 			STATEN("[");
-			STATEN(*bankStates[b]);
-			if(bankStates[b]->currentBankState == ROW_ACTIVE) {
-				STATEN("-"<<bankStates[b]->openRowAddress);
+			STATEN(BankStateName(bankStates.currentBankState[b]));
+			if(bankStates.currentBankState[b] == ROW_ACTIVE) {
+				STATEN("-"<<bankStates.openRowAddress[b]);
 			}
 			STATEN("]");
 		}
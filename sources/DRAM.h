@@ -26,6 +26,53 @@ using namespace std;
 
 namespace CasHMC
 {
+//DRAM energy statistic of one vault (IDD-based command energy and bank-state background energy)
+class EnergyStat
+{
+public:
+	EnergyStat():activates(0), reads(0), writes(0), refreshes(0), bankRefreshes(0) {
+		for(int s=0; s<NUM_BANK_STATES; s++)	stateCycles[s] = 0;
+	}
+	EnergyStat &operator+=(const EnergyStat &e) {
+		activates += e.activates;
+		reads += e.reads;
+		writes += e.writes;
+		refreshes += e.refreshes;
+		bankRefreshes += e.bankRefreshes;
+		for(int s=0; s<NUM_BANK_STATES; s++)	stateCycles[s] += e.stateCycles[s];
+		return *this;
+	}
+	//[pJ] (mA x V x ns)
+	double ActEnergy() const {
+		return activates*(IDD0*tRC - (IDD3N*tRAS + IDD2N*(tRC-tRAS)))*VDD*tCK;
+	}
+	double ReadEnergy() const {
+		return reads*(IDD4R-IDD3N)*BL*VDD*tCK;
+	}
+	double WriteEnergy() const {
+		return writes*(IDD4W-IDD3N)*BL*VDD*tCK;
+	}
+	double RefreshEnergy() const {
+		return (refreshes*tRFC + (double)bankRefreshes*tRFCpb/NUM_BANKS)*(IDD5B-IDD3N)*VDD*tCK;
+	}
+	//Standby currents are drawn by the whole vault, so each bank takes 1/NUM_BANKS of them
+	double BackgroundEnergy() const {
+		double activeCycles = stateCycles[ROW_ACTIVE] + stateCycles[REFRESHING];
+		double standbyCycles = stateCycles[IDLE] + stateCycles[PRECHARGING] + stateCycles[AWAKING];
+		return (activeCycles*IDD3N + standbyCycles*IDD2N + stateCycles[POWERDOWN]*IDD2P)*VDD*tCK/NUM_BANKS;
+	}
+	double TotalEnergy() const {
+		return ActEnergy() + ReadEnergy() + WriteEnergy() + RefreshEnergy() + BackgroundEnergy();
+	}
+
+	uint64_t activates;
+	uint64_t reads;			//READ and READ_P
+	uint64_t writes;		//WRITE and WRITE_P
+	uint64_t refreshes;		//All-bank REFRESH
+	uint64_t bankRefreshes;	//Per-bank REFRESH
+	uint64_t stateCycles[NUM_BANK_STATES];	//Bank cycles in each bank state
+};
+
 //forward declaration
 class VaultController;
 class DRAM : public SimulatorObject
@@ -48,8 +95,11 @@ public:
 	//
 	unsigned DRAMID;
 	VaultController *vaultContP;
-	vector<BankState *> bankStates;
+	BankState bankStates;				//Bank state arrays of the vault
 	vector<BankStateType> previousBankState;
+	vector<uint64_t> columnAccess;		//READ and WRITE commands (32 bytes each) per bank
+	EnergyStat epochEnergyStat;
+	EnergyStat totalEnergyStat;
 	
 	//To be returned command	
 	DRAMCommand *readData;
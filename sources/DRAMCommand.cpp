@@ -29,6 +29,11 @@ DRAMCommand::DRAMCommand(DRAMCommandType cmdtype, unsigned tag, unsigned bnk, un
 	atomic(atm),
 	segment(seg)
 {
+	address = 0;
+	payload = NULL;
+	atomicFlag = false;
+	priority = 0;
+	bypassed = 0;
 }
 
 DRAMCommand::DRAMCommand(const DRAMCommand &dc)
@@ -45,6 +50,11 @@ DRAMCommand::DRAMCommand(const DRAMCommand &dc)
 	packetCMD = dc.packetCMD;
 	atomic = dc.atomic;
 	segment = dc.segment;
+	address = dc.address;
+	payload = dc.payload;
+	atomicFlag = dc.atomicFlag;
+	priority = dc.priority;
+	bypassed = dc.bypassed;
 }
 
 DRAMCommand::~DRAMCommand()
@@ -70,6 +70,11 @@ public:
 	PacketCommandType packetCMD;
 	bool atomic;
 	bool segment;
+	uint64_t address;		//Physical address of request packet (for functional memory)
+	uint8_t *payload;		//Host data of request packet (for functional memory)
+	bool atomicFlag;		//Atomic flag (AF) of response packet
+	unsigned priority;		//QoS class of request packet
+	unsigned bypassed;		//The number of times bypassed by higher-priority commands
 };
 
 ostream& operator<<(ostream &out, const DRAMCommand &dc);
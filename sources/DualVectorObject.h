@@ -46,15 +46,15 @@ public:
 		bufPopDelay = (bufPopDelay>0) ? bufPopDelay-1 : 0;
 	}
 	
-	bool ReceiveDown(DownT *downEle) {
-		if(downBuffers.size() + downEle->LNG <= downBufferMax) {
+	virtual bool ReceiveDown(DownT *downEle) {
+		if(downBuffers.size() + BufferLength(downEle) <= downBufferMax) {
 			if(downBuffers.size() == 0) {
 				bufPopDelay = (bufPopDelay>0) ? bufPopDelay : 1;
 			}
 			downBuffers.push_back(downEle);
 			//If receiving packet is packet, add virtual tail packet in Buffers as long as packet length
 			if(sizeof(*downEle) == sizeof(Packet)) {
-				for(int i=1; i<downEle->LNG; i++) {
+				for(int i=1; i<BufferLength(downEle); i++) {
 					downBuffers.push_back(NULL);
 				}
 			}
@@ -67,13 +67,13 @@ public:
 		}
 	}
 	bool ReceiveUp(UpT *upEle) {
-		if(upBuffers.size() + upEle->LNG <= upBufferMax) {
+		if(upBuffers.size() + BufferLength(upEle) <= upBufferMax) {
 			//Upstream buffer does not need upBufPopCycle (one cycle to pop one buffer data), 
 			//	because upBufferDest (upstream buffer destination) is updated before buffer class.
 			upBuffers.push_back(upEle);
 			//If receiving packet is packet, add virtual tail packet in Buffers as long as packet length
 			if(sizeof(*upEle) == sizeof(Packet)) {
-				for(int i=1; i<upEle->LNG; i++) {
+				for(int i=1; i<BufferLength(upEle); i++) {
 					upBuffers.push_back(NULL);
 				}
 			}
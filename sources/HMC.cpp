@@ -26,6 +26,7 @@ HMC::HMC(ofstream &debugOut_, ofstream &stateOut_):
 		downLinkSlaves.push_back(new LinkSlave(debugOut, stateOut, l, true));
 		upLinkMasters.push_back(new LinkMaster(debugOut, stateOut, l, false));
 	}
+	addressMap = new AddressMap(ADDRESS_ORDER, VAULT_HASH, BANK_HASH);
 	crossbarSwitch = new CrossbarSwitch(debugOut, stateOut);
 	vaultControllers.reserve(NUM_VAULTS);
 	drams.reserve(NUM_VAULTS);
@@ -40,10 +41,12 @@ HMC::HMC(ofstream &debugOut_, ofstream &stateOut_):
 	}
 	
 	//Crossbar switch, and vault are linked each other by respective lanes
+	crossbarSwitch->addressMap = addressMap;
 	for(int v=0; v<NUM_VAULTS; v++) {
 		//Downstream
 		crossbarSwitch->downBufferDest[v] = vaultControllers[v];
 		vaultControllers[v]->dramP = drams[v];
+		vaultControllers[v]->addressMap = addressMap;
 		//Upstream
 		vaultControllers[v]->upBufferDest = crossbarSwitch;
 	}
@@ -67,6 +70,7 @@ HMC::~HMC()
 	}
 	vaultControllers.clear();
 	drams.clear();
+	delete addressMap;
 }
 
 //
@@ -75,17 +79,17 @@ HMC::~HMC()
 void HMC::Update()
 {	
 	for(int l=0; l<NUM_LINKS; l++) {
-		downLinkSlaves[l]->Update();
+		PROFILE_CALL(downLinkSlaves[l]->profile, downLinkSlaves[l]->Update());
 	}
-	crossbarSwitch->Update();
+	PROFILE_CALL(crossbarSwitch->profile, crossbarSwitch->Update());
 	for(int v=0; v<NUM_VAULTS; v++) {
-		vaultControllers[v]->Update();
+		PROFILE_CALL(vaultControllers[v]->profile, vaultControllers[v]->Update());
 	}
 	for(int v=0; v<NUM_VAULTS; v++) {
-		drams[v]->Update();
+		PROFILE_CALL(drams[v]->profile, drams[v]->Update());
 	}
 	for(int l=0; l<NUM_LINKS; l++) {
-		upLinkMasters[l]->Update();
+		PROFILE_CALL(upLinkMasters[l]->profile, upLinkMasters[l]->Update());
 	}
 	clockTuner++;
 	Step();
@@ -50,6 +50,7 @@ public:
 	CrossbarSwitch *crossbarSwitch;
 	vector<VaultController *> vaultControllers;
 	vector<DRAM *> drams;
+	AddressMap *addressMap;
 };
 
 }
@@ -24,6 +24,8 @@ HMCController::HMCController(ofstream &debugOut_, ofstream &stateOut_):
 	header = " (HC)";
 	
 	inServiceLink = -1;
+	addressMap = NULL;
+	tagPool = new TagPool(NUM_TAGS);
 	maxLinkBand = LINK_WIDTH * LINK_SPEED / 8;
 	linkEpochCycle = ceil((double)LINK_EPOCH*1000000/CPU_CLK_PERIOD);
 	requestAccLNG = 0;
@@ -32,6 +34,17 @@ HMCController::HMCController(ofstream &debugOut_, ofstream &stateOut_):
 	alloMSHR = 0;
 	accuMSHR = 0;
 	returnTransCnt = 0;
+	linkIssued = vector<bool>(NUM_LINKS, false);
+	if(QOS_CLASSES < 1 || QOS_BYPASS_LIMIT < 1) {
+		ERROR(header<<"  == Error - QOS_CLASSES ("<<QOS_CLASSES<<") and QOS_BYPASS_LIMIT ("<<QOS_BYPASS_LIMIT<<") should be bigger than 0");
+		exit(0);
+	}
+	if(HOST_ISSUE_WIDTH < 1 || HOST_RETIRE_WIDTH < 1) {
+		ERROR(header<<"  == Error - HOST_ISSUE_WIDTH ("<<HOST_ISSUE_WIDTH<<") and HOST_RETIRE_WIDTH ("<<HOST_RETIRE_WIDTH<<") should be bigger than 0");
+		exit(0);
+	}
+	epochIssueStat = IssueStat(HOST_ISSUE_WIDTH);
+	totalIssueStat = IssueStat(HOST_ISSUE_WIDTH);
 	quiesceClk = ceil((double)tQUIESCE/CPU_CLK_PERIOD);
 	staggerSleep = 0;
 	staggerActive = 0;
@@ -62,6 +75,7 @@ HMCController::~HMCController()
 	}
 	downLinkMasters.clear();
 	upLinkSlaves.clear();
+	delete tagPool;
 }
 
 //
@@ -79,9 +93,14 @@ void HMCController::RegisterCallbacks(TransCompCB *readCB, TransCompCB *writeCB)
 void HMCController::CallbackReceiveDown(Transaction *downEle, bool chkReceive)
 {
 	if(chkReceive) {
+		if(downEle->priority >= QOS_CLASSES) {
+			ERROR(header<<"  == Error - QoS class of transaction ("<<downEle->priority<<") should be smaller than QOS_CLASSES ("<<QOS_CLASSES<<")");
+			exit(0);
+		}
 		//Check transaction address
 		downEle->address &= ((uint64_t)NUM_VAULTS*NUM_BANKS*NUM_COLS*NUM_ROWS - 1);
 		downEle->trace->tranTransmitTime = currentClockCycle;
+		downEle->trace->priority = downEle->priority;
 		if(downEle->transactionType == DATA_WRITE)	downEle->trace->statis->hmcTransmitSize += downEle->dataSize;
 		//DEBUG(ALI(18)<<header<<ALI(15)<<*downEle<<"Down) RECEIVING transaction");
 	}
@@ -121,81 +140,24 @@ void HMCController::Update()
 	
 	//accumulate the allocated MSHR size
 	accuMSHR += alloMSHR;
+	tagPool->Sample();
 	
-	//Downstream buffer state
+	//Downstream buffer state (transactions are issued in order of QoS class, and one packet is sent to each link in a cycle)
+	unsigned issued = 0;
 	if(bufPopDelay==0 && downBuffers.size() > 0) {
-		//Check packet dependency
-		int link = -1;
-		for(int l=0; l<NUM_LINKS; l++) {
-			for(int i=0; i<downLinkMasters[l]->Buffers.size(); i++) {
-				if(downLinkMasters[l]->Buffers[i] != NULL) {
-					unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
-					if((downLinkMasters[l]->Buffers[i]->ADRS >> maxBlockBit) == (downBuffers[0]->address >> maxBlockBit)) {
-						link = l;
-						DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[0]<<"Down) This transaction has a DEPENDENCY with "<<*downLinkMasters[l]->Buffers[i]);
-						break;
-					}
-				}
-			}
-		}
-		
-		if(link == -1) {
-			for(int l=0; l<NUM_LINKS; l++) {
-				link = FindAvailableLink(inServiceLink, downLinkMasters);
-				if(link == -1) {
-					//DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[0]<<"Down) all link buffer FULL");
-				}
-				else if(downLinkMasters[link]->currentState != ACTIVE
-				&& downLinkMasters[link]->currentState != LINK_RETRY) {
-					continue;
-					//DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[0]<<"Down) link "<<l<<" is not ACTIVE mode ["<<downLinkMasters[link]->powerMode<<"]");
-				}
-				else {
-					Packet *packet = ConvTranIntoPacket(downBuffers[0]);
-					if(downLinkMasters[link]->Receive(packet)) {
-						DE_CR(ALI(18)<<header<<ALI(15)<<*packet<<"Down) SENDING packet to link mater "<<link<<" (LM_D"<<link<<")");
-						if(!((packet->CMD >= P_WR16 && packet->CMD <= P_WR128)
-						|| packet->CMD == P_WR256 || packet->CMD == P_2ADD8
-						|| packet->CMD == P_ADD16 || packet->CMD == P_INC8
-						|| packet->CMD == P_BWR)) {
-							returnTransCnt++;
-						}
-						//Call callback function if posted write packet is tranmitted
-						if((packet->CMD >= P_WR16 && packet->CMD <= P_WR128) || packet->CMD == P_WR256) {
-							if(writeDone != NULL) {
-								(*writeDone)(packet->ADRS, currentClockCycle);
-							}
-						}
-						requestAccLNG += packet->LNG;
-						delete downBuffers[0];
-						downBuffers.erase(downBuffers.begin());
-						break;
-					}
-					else {
-						packet->ReductGlobalTAG();
-						delete packet;
-						//DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) Link "<<link<<" buffer FULL");	
-					}
-				}
-			}
-		}
-		else {
-			Packet *packet = ConvTranIntoPacket(downBuffers[0]);
-			if(downLinkMasters[link]->Receive(packet)) {
-				DE_CR(ALI(18)<<header<<ALI(15)<<*packet<<"Down) SENDING packet to link mater "<<link<<" (LM_D"<<link<<")");
-				delete downBuffers[0];
-				downBuffers.erase(downBuffers.begin());
-			}
-			else {
-				packet->ReductGlobalTAG();
-				delete packet;
-				//DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) Link "<<link<<" buffer FULL");	
-			}
+		epochIssueStat.busyCycles++;
+		linkIssued.assign(NUM_LINKS, false);
+		while(issued < HOST_ISSUE_WIDTH && downBuffers.size() > 0) {
+			if(!IssueTransaction())	break;
+			issued++;
 		}
 	}
+	epochIssueStat.issued += issued;
+	epochIssueStat.issueHist[issued]++;
 	
-	//Upstream buffer state
-	if(upBuffers.size() > 0) {
+	//Upstream buffer state (up to HOST_RETIRE_WIDTH responses in a cycle)
+	unsigned retired = 0;
+	while(retired < HOST_RETIRE_WIDTH && upBuffers.size() > 0) {
 		//Make sure that buffer[0] is not virtual tail packet.
 		if(upBuffers[0] == NULL) {
 			ERROR(header<<"  == Error - HMC controller up buffer[0] is NULL (It could be one of virtual tail packet occupying packet length  (CurrentClock : "<<currentClockCycle<<")");
@@ -204,28 +166,31 @@ void HMCController::Update()
 		else {
 			DE_CR(ALI(18)<<header<<ALI(15)<<*upBuffers[0]<<"Up)   RETURNING transaction to system bus");
 			upBuffers[0]->trace->tranFullLat = currentClockCycle - upBuffers[0]->trace->tranTransmitTime;
-			if(upBuffers[0]->CMD == RD_RS) {
-				upBuffers[0]->trace->statis->hmcTransmitSize += (upBuffers[0]->LNG - 1)*16;
+			if(upBuffers[0]->CMD() == RD_RS) {
+				upBuffers[0]->trace->statis->hmcTransmitSize += (upBuffers[0]->LNG() - 1)*16;
 			}
 			returnTransCnt--;
 			//Call callback function if it is registered
-			if(upBuffers[0]->CMD == WR_RS) {
+			if(upBuffers[0]->CMD() == WR_RS) {
 				if(writeDone != NULL) {
-					(*writeDone)(upBuffers[0]->ADRS, currentClockCycle);
+					(*writeDone)(upBuffers[0]->ADRS(), currentClockCycle);
 				}
 			}
-			else if(upBuffers[0]->CMD == RD_RS) {
+			else if(upBuffers[0]->CMD() == RD_RS) {
 				if(readDone != NULL) {
-					(*readDone)(upBuffers[0]->ADRS, currentClockCycle);
+					(*readDone)(upBuffers[0]->ADRS(), currentClockCycle);
 				}
 			}
-			int packetLNG = upBuffers[0]->LNG;
+			tagPool->Free(upBuffers[0]->TAG());
+			int packetLNG = upBuffers[0]->LNG();
 			responseAccLNG += packetLNG;
 			delete upBuffers[0]->trace;
 			delete upBuffers[0];
 			upBuffers.erase(upBuffers.begin(), upBuffers.begin()+packetLNG);
 		}
+		retired++;
 	}
+	epochIssueStat.retired += retired;
 	
 	//Link state manager
 	LinkPowerStateManager();
@@ -236,6 +201,136 @@ void HMCController::Update()
 	Step();
 }
 
+//
+//Convert the selected transaction into a packet and send it to a link master that has not received a packet in this cycle
+//
+bool HMCController::IssueTransaction()
+{
+	//The oldest transaction waits until a request tag is freed
+	if(!tagPool->Available()) {
+		tagPool->epochTagStat.exhaustCycles++;
+		//DEBUG(ALI(18)<<header<<ALI(15)<<*downBuffers[0]<<"Down) all request tags are in use");
+		return false;
+	}
+	
+	//Transaction of the highest QoS class is issued first
+	unsigned sel = SelectTransaction();
+	Transaction *tran = downBuffers[sel];
+	
+	//Check packet dependency
+	int link = -1;
+	for(int l=0; l<NUM_LINKS; l++) {
+		for(int i=0; i<downLinkMasters[l]->Buffers.size(); i++) {
+			if(downLinkMasters[l]->Buffers[i] != NULL) {
+				unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
+				if((downLinkMasters[l]->Buffers[i]->ADRS() >> maxBlockBit) == (tran->address >> maxBlockBit)) {
+					link = l;
+					DEBUG(ALI(18)<<header<<ALI(15)<<*tran<<"Down) This transaction has a DEPENDENCY with "<<*downLinkMasters[l]->Buffers[i]);
+					break;
+				}
+			}
+		}
+	}
+	
+	if(link == -1) {
+		int vault = addressMap->Vault(tran->address);
+		for(int l=0; l<NUM_LINKS; l++) {
+			link = FindAvailableLink(inServiceLink, downLinkMasters, vault);
+			if(link == -1) {
+				//DEBUG(ALI(18)<<header<<ALI(15)<<*tran<<"Down) all link buffer FULL");
+			}
+			else if(downLinkMasters[link]->currentState != ACTIVE
+			&& downLinkMasters[link]->currentState != LINK_RETRY) {
+				continue;
+				//DEBUG(ALI(18)<<header<<ALI(15)<<*tran<<"Down) link "<<l<<" is not ACTIVE mode ["<<downLinkMasters[link]->powerMode<<"]");
+			}
+			else if(linkIssued[link]) {
+				continue;
+			}
+			else {
+				Packet *packet = ConvTranIntoPacket(tran);
+				packet->SetTAG(tagPool->Allocate());
+				if(downLinkMasters[link]->Receive(packet)) {
+					DE_CR(ALI(18)<<header<<ALI(15)<<*packet<<"Down) SENDING packet to link mater "<<link<<" (LM_D"<<link<<")");
+					packet->trace->Stamp(STAGE_LINK_MASTER, currentClockCycle);
+					if(!packet->IsPosted()) {
+						returnTransCnt++;
+					}
+					//Call callback function if posted write packet is tranmitted
+					if((packet->CMD() >= P_WR16 && packet->CMD() <= P_WR128) || packet->CMD() == P_WR256) {
+						if(writeDone != NULL) {
+							(*writeDone)(packet->ADRS(), currentClockCycle);
+						}
+					}
+					requestAccLNG += packet->LNG();
+					PopTransaction(sel);
+					linkIssued[link] = true;
+					return true;
+				}
+				else {
+					tagPool->Unallocate(packet->TAG());
+					delete packet;
+					//DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) Link "<<link<<" buffer FULL");	
+				}
+			}
+		}
+	}
+	else if(!linkIssued[link]) {
+		Packet *packet = ConvTranIntoPacket(tran);
+		packet->SetTAG(tagPool->Allocate());
+		if(downLinkMasters[link]->Receive(packet)) {
+			DE_CR(ALI(18)<<header<<ALI(15)<<*packet<<"Down) SENDING packet to link mater "<<link<<" (LM_D"<<link<<")");
+			packet->trace->Stamp(STAGE_LINK_MASTER, currentClockCycle);
+			PopTransaction(sel);
+			linkIssued[link] = true;
+			return true;
+		}
+		else {
+			tagPool->Unallocate(packet->TAG());
+			delete packet;
+			//DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) Link "<<link<<" buffer FULL");	
+		}
+	}
+	return false;
+}
+
+//
+//Select the oldest transaction of the highest QoS class (it does not bypass an older transaction to the same block)
+//
+unsigned HMCController::SelectTransaction()
+{
+	unsigned sel = 0;
+	if(QOS_CLASSES > 1) {
+		unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
+		for(int i=1; i<downBuffers.size(); i++) {
+			if(QOS_CLASS(downBuffers[i]) <= QOS_CLASS(downBuffers[sel]))	continue;
+			bool dependency = false;
+			for(int j=0; j<i; j++) {
+				if((downBuffers[j]->address >> maxBlockBit) == (downBuffers[i]->address >> maxBlockBit)) {
+					dependency = true;
+					break;
+				}
+			}
+			if(!dependency)	sel = i;
+		}
+	}
+	return sel;
+}
+
+//
+//Remove the issued transaction, and count the bypassed transactions of lower classes (starvation guard)
+//
+void HMCController::PopTransaction(unsigned sel)
+{
+	for(int j=0; j<sel; j++) {
+		if(QOS_CLASS(downBuffers[j]) < QOS_CLASS(downBuffers[sel])) {
+			downBuffers[j]->bypassed++;
+		}
+	}
+	delete downBuffers[sel];
+	downBuffers.erase(downBuffers.begin()+sel);
+}
+
 //
 //Convert transaction into packet-based protocol (FLITs) where the packets consist of 128-bit flow units
 //
@@ -321,6 +416,8 @@ Packet *HMCController::ConvTranIntoPacket(Transaction *tran)
 	//packet, cmd, addr, cub, lng, *lat
 	Packet *newPacket = new Packet(REQUEST, cmdtype, tran->address, 0, packetLength, tran->trace);
 	newPacket->reqDataSize = reqDataSize;
+	newPacket->payload = tran->data;
+	newPacket->priority = tran->priority;
 	return newPacket;
 }
 
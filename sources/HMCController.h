@@ -14,6 +14,7 @@
 
 //HMCController.h
 
+#include <stdint.h>		//uint64_t
 #include <vector>		//vector
 
 #include "DualVectorObject.h"
@@ -21,12 +22,37 @@
 #include "CallBack.h"
 #include "LinkMaster.h"
 #include "LinkSlave.h"
+#include "AddressMap.h"
+#include "TagPool.h"
 
 using namespace std;
 
 namespace CasHMC
 {
 
+//Issue and retire slot statistics of HMC controller
+class IssueStat
+{
+public:
+	IssueStat(unsigned width=0):busyCycles(0), issued(0), retired(0) {
+		issueHist = vector<uint64_t>(width+1, 0);
+	}
+	IssueStat &operator+=(const IssueStat &s) {
+		busyCycles += s.busyCycles;
+		issued += s.issued;
+		retired += s.retired;
+		for(int i=0; i<issueHist.size() && i<s.issueHist.size(); i++) {
+			issueHist[i] += s.issueHist[i];
+		}
+		return *this;
+	}
+
+	uint64_t busyCycles;		//Cycles that any transaction is waiting in request buffer
+	uint64_t issued;			//Issued transactions
+	uint64_t retired;			//Retired responses
+	vector<uint64_t> issueHist;	//The number of cycles issuing [index] transactions
+};
+
 class HMCController : public DualVectorObject<Transaction, Packet>
 {
 public:
@@ -40,6 +66,9 @@ public:
 	void CallbackReceiveUp(Packet *upEle, bool chkReceive);
 	bool CanAcceptTran();
 	void Update();
+	bool IssueTransaction();
+	unsigned SelectTransaction();
+	void PopTransaction(unsigned sel);
 	Packet *ConvTranIntoPacket(Transaction *tran);
 	void LinkPowerEntryManager();
 	void LinkPowerStateManager();
@@ -54,6 +83,8 @@ public:
 	vector<LinkMaster *> downLinkMasters;
 	vector<LinkSlave *> upLinkSlaves;
 	int inServiceLink;
+	AddressMap *addressMap;				//Shared with HMC (ADDRESS_HASH link priority)
+	TagPool *tagPool;					//Request tags (posted request tags are freed by vault controllers)
 	
 	unsigned maxLinkBand;
 	unsigned linkEpochCycle;
@@ -77,6 +108,10 @@ public:
 	vector<uint64_t> linkSleepTime;
 	vector<uint64_t> linkDownTime;
 	
+	vector<bool> linkIssued;		//Link master received a packet in this cycle
+	IssueStat epochIssueStat;
+	IssueStat totalIssueStat;
+	
 	TransCompCB *readDone;
 	TransCompCB *writeDone;
 };
@@ -28,6 +28,7 @@ Link::Link(ofstream &debugOut_, ofstream &stateOut_, unsigned id, bool down, Tra
 	
 	linkMasterP = NULL;
 	linkSlaveP = NULL;
+	pipe = NULL;
 	inFlightPacket = NULL;
 	inFlightCountdown = 0;
 	
@@ -52,12 +53,12 @@ void Link::Update(bool lastUpdate)
 	if(linkMasterP->linkRxTx.size()>0 && linkMasterP->linkRxTx[0]->bufPopDelay==0 && inFlightPacket==NULL) {
 	//	if(linkMasterP->currentState == ACTIVE
 	//	|| linkMasterP->currentState == LINK_RETRY
-	//	|| (linkMasterP->currentState == START_RETRY && linkMasterP->linkRxTx[0]->CMD == IRTRY && linkMasterP->linkRxTx[0]->FRP == 1)
-	//	|| ((linkMasterP->currentState == WAIT || linkMasterP->currentState == SLEEP) && linkMasterP->linkRxTx[0]->CMD == QUIET)
-	//	|| linkMasterP->linkRxTx[0]->CMD == NULL_) {
+	//	|| (linkMasterP->currentState == START_RETRY && linkMasterP->linkRxTx[0]->CMD() == IRTRY && linkMasterP->linkRxTx[0]->FRP() == 1)
+	//	|| ((linkMasterP->currentState == WAIT || linkMasterP->currentState == SLEEP) && linkMasterP->linkRxTx[0]->CMD() == QUIET)
+	//	|| linkMasterP->linkRxTx[0]->CMD() == NULL_) {
 			inFlightPacket = linkMasterP->linkRxTx[0];
 			UpdateStatistic(inFlightPacket);
-			inFlightCountdown = (inFlightPacket->LNG * 128) / LINK_WIDTH;
+			inFlightCountdown = (inFlightPacket->LNG() * 128) / LINK_WIDTH;
 			DEBUG(ALI(18)<<header<<ALI(15)<<*inFlightPacket<<(downstream ? "Down) " : "Up)   ")<<"START transmission packet");
 			linkMasterP->linkRxTx.erase(linkMasterP->linkRxTx.begin());
 	//	}
@@ -70,9 +71,15 @@ void Link::Update(bool lastUpdate)
 			NoisePacket(inFlightPacket);
 			DEBUG(ALI(18)<<header<<ALI(15)<<*inFlightPacket<<(downstream ? "Down) " : "Up)   ")<<"DONE transmission packet");
 			inFlightPacket->bufPopDelay = 1;
-			linkSlaveP->linkRxTx.push_back(inFlightPacket);
-			if(inFlightPacket->packetType == RESPONSE)
-				inFlightPacket->trace->linkFullLat = linkSlaveP->currentClockCycle - inFlightPacket->trace->linkTransmitTime;
+			if(pipe != NULL) {
+				//Link slave receives the packet in the next CPU clock on the other thread
+				pipe->PushPacket(linkID, inFlightPacket);
+			}
+			else {
+				linkSlaveP->linkRxTx.push_back(inFlightPacket);
+				if(inFlightPacket->packetType == RESPONSE)
+					inFlightPacket->trace->linkFullLat = linkSlaveP->currentClockCycle - inFlightPacket->trace->linkTransmitTime;
+			}
 			inFlightPacket = NULL;
 		}
 		else if(lastUpdate) {
@@ -94,15 +101,15 @@ void Link::Update(bool lastUpdate)
 void Link::UpdateStatistic(Packet *packet)
 {
 	if(downstream) {
-		statis->downLinkTransmitSize[linkID] += packet->LNG * 16;
-		if(packet->LNG > 1) {
-			statis->downLinkDataSize[linkID] += (packet->LNG-1) * 16;
+		statis->downLinkTransmitSize[linkID] += packet->LNG() * 16;
+		if(packet->LNG() > 1) {
+			statis->downLinkDataSize[linkID] += (packet->LNG()-1) * 16;
 		}
 	}
 	else {
-		statis->upLinkTransmitSize[linkID] += packet->LNG * 16;
-		if(packet->LNG > 1) {
-			statis->upLinkDataSize[linkID] += (packet->LNG-1) * 16;
+		statis->upLinkTransmitSize[linkID] += packet->LNG() * 16;
+		if(packet->LNG() > 1) {
+			statis->upLinkDataSize[linkID] += (packet->LNG()-1) * 16;
 		}
 	}
 	
@@ -110,16 +117,18 @@ void Link::UpdateStatistic(Packet *packet)
 		case REQUEST:
 			statis->reqPerLink[linkID]++;
 			packet->trace->linkTransmitTime = linkMasterP->currentClockCycle;
+			packet->trace->StampFirst(STAGE_LINK_RETRY, linkMasterP->currentClockCycle);
+			packet->trace->Stamp(STAGE_LINK_SERIAL, linkMasterP->currentClockCycle);
 
-			if((WR16 <= packet->CMD && packet->CMD <= MD_WR)
-			|| packet->CMD == WR256
-			|| (P_WR16 <= packet->CMD && packet->CMD <= P_WR128)
-			|| packet->CMD == P_WR256) {
+			if((WR16 <= packet->CMD() && packet->CMD() <= MD_WR)
+			|| packet->CMD() == WR256
+			|| (P_WR16 <= packet->CMD() && packet->CMD() <= P_WR128)
+			|| packet->CMD() == P_WR256) {
 				statis->writePerLink[linkID]++;
 			}
-			else if((RD16 <= packet->CMD && packet->CMD <= RD128)
-			|| packet->CMD == RD256
-			|| packet->CMD == MD_RD) {
+			else if((RD16 <= packet->CMD() && packet->CMD() <= RD128)
+			|| packet->CMD() == RD256
+			|| packet->CMD() == MD_RD) {
 				statis->readPerLink[linkID]++;
 			}
 			else {
@@ -144,12 +153,12 @@ void Link::UpdateStatistic(Packet *packet)
 //
 void Link::NoisePacket(Packet *packet)
 {
-	for(int i=0; i<packet->LNG; i++) {
-		unsigned ranNum1 = rand();
-		unsigned ranNum2 = rand();	
+	for(int i=0; i<packet->LNG(); i++) {
+		unsigned ranNum1 = SimRand();
+		unsigned ranNum2 = SimRand();	
 		if(ranNum1%errorProba == 0 && ranNum2%errorProba == 0) {
 			DE_CR(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")<<"====> Link ERROR is occurred <====");
-			packet->CRC = ~packet->CRC;
+			packet->SetCRC(~packet->CRC());
 			break;
 		}
 	}
@@ -164,7 +173,7 @@ void Link::PrintState()
 		STATEN(ALI(17)<<header);
 		STATEN((downstream ? "Down " : " Up  "));
 		STATEN(*inFlightPacket);
-		STATE("*"<<inFlightPacket->LNG);
+		STATE("*"<<inFlightPacket->LNG());
 	}
 }
 
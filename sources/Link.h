@@ -18,6 +18,7 @@
 
 #include "SingleVectorObject.h"
 #include "ConfigValue.h"
+#include "LinkPipe.h"
 
 using namespace std;
 
@@ -48,6 +49,7 @@ public:
 	LinkMaster *linkMasterP;
 	TranStatistic *statis;
 	SingleVectorObject<Packet> *linkSlaveP;
+	LinkPipe *pipe;					//Packets are handed to the other thread instead of link slave (PIPELINE_SIM)
 	
 	//Currently transmitting packet through link
 	Packet *inFlightPacket;
@@ -39,7 +39,17 @@ LinkMaster::LinkMaster(ofstream &debugOut_, ofstream &stateOut_, unsigned id, bo
 	retBufWriteP = 0;
 	retrainTransit = 0;
 	firstNull = true;
-	
+	tokenLatency = 0;
+
+	//Retry pointers are carried in the 9-bit FRP and RRP fields, and link ID in the 3-bit SLID field
+	if(MAX_RETRY_BUF < 1 || MAX_RETRY_BUF > 512) {
+		ERROR(header<<"  == Error - MAX_RETRY_BUF ("<<MAX_RETRY_BUF<<") should be in 1 ~ 512 (9-bit FRP and RRP fields)");
+		exit(0);
+	}
+	if(NUM_LINKS > 8) {
+		ERROR(header<<"  == Error - NUM_LINKS ("<<NUM_LINKS<<") should not be bigger than 8 (3-bit SLID field)");
+		exit(0);
+	}
 	retryBuffers = vector<Packet *>(MAX_RETRY_BUF, NULL);
 }
 
@@ -60,6 +70,9 @@ void LinkMaster::CallbackReceive(Packet *packet, bool chkReceive)
 	else {
 		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")<<"packet buffer FULL");
 	}*/
+	if(LINK_PRIORITY == LATENCY_AWARE && chkReceive && packet->packetType != FLOW) {
+		tokenStamp.insert(tokenStamp.end(), packet->LNG(), currentClockCycle);
+	}
 }
 
 //
@@ -67,7 +80,7 @@ void LinkMaster::CallbackReceive(Packet *packet, bool chkReceive)
 //
 void LinkMaster::UpdateRetryPointer(Packet *packet)
 {
-	if(retBufReadP != packet->RRP) {
+	if(retBufReadP != packet->RRP()) {
 		do {
 			if(retryBuffers[retBufReadP] != NULL) {
 				delete retryBuffers[retBufReadP];
@@ -75,7 +88,7 @@ void LinkMaster::UpdateRetryPointer(Packet *packet)
 			retryBuffers[retBufReadP] = NULL;
 			retBufReadP++;
 			retBufReadP = (retBufReadP < MAX_RETRY_BUF) ? retBufReadP : retBufReadP - MAX_RETRY_BUF;
-		} while(retBufReadP != packet->RRP);
+		} while(retBufReadP != packet->RRP());
 		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")<<"Retry buffer READ POINTER is updated ("<<retBufReadP<<")");
 	}
 }
@@ -85,16 +98,16 @@ void LinkMaster::UpdateRetryPointer(Packet *packet)
 //
 void LinkMaster::ReturnRetryPointer(Packet *packet)
 {
-	lastestRRP = packet->FRP;
+	lastestRRP = packet->FRP();
 	if(Buffers.size() != 0) {
-		Buffers[0]->RRP = lastestRRP;
+		Buffers[0]->SetRRP(lastestRRP);
 		DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[0]<<(downstream ? "Down) " : "Up)   ")<<"RRP ("<<lastestRRP<<") is embedded in this packet");
 	}
 	else {
 		//packet, cmd, addr, cub, lng, *lat
 		Packet *packetPRET = new Packet(FLOW, PRET, 0, 0, 1, NULL);
-		packetPRET->TAG = packet->TAG;
-		packetPRET->RRP = lastestRRP;
+		packetPRET->SetTAG(packet->TAG());
+		packetPRET->SetRRP(lastestRRP);
 		if(downstream)	packetPRET->bufPopDelay = 0;
 		linkRxTx.push_back(packetPRET);
 		DEBUG(ALI(18)<<header<<ALI(15)<<*packetPRET<<(downstream ? "Down) " : "Up)   ")<<"MAKING PRET packet to be embedded RRP ("<<lastestRRP<<")");
@@ -106,13 +119,20 @@ void LinkMaster::ReturnRetryPointer(Packet *packet)
 //
 void LinkMaster::UpdateToken(Packet *packet)
 {
-	if(packet->RTC != 0) {
-		tokenCount += packet->RTC;
-		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")<<"Extracted RTC : "<<packet->RTC<<"  TOKEN COUNT register : "<<tokenCount);
+	if(packet->RTC() != 0) {
+		tokenCount += packet->RTC();
+		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")<<"Extracted RTC : "<<packet->RTC()<<"  TOKEN COUNT register : "<<tokenCount);
 		if(tokenCount > MAX_LINK_BUF) {
 			ERROR(header<<"  == Error - TOKEN COUNT register is over the maximum  (CurrentClock : "<<currentClockCycle<<")");
 			exit(0);
 		}
+		//The returned tokens are matched to the oldest flits (link slave buffer is in-order)
+		if(LINK_PRIORITY == LATENCY_AWARE && !tokenStamp.empty()) {
+			unsigned retFlit = min((unsigned)packet->RTC(), (unsigned)tokenStamp.size());
+			uint64_t sample = currentClockCycle - tokenStamp[retFlit-1];
+			tokenStamp.erase(tokenStamp.begin(), tokenStamp.begin()+retFlit);
+			tokenLatency = tokenLatency*0.875 + sample*0.125;
+		}
 	}
 }	
 
@@ -121,30 +141,30 @@ void LinkMaster::UpdateToken(Packet *packet)
 //
 void LinkMaster::ReturnTocken(Packet *packet)
 {
-	int i, extRTC = packet->LNG;
+	int i, extRTC = packet->LNG();
 	bool findPacket = false;
 	for(i=0; i<Buffers.size(); i++) {
-		if(Buffers[i] != NULL && Buffers[i]->CMD != PRET && Buffers[i]->CMD != IRTRY) {
-			if(Buffers[i]->LNG <= tokenCount) {
+		if(Buffers[i] != NULL && Buffers[i]->CMD() != PRET && Buffers[i]->CMD() != IRTRY) {
+			if(Buffers[i]->LNG() <= tokenCount) {
 				findPacket = true;
 			}
 			break;
 		}
 	}
 	if(findPacket) {
-		if(Buffers[i]->RTC == 0) {
+		if(Buffers[i]->RTC() == 0) {
 			DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[i]<<(downstream ? "Down) " : "Up)   ")<<"RTC ("<<extRTC<<") is embedded in this packet (from "<<*packet<<")");
 		}
 		else {
-			DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[i]<<(downstream ? "Down) " : "Up)   ")<<"RTC ("<<Buffers[i]->RTC<<" + "<<extRTC<<") is embedded in this packet (from "<<*packet<<")");
+			DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[i]<<(downstream ? "Down) " : "Up)   ")<<"RTC ("<<Buffers[i]->RTC()<<" + "<<extRTC<<") is embedded in this packet (from "<<*packet<<")");
 		}
-		Buffers[i]->RTC += extRTC;
+		Buffers[i]->SetRTC(Buffers[i]->RTC() + extRTC);
 	}
 	else {
 		//packet, cmd, addr, cub, lng, *lat
 		Packet *packetTRET = new Packet(FLOW, TRET, 0, 0, 1, NULL);
-		packetTRET->TAG = packet->TAG;
-		packetTRET->RTC = extRTC;
+		packetTRET->SetTAG(packet->TAG());
+		packetTRET->SetRTC(extRTC);
 		if(downstream)	packetTRET->bufPopDelay = 0;
 		
 		if(currentState == LINK_RETRY) {
@@ -152,7 +172,7 @@ void LinkMaster::ReturnTocken(Packet *packet)
 		}
 		else {
 			if(startCRC == true) {
-				Buffers.insert(Buffers.begin()+Buffers[0]->LNG, packetTRET);
+				Buffers.insert(Buffers.begin()+Buffers[0]->LNG(), packetTRET);
 			}
 			else {
 				Buffers.insert(Buffers.begin(), packetTRET);
@@ -178,9 +198,9 @@ void LinkMaster::StartRetry(Packet *packet)
 		else {
 			//packet, cmd, addr, cub, lng, *lat
 			Packet *packetIRTRY = new Packet(FLOW, IRTRY, 0, 0, 1, NULL);
-			packetIRTRY->TAG = packet->TAG;
-			packetIRTRY->RRP = lastestRRP;
-			packetIRTRY->FRP = 1;		//StartRetry flag is set with FRP[0] = 1
+			packetIRTRY->SetTAG(packet->TAG());
+			packetIRTRY->SetRRP(lastestRRP);
+			packetIRTRY->SetFRP(1);		//StartRetry flag is set with FRP[0] = 1
 			if(downstream)	packetIRTRY->bufPopDelay = 0;
 			linkRxTx.insert(linkRxTx.begin(), packetIRTRY);
 			currentState = START_RETRY;
@@ -207,9 +227,9 @@ void LinkMaster::LinkRetry(Packet *packet)
 	for(int i=0; i<NUM_OF_IRTRY; i++) {
 		//packet, cmd, addr, cub, lng, *lat
 		Packet *packetIRTRY = new Packet(FLOW, IRTRY, 0, 0, 1, NULL);
-		packetIRTRY->TAG = packet->TAG;
-		packetIRTRY->RRP = lastestRRP;
-		packetIRTRY->FRP = 2;		//ClearErrorAbort flag is set with FRP[1] = 1
+		packetIRTRY->SetTAG(packet->TAG());
+		packetIRTRY->SetRRP(lastestRRP);
+		packetIRTRY->SetFRP(2);		//ClearErrorAbort flag is set with FRP[1] = 1
 		if(downstream)	packetIRTRY->bufPopDelay = 0;
 		linkRxTx.push_back(packetIRTRY);
 	}
@@ -236,7 +256,7 @@ void LinkMaster::LinkRetry(Packet *packet)
 				if(downstream)	retryPacket->bufPopDelay = 0;
 				else			retryPacket->bufPopDelay = 1;
 				if(retryPacket->packetType != FLOW) {
-					retryToken += retryPacket->LNG;
+					retryToken += retryPacket->LNG();
 				}
 				delete retryBuffers[tempReadP];
 				retryBuffers[tempReadP] = NULL;
@@ -297,9 +317,13 @@ void LinkMaster::Update()
 			exit(0);
 		}
 		else if(Buffers[0]->bufPopDelay == 0) {
+			//The packet of the highest QoS class is transmitted first (not during CRC calculation or link retry)
+			if(QOS_CLASSES > 1 && currentState == ACTIVE && !startCRC) {
+				PromotePacket();
+			}
 			//Token count register represents the available space in link slave input buffer
-			if(linkRxTx.size() == 0 && !(Buffers[0]->packetType != FLOW && tokenCount < Buffers[0]->LNG)) {
-				int tempWriteP = retBufWriteP + Buffers[0]->LNG;
+			if(linkRxTx.size() == 0 && !(Buffers[0]->packetType != FLOW && tokenCount < Buffers[0]->LNG())) {
+				int tempWriteP = retBufWriteP + Buffers[0]->LNG();
 				if(retBufWriteP	>= retBufReadP) {
 					if(tempWriteP - (int)retBufReadP < MAX_RETRY_BUF) {
 						CRCCountdown(tempWriteP, Buffers[0]);
@@ -318,7 +342,7 @@ void LinkMaster::Update()
 				}
 			}
 			else {
-				//DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[0]<<(downstream ? "Down) " : "Up)   ")<<"packet length ("<<Buffers[0]->LNG<<") is BIGGER than token count register ("<<tokenCount<<")");
+				//DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[0]<<(downstream ? "Down) " : "Up)   ")<<"packet length ("<<Buffers[0]->LNG()<<") is BIGGER than token count register ("<<tokenCount<<")");
 			}
 		}
 	}
@@ -331,9 +355,9 @@ void LinkMaster::Update()
 			for(int i=0; i<NUM_OF_IRTRY; i++) {
 				//packet, cmd, addr, cub, lng, *lat
 				Packet *packetIRTRY = new Packet(FLOW, IRTRY, 0, 0, 1, NULL);
-				packetIRTRY->TAG = retryStartPacket->TAG;
-				packetIRTRY->RRP = lastestRRP;
-				packetIRTRY->FRP = 1;		//StartRetry flag is set with FRP[0] = 1
+				packetIRTRY->SetTAG(retryStartPacket->TAG());
+				packetIRTRY->SetRRP(lastestRRP);
+				packetIRTRY->SetFRP(1);		//StartRetry flag is set with FRP[0] = 1
 				if(downstream)	packetIRTRY->bufPopDelay = 0;
 				linkRxTx.push_back(packetIRTRY);
 				currentState = START_RETRY;
@@ -394,12 +418,12 @@ void LinkMaster::CRCCountdown(int writeP, Packet *packet)
 {
 	if(CRC_CHECK && !startCRC) {
 		startCRC = true;
-		countdownCRC = ceil((double)CRC_CAL_CYCLE * packet->LNG);
+		countdownCRC = ceil((double)CRC_CAL_CYCLE * packet->LNG());
 	}
 	
 	if(CRC_CHECK && countdownCRC > 0) {
 		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")
-				<<"WAITING CRC calculation ("<<countdownCRC<<"/"<<ceil((double)CRC_CAL_CYCLE*packet->LNG)<<")");
+				<<"WAITING CRC calculation ("<<countdownCRC<<"/"<<ceil((double)CRC_CAL_CYCLE*packet->LNG())<<")");
 	}
 	else {
 		UpdateField(writeP, packet);
@@ -415,18 +439,18 @@ void LinkMaster::CRCCountdown(int writeP, Packet *packet)
 void LinkMaster::UpdateField(int nextWriteP, Packet *packet)
 {
 	//Sequence number updated
-	packet->SEQ = (masterSEQ<7) ? masterSEQ++ : 0;
+	packet->SetSEQ((masterSEQ<7) ? masterSEQ++ : 0);
 	//Update retry buffer pointer field
-	packet->RRP = lastestRRP;
-	packet->FRP = (nextWriteP < MAX_RETRY_BUF) ? nextWriteP : nextWriteP - MAX_RETRY_BUF;
+	packet->SetRRP(lastestRRP);
+	packet->SetFRP((nextWriteP < MAX_RETRY_BUF) ? nextWriteP : nextWriteP - MAX_RETRY_BUF);
 	//CRC field updated
 	startCRC = false;
-	if(CRC_CHECK)	packet->CRC = packet->GetCRC();
+	if(CRC_CHECK)	packet->SetCRC(packet->GetCRC());
 	//Decrement the token count register by the number of packet in the transmitted packet
 	if(packet->packetType != FLOW) {
-		tokenCount -= packet->LNG;
+		tokenCount -= packet->LNG();
 		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")
-			<<"Decreased TOKEN : "<<packet->LNG<<" (remaining : "<<tokenCount<<"/"<<MAX_LINK_BUF<<")");
+			<<"Decreased TOKEN : "<<packet->LNG()<<" (remaining : "<<tokenCount<<"/"<<MAX_LINK_BUF<<")");
 	}
 	//Save packet in retry buffer
 	Packet *retryPacket = new Packet(*packet);
@@ -437,18 +461,57 @@ void LinkMaster::UpdateField(int nextWriteP, Packet *packet)
 		ERROR(header<<"  == Error - retryBuffers["<<retBufWriteP<<"] is not NULL  (CurrentClock : "<<currentClockCycle<<")");
 		exit(0);
 	}
-	for(int i=1; i<packet->LNG; i++) {
+	for(int i=1; i<packet->LNG(); i++) {
 		retryBuffers[(retBufWriteP+i<MAX_RETRY_BUF ? retBufWriteP+i : retBufWriteP+i-MAX_RETRY_BUF)] = NULL;
 	}
 	DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")
-			<<"RETRY BUFFER["<<retBufWriteP<<"] (FRP : "<<packet->FRP<<")");
-	retBufWriteP = packet->FRP;
+			<<"RETRY BUFFER["<<retBufWriteP<<"] (FRP : "<<packet->FRP()<<")");
+	retBufWriteP = packet->FRP();
 	//Send packet to standby buffer where the packet is ready to be transmitted
 	packet->bufPopDelay = 1;
 	linkRxTx.push_back(packet);
 	//DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[0]<<(downstream ? "Down) " : "Up)   ")
 	//			<<"SENDING packet to link "<<linkMasterID<<" (LK_"<<(downstream ? "D" : "U")<<linkMasterID<<")");
-	Buffers.erase(Buffers.begin(), Buffers.begin()+packet->LNG);
+	Buffers.erase(Buffers.begin(), Buffers.begin()+packet->LNG());
+}
+
+//
+//Move the oldest ready packet of the highest QoS class to the head of buffer
+// (the packet does not bypass an older packet to the same block)
+//
+void LinkMaster::PromotePacket()
+{
+	if(Buffers[0]->packetType == FLOW)	return;
+	
+	unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
+	int sel = 0;
+	for(int i=Buffers[0]->LNG(); i<Buffers.size(); i++) {
+		if(Buffers[i] == NULL || Buffers[i]->packetType == FLOW)	continue;
+		if(Buffers[i]->bufPopDelay > 0)	break;
+		if(QOS_CLASS(Buffers[i]) <= QOS_CLASS(Buffers[sel]))	continue;
+		bool dependency = false;
+		for(int j=0; j<i; j++) {
+			if(Buffers[j] != NULL && Buffers[j]->packetType != FLOW
+			&& (Buffers[j]->ADRS() >> maxBlockBit) == (Buffers[i]->ADRS() >> maxBlockBit)) {
+				dependency = true;
+				break;
+			}
+		}
+		if(!dependency)	sel = i;
+	}
+	if(sel == 0)	return;
+	
+	//Bypassed packets of lower classes are counted for starvation guard
+	Packet *packet = Buffers[sel];
+	for(int j=0; j<sel; j++) {
+		if(Buffers[j] != NULL && Buffers[j]->packetType != FLOW && QOS_CLASS(Buffers[j]) < QOS_CLASS(packet)) {
+			Buffers[j]->bypassed++;
+		}
+	}
+	Buffers.erase(Buffers.begin()+sel, Buffers.begin()+sel+packet->LNG());
+	Buffers.insert(Buffers.begin(), packet->LNG()-1, (Packet *)NULL);
+	Buffers.insert(Buffers.begin(), packet);
+	DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<(downstream ? "Down) " : "Up)   ")<<"QoS class "<<packet->priority<<" packet is PROMOTED to the head of buffer");
 }
 
 //
@@ -458,7 +521,7 @@ void LinkMaster::QuitePacket()
 {
 	//packet, cmd, addr, cub, lng, *lat
 	Packet *packetQUIET = new Packet(FLOW, QUIET, 0, 0, 1, NULL);
-	packetQUIET->RRP = lastestRRP;
+	packetQUIET->SetRRP(lastestRRP);
 	DEBUG(ALI(18)<<header<<ALI(15)<<*packetQUIET<<(downstream ? "Down) " : "Up)   ")<<"sending QUITE packet");
 	linkRxTx.push_back(packetQUIET);
 }
@@ -570,8 +633,9 @@ void LinkMaster::PrintState()
 
 //
 //Determines which link should be used to receive a request
+// (vault is the destination or source vault of the packet, and it is only used for ADDRESS_HASH)
 //
-int FindAvailableLink(int &link, vector<LinkMaster *> &LM)
+int FindAvailableLink(int &link, vector<LinkMaster *> &LM, int vault)
 {
 	switch(LINK_PRIORITY) {
 		case ROUND_ROBIN:
@@ -579,7 +643,7 @@ int FindAvailableLink(int &link, vector<LinkMaster *> &LM)
 				link=0;
 			return link;
 			break;
-		case BUFFER_AWARE:
+		case BUFFER_AWARE: {
 			unsigned minBufferSize = MAX_LINK_BUF;
 			unsigned minBufferLink = 0;
 			for(int l=0; l<NUM_LINKS; l++) {
@@ -590,7 +654,7 @@ int FindAvailableLink(int &link, vector<LinkMaster *> &LM)
 					int bufSizeTemp = LM[l]->Buffers.size();
 					for(int i=0; i<LM[l]->linkRxTx.size(); i++) {
 						if(LM[l]->linkRxTx[i] != NULL) {
-							bufSizeTemp += LM[l]->linkRxTx[i]->LNG;
+							bufSizeTemp += LM[l]->linkRxTx[i]->LNG();
 						}
 					}
 					if(bufSizeTemp < minBufferSize) {
@@ -601,6 +665,47 @@ int FindAvailableLink(int &link, vector<LinkMaster *> &LM)
 			}
 			return minBufferLink;
 			break;
+		}
+		case ADDRESS_HASH:
+			//Vaults in the same quadrant share the home link
+			if(vault >= 0) {
+				int homeLink = (NUM_VAULTS >= NUM_LINKS) ? vault*NUM_LINKS/NUM_VAULTS : vault%NUM_LINKS;
+				if(LM[homeLink]->currentState == ACTIVE) {
+					return homeLink;
+				}
+			}
+			//No break (the home link is in sleep or retry state, so the least loaded link is used)
+		case LEAST_FLITS:
+		case LATENCY_AWARE: {
+			//ACTIVE link is preferred to the link in retry state
+			int minLink = -1;
+			bool minRetry = true;
+			double minCost = 0;
+			for(int l=0; l<NUM_LINKS; l++) {
+				if(LM[l]->currentState != ACTIVE && LM[l]->currentState != LINK_RETRY) {
+					continue;
+				}
+				bool retry = (LM[l]->currentState == LINK_RETRY);
+				//Outstanding flits are the flits waiting in the buffer and the flits whose token is not returned
+				double cost = LM[l]->Buffers.size() + MAX_LINK_BUF - LM[l]->tokenCount;
+				if(LINK_PRIORITY == LATENCY_AWARE) {
+					//The oldest waiting flit bounds the latency of the link that has not returned tokens recently
+					double latency = LM[l]->tokenLatency;
+					if(!LM[l]->tokenStamp.empty()) {
+						latency = max(latency, (double)(LM[l]->currentClockCycle - LM[l]->tokenStamp[0]));
+					}
+					//Expected latency of a new packet grows with the outstanding flits ahead of it
+					cost = (latency + 1) * (1 + cost/MAX_LINK_BUF);
+				}
+				if(minLink == -1 || (minRetry && !retry) || (minRetry == retry && cost < minCost)) {
+					minLink = l;
+					minRetry = retry;
+					minCost = cost;
+				}
+			}
+			return minLink;
+			break;
+		}
 	}
 	return -1;
 }
@@ -15,6 +15,7 @@
 //LinkMaster.h
 
 #include <vector>		//vector
+#include <deque>		//deque
 #include <math.h>		//pow()
 
 #include "SingleVectorObject.h"
@@ -34,7 +35,7 @@ enum LinkQuite
 	BUSY
 };
 	
-int FindAvailableLink(int &link, vector<LinkMaster *> &LM);
+int FindAvailableLink(int &link, vector<LinkMaster *> &LM, int vault=-1);
 	
 class LinkMaster : public SingleVectorObject<Packet>
 {
@@ -55,6 +56,7 @@ public:
 	void Update();
 	void CRCCountdown(int writeP, Packet *packet);
 	void UpdateField(int nextWriteP, Packet *packet);
+	void PromotePacket();
 	void QuitePacket();
 	void FinishRetrain();
 	void PrintState();
@@ -83,6 +85,10 @@ public:
 	unsigned retrainTransit;
 	bool firstNull;
 	vector<Packet *> retryBuffers;
+	
+	//Token round-trip time (LATENCY_AWARE link priority)
+	deque<uint64_t> tokenStamp;		//Receiving clock of each flit whose token is not returned yet
+	double tokenLatency;			//Moving average of token round-trip time
 };
 
 }
@@ -0,0 +1,108 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef LINKPIPE_H
+#define LINKPIPE_H
+
+//LinkPipe.h
+//
+//Cycle-stamped hand-off between the host thread and the cube thread (PIPELINE_SIM)
+// The producer stamps entries with its CPU clock and publishes the number of finished cycles.
+// The consumer takes entries of previous cycles only, so the simulation result does not depend on thread timing.
+//
+
+#include <stdint.h>		//uint64_t
+#include <atomic>		//atomic
+#include <thread>		//yield
+
+#include "ConfigValue.h"
+#include "Packet.h"
+#include "SPSCQueue.h"
+
+#define LINK_PIPE_SIZE	4096	//The number of entries in flight between the host and the cube
+
+using namespace std;
+
+namespace CasHMC
+{
+
+enum PipeEntryType
+{
+	PIPE_PACKET,		//Packet transmitted through a link
+	PIPE_TAG_SEGMENT,	//Tag reference of posted segment packets (TagPool::AddSegment)
+	PIPE_TAG_FREE,		//Tag of a completed posted request (TagPool::Free)
+	PIPE_TRACE			//Trace of a completed posted request (deleted by the host to update statistics)
+};
+
+class PipeEntry
+{
+public:
+	PipeEntry():cycle(0), type(PIPE_PACKET), index(0), value(0), packet(NULL), trace(NULL) {}
+
+	uint64_t cycle;		//[CPU clock] Producer cycle
+	PipeEntryType type;
+	unsigned index;		//Link ID or tag
+	unsigned value;		//The number of segments
+	Packet *packet;
+	TranTrace *trace;
+};
+
+class LinkPipe
+{
+public:
+	LinkPipe():entries(LINK_PIPE_SIZE), producerCycle(0) {
+		finished.store(0);
+	}
+	//Producer side
+	void Push(PipeEntryType type, unsigned index, unsigned value, Packet *packet, TranTrace *trace) {
+		PipeEntry entry;
+		entry.cycle = producerCycle;
+		entry.type = type;
+		entry.index = index;
+		entry.value = value;
+		entry.packet = packet;
+		entry.trace = trace;
+		while(!entries.Push(entry)) {
+			this_thread::yield();
+		}
+	}
+	void PushPacket(unsigned link, Packet *packet) {Push(PIPE_PACKET, link, 0, packet, NULL);}
+	void PushTagSegment(unsigned tag, unsigned segments) {Push(PIPE_TAG_SEGMENT, tag, segments, NULL, NULL);}
+	void PushTagFree(unsigned tag) {Push(PIPE_TAG_FREE, tag, 0, NULL, NULL);}
+	void PushTrace(TranTrace *trace) {Push(PIPE_TRACE, 0, 0, NULL, trace);}
+	void Finish(uint64_t cycles) {
+		finished.store(cycles, memory_order_release);
+	}
+
+	//Consumer side (false if stop is set while waiting)
+	bool Wait(uint64_t cycles, atomic<bool> &stop) {
+		for(unsigned spin=0; finished.load(memory_order_acquire) < cycles; spin++) {
+			if(stop.load(memory_order_relaxed))	return false;
+			if(spin >= 1000)	this_thread::yield();
+		}
+		return true;
+	}
+	//Entry stamped until the given cycle (NULL if there is no more entry)
+	PipeEntry *Front(uint64_t cycle) {
+		PipeEntry *entry = entries.Front();
+		if(entry == NULL || entry->cycle > cycle)	return NULL;
+		return entry;
+	}
+	void Pop() {entries.Pop();}
+
+	SPSCQueue<PipeEntry> entries;
+	uint64_t producerCycle;			//Written by the producer only
+	atomic<uint64_t> finished;		//The number of cycles finished by the producer
+};
+
+}
+
+#endif
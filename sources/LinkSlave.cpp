@@ -77,7 +77,7 @@ void LinkSlave::Update()
 			for(int i=0; i<linkRxTx.size(); i++) {
 				if(linkRxTx[i]->bufPopDelay == 0) {
 					//Link retraining sequence
-					if(linkRxTx[i]->CMD == NULL_) {
+					if(linkRxTx[i]->CMD() == NULL_) {
 						//[Responder descrambler initializing]
 						//The responder descrambler sync should occur within tRESP1 of the PLL locking
 						if(downstream && localLinkMaster->currentState == SLEEP) {
@@ -115,16 +115,16 @@ void LinkSlave::Update()
 					}
 					
 					//Retry control
-					if(linkRxTx[i]->CMD == IRTRY) {
+					if(linkRxTx[i]->CMD() == IRTRY) {
 						if(linkRxTx[i]->bufPopDelay == 0) {
 							linkRxTx[i]->chkRRP = true;
 							localLinkMaster->UpdateRetryPointer(linkRxTx[i]);
-							if(linkRxTx[i]->FRP == 1) {
+							if(linkRxTx[i]->FRP() == 1) {
 								if(localLinkMaster->currentState != LINK_RETRY) {
 									localLinkMaster->LinkRetry(linkRxTx[i]);
 								}
 							}
-							else if(linkRxTx[i]->FRP == 2) {
+							else if(linkRxTx[i]->FRP() == 2) {
 								if(localLinkMaster->currentState == START_RETRY
 								|| localLinkMaster->currentState == LINK_RETRY) {
 									localLinkMaster->FinishRetry();
@@ -149,7 +149,7 @@ void LinkSlave::Update()
 						localLinkMaster->UpdateRetryPointer(linkRxTx[i]);
 
 						//PRET packet is not saved in the retry buffer (No need to check CRC)
-						if(linkRxTx[i]->CMD == PRET) {
+						if(linkRxTx[i]->CMD() == PRET) {
 							delete linkRxTx[i];
 							linkRxTx.erase(linkRxTx.begin()+i);
 							break;
@@ -157,7 +157,7 @@ void LinkSlave::Update()
 					}
 					
 					//Link low power mode control
-					if(linkRxTx[i]->CMD == QUIET) {
+					if(linkRxTx[i]->CMD() == QUIET) {
 						//(upstream) all-way links are checked to enter sleep mode
 						if(localLinkMaster->currentState == WAIT) {
 							localLinkMaster->currentState = CONFIRM;
@@ -179,12 +179,12 @@ void LinkSlave::Update()
 					if(linkRxTx[i]->chkRRP == true && linkRxTx[i]->chkCRC == false) {
 						if(CRC_CHECK && !startCRC) {
 							startCRC = true;
-							countdownCRC = ceil((double)CRC_CAL_CYCLE * linkRxTx[i]->LNG);
+							countdownCRC = ceil((double)CRC_CAL_CYCLE * linkRxTx[i]->LNG());
 						}
 							
 						if(CRC_CHECK && countdownCRC > 0) {
 							DEBUG(ALI(18)<<header<<ALI(15)<<*linkRxTx[i]<<(downstream ? "Down) " : "Up)   ")
-									<<"WAITING CRC calculation ("<<countdownCRC<<"/"<<ceil((double)CRC_CAL_CYCLE*linkRxTx[i]->LNG)<<")");
+									<<"WAITING CRC calculation ("<<countdownCRC<<"/"<<ceil((double)CRC_CAL_CYCLE*linkRxTx[i]->LNG())<<")");
 						}
 						else {
 							//Error check
@@ -192,7 +192,7 @@ void LinkSlave::Update()
 							if(CheckNoError(linkRxTx[i])) {
 								localLinkMaster->ReturnRetryPointer(linkRxTx[i]);
 								localLinkMaster->UpdateToken(linkRxTx[i]);
-								if(linkRxTx[i]->CMD != TRET) {
+								if(linkRxTx[i]->CMD() != TRET) {
 									Receive(linkRxTx[i]);
 								}
 								else {
@@ -245,12 +245,17 @@ void LinkSlave::Update()
 
 	//Sending packet
 	if(Buffers.size() > 0) {
+		//Source link ID is inserted into the request packet by the link slave of the cube
+		if(downstream)	Buffers[0]->SetSLID(linkSlaveID);
 		bool chkRcv = (downstream ? downBufferDest->ReceiveDown(Buffers[0]) : upBufferDest->ReceiveUp(Buffers[0]));
 		if(chkRcv) {
+			if(downstream && Buffers[0]->trace != NULL) {
+				Buffers[0]->trace->StampHMC(STAGE_CROSSBAR, currentClockCycle);
+			}
 			localLinkMaster->ReturnTocken(Buffers[0]);
 			DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[0]<<(downstream ? "Down) " : "Up)   ")
 						<<"SENDING packet to "<<(downstream ? "crossbar switch (CS)" : "HMC controller (HC)"));
-			Buffers.erase(Buffers.begin(), Buffers.begin()+Buffers[0]->LNG);
+			Buffers.erase(Buffers.begin(), Buffers.begin()+Buffers[0]->LNG());
 		}
 		else {
 			//DEBUG(ALI(18)<<header<<ALI(15)<<*Buffers[0]<<"(downstream ? "Down) Crossbar switch" : "Up)   HMC controller")<<" buffer FULL");	
@@ -273,36 +278,36 @@ bool LinkSlave::CheckNoError(Packet *chkPacket)
 	unsigned tempSEQ = (slaveSEQ<7) ? slaveSEQ++ : 0;
 	if(CRC_CHECK) {
 		unsigned tempCRC = chkPacket->GetCRC();
-		if(chkPacket->CRC == tempCRC) {
-			if(chkPacket->SEQ == tempSEQ) {
+		if(chkPacket->CRC() == tempCRC) {
+			if(chkPacket->SEQ() == tempSEQ) {
 				DEBUG(ALI(18)<<header<<ALI(15)<<*chkPacket<<(downstream ? "Down) " : "Up)   ")
 							<<"CRC(0x"<<hex<<setw(9)<<setfill('0')<<tempCRC<<dec<<"), SEQ("<<tempSEQ<<") are checked (NO error)");
 				return true;
 			}
 			else {
 				DE_CR(ALI(18)<<header<<ALI(15)<<*chkPacket<<(downstream ? "Down) " : "Up)   ")
-							<<"= Error abort mode =  (packet SEQ : "<<chkPacket->SEQ<<" / Slave SEQ : "<<tempSEQ<<")");
+							<<"= Error abort mode =  (packet SEQ : "<<chkPacket->SEQ()<<" / Slave SEQ : "<<tempSEQ<<")");
 				cout<<ALI(18)<<header<<ALI(15)<<*chkPacket<<(downstream ? "Down) " : "Up)   ")
-							<<"= Error abort mode =  (packet SEQ : "<<chkPacket->SEQ<<" / Slave SEQ : "<<tempSEQ<<")"<<endl;
+							<<"= Error abort mode =  (packet SEQ : "<<chkPacket->SEQ()<<" / Slave SEQ : "<<tempSEQ<<")"<<endl;
 				return false;
 			}
 		}
 		else {
 			DE_CR(ALI(18)<<header<<ALI(15)<<*chkPacket<<(downstream ? "Down) " : "Up)   ")
-						<<"= Error abort mode =  (packet CRC : 0x"<<hex<<setw(9)<<setfill('0')<<chkPacket->CRC<<dec
+						<<"= Error abort mode =  (packet CRC : 0x"<<hex<<setw(9)<<setfill('0')<<chkPacket->CRC()<<dec
 						<<" / Slave CRC : 0x"<<hex<<setw(9)<<setfill('0')<<tempCRC<<dec<<")");
 			return false;
 		}
 	}
 	else {
-		if(chkPacket->SEQ == tempSEQ) {
+		if(chkPacket->SEQ() == tempSEQ) {
 			DEBUG(ALI(18)<<header<<ALI(15)<<*chkPacket<<(downstream ? "Down) " : "Up)   ")
 						<<"SEQ("<<tempSEQ<<") is checked (NO error)");
 			return true;
 		}
 		else {
 			DE_CR("    (LS_"<<linkSlaveID<<ALI(7)<<")"<<*chkPacket<<(downstream ? "Down) " : "Up)   ")
-						<<"= Error abort mode =  (packet SEQ : "<<chkPacket->SEQ<<" / Slave SEQ : "<<tempSEQ<<")");
+						<<"= Error abort mode =  (packet SEQ : "<<chkPacket->SEQ()<<" / Slave SEQ : "<<tempSEQ<<")");
 			return false;
 		}
 	}
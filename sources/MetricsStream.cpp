@@ -0,0 +1,171 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include <chrono>		//milliseconds
+
+#include "MetricsStream.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+MetricsStream::MetricsStream(string fileName, vector<string> &columnNames, bool csv, bool binary):
+	numColumns(columnNames.size()),
+	fillBlock(NULL),
+	fillRows(0),
+	fullBlocks(METRICS_BLOCKS),
+	freeBlocks(METRICS_BLOCKS)
+{
+	stopped.store(false);
+	for(int i=0; i<METRICS_BLOCKS; i++) {
+		freeBlocks.Push(new vector<double>(METRICS_BLOCK_ROWS*numColumns, 0));
+	}
+	columnBuf = vector<double>(METRICS_BLOCK_ROWS*numColumns, 0);
+
+	if(csv) {
+		string csvName = fileName + ".csv";
+		csvOut.open(csvName.c_str());
+		if(!csvOut.is_open()) {
+			ERROR(" == Error - Could not open metrics file ("<<csvName<<")");
+			exit(0);
+		}
+		for(int c=0; c<numColumns; c++) {
+			csvOut<<(c>0 ? "," : "")<<columnNames[c];
+		}
+		csvOut<<endl;
+		cout<<"  [ "<<csvName<<" ] is generated"<<endl;
+	}
+	if(binary) {
+		string binName = fileName + ".bin";
+		binOut.open(binName.c_str(), ios::out | ios::binary);
+		if(!binOut.is_open()) {
+			ERROR(" == Error - Could not open metrics file ("<<binName<<")");
+			exit(0);
+		}
+		uint32_t cols = numColumns;
+		binOut.write("CHMCMTR1", 8);
+		binOut.write((char *)&cols, sizeof(cols));
+		for(int c=0; c<numColumns; c++) {
+			uint32_t len = columnNames[c].size();
+			binOut.write((char *)&len, sizeof(len));
+			binOut.write(columnNames[c].data(), len);
+		}
+		cout<<"  [ "<<binName<<" ] is generated"<<endl;
+	}
+	writeThread = thread(&MetricsStream::WriteLoop, this);
+}
+
+MetricsStream::~MetricsStream()
+{
+	Flush();
+	stopped.store(true, memory_order_release);
+	writeThread.join();
+
+	vector<double> *block;
+	while(freeBlocks.Pop(block)) {
+		delete block;
+	}
+	csvOut.flush();		csvOut.close();
+	binOut.flush();		binOut.close();
+}
+
+//
+//Next sample row to be filled (numColumns values)
+//
+double *MetricsStream::Row()
+{
+	if(fillBlock == NULL) {
+		while(!freeBlocks.Pop(fillBlock)) {
+			this_thread::yield();
+		}
+		fillBlock->resize(METRICS_BLOCK_ROWS*numColumns);
+		fillRows = 0;
+	}
+	return &(*fillBlock)[fillRows*numColumns];
+}
+
+void MetricsStream::Commit()
+{
+	fillRows++;
+	if(fillRows == METRICS_BLOCK_ROWS) {
+		Flush();
+	}
+}
+
+//
+//Hand the filled rows over to the writer thread
+//
+void MetricsStream::Flush()
+{
+	if(fillBlock == NULL || fillRows == 0)	return;
+	fillBlock->resize(fillRows*numColumns);
+	while(!fullBlocks.Push(fillBlock)) {
+		this_thread::yield();
+	}
+	fillBlock = NULL;
+	fillRows = 0;
+}
+
+//
+//Write full blocks (writer thread)
+//
+void MetricsStream::WriteLoop()
+{
+	vector<double> *block;
+	while(true) {
+		if(fullBlocks.Pop(block)) {
+			WriteBlock(block);
+			freeBlocks.Push(block);
+		}
+		else if(stopped.load(memory_order_acquire)) {
+			//Blocks pushed before the stop flag are visible here
+			while(fullBlocks.Pop(block)) {
+				WriteBlock(block);
+				freeBlocks.Push(block);
+			}
+			break;
+		}
+		else {
+			//Blocks arrive every METRICS_BLOCK_ROWS samples, so the idle writer sleeps instead of spinning
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	}
+}
+
+void MetricsStream::WriteBlock(vector<double> *block)
+{
+	unsigned rows = block->size()/numColumns;
+	if(csvOut.is_open()) {
+		for(int r=0; r<rows; r++) {
+			double *row = &(*block)[r*numColumns];
+			for(int c=0; c<numColumns; c++) {
+				if(c > 0)	csvOut<<",";
+				//Counters and cycles are printed without exponent
+				if(row[c] == (double)(int64_t)row[c])	csvOut<<(int64_t)row[c];
+				else									csvOut<<row[c];
+			}
+			csvOut<<"\n";
+		}
+	}
+	if(binOut.is_open()) {
+		for(int r=0; r<rows; r++) {
+			for(int c=0; c<numColumns; c++) {
+				columnBuf[c*rows + r] = (*block)[r*numColumns + c];
+			}
+		}
+		uint32_t blockRows = rows;
+		binOut.write((char *)&blockRows, sizeof(blockRows));
+		binOut.write((char *)&columnBuf[0], rows*numColumns*sizeof(double));
+	}
+}
+
+}
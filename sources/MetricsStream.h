@@ -0,0 +1,75 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef METRICSSTREAM_H
+#define METRICSSTREAM_H
+
+//MetricsStream.h
+//
+//Buffered time-series writer of metrics samples (CSV and binary columnar files)
+// Samples are filled in blocks of METRICS_BLOCK_ROWS rows, and full blocks are formatted
+// and written by a writer thread, so the simulation thread never waits for file output.
+//
+//Binary columnar file layout (host byte order)
+// char[8] "CHMCMTR1", uint32 number of columns, (uint32 name length, name characters) per column,
+// and then blocks of (uint32 rows, rows x float64 values of column 0, column 1, ...)
+//
+
+#include <stdint.h>		//uint32_t
+#include <atomic>		//atomic
+#include <fstream>		//ofstream
+#include <string>		//string
+#include <thread>		//thread
+#include <vector>		//vector
+
+#include "ConfigValue.h"
+#include "SPSCQueue.h"
+
+#define METRICS_BLOCK_ROWS	256		//The number of samples handed to the writer thread at once
+#define METRICS_BLOCKS		8		//The number of blocks in flight (a power of two)
+
+using namespace std;
+
+namespace CasHMC
+{
+
+class MetricsStream
+{
+public:
+	//
+	//Functions
+	//
+	MetricsStream(string fileName, vector<string> &columnNames, bool csv, bool binary);
+	virtual ~MetricsStream();
+	double *Row();
+	void Commit();
+	void Flush();
+	void WriteLoop();
+	void WriteBlock(vector<double> *block);
+
+	//
+	//Fields
+	//
+	unsigned numColumns;
+	vector<double> *fillBlock;			//Block filled by the simulation thread (row-major)
+	unsigned fillRows;
+	vector<double> columnBuf;			//Column-major copy of a block (writer thread)
+	SPSCQueue<vector<double> *> fullBlocks;		//Simulation thread -> writer thread
+	SPSCQueue<vector<double> *> freeBlocks;		//Writer thread -> simulation thread
+	thread writeThread;
+	atomic<bool> stopped;
+	ofstream csvOut;
+	ofstream binOut;
+};
+
+}
+
+#endif
@@ -0,0 +1,242 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include "MultiChannel.h"
+#include "Profiler.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+HMCChannel::HMCChannel(unsigned id, string simCfg, string dramCfg):
+	channelID(id),
+	randSeed(CHANNEL_RAND_SEED * (id+1)),
+	occupancy(0),
+	issued(0),
+	completed(0)
+{
+	casHMCWrapper = new CasHMCWrapper(simCfg, dramCfg);
+	//Epoch progress is printed by the first channel
+	casHMCWrapper->printEpoch = (id == 0);
+	readCB = new Callback<HMCChannel, void, uint64_t, uint64_t>(this, &HMCChannel::ReadComplete);
+	writeCB = new Callback<HMCChannel, void, uint64_t, uint64_t>(this, &HMCChannel::WriteComplete);
+	casHMCWrapper->RegisterCallbacks(readCB, writeCB);
+}
+
+HMCChannel::~HMCChannel()
+{
+	casHMCWrapper->RegisterCallbacks(NULL, NULL);
+	delete casHMCWrapper;
+	delete readCB;
+	delete writeCB;
+}
+
+//
+//Simulate the channel until endCycle (channel thread)
+//
+void HMCChannel::RunQuantum(uint64_t endCycle)
+{
+	while(casHMCWrapper->currentClockCycle < endCycle) {
+		//One request is issued per cycle at most (the same as trace file mode)
+		if(!waiting.empty() && waiting.front().cycle <= casHMCWrapper->currentClockCycle && casHMCWrapper->CanAcceptTran()) {
+			ChannelRequest &req = waiting.front();
+			casHMCWrapper->ReceiveTran(req.tranType, req.addr, req.dataSize, NULL, req.priority);
+			waiting.pop_front();
+			issued++;
+		}
+		casHMCWrapper->Update();
+	}
+}
+
+void HMCChannel::ReadComplete(uint64_t addr, uint64_t cycle)
+{
+	outbox.push_back(ChannelCompletion(addr, cycle, false));
+	completed++;
+}
+
+void HMCChannel::WriteComplete(uint64_t addr, uint64_t cycle)
+{
+	outbox.push_back(ChannelCompletion(addr, cycle, true));
+	completed++;
+}
+
+MultiChannel::MultiChannel(unsigned chans, unsigned quantum, uint64_t interleave, string simCfg, string dramCfg):
+	numChannels(chans),
+	quantumCycles(quantum),
+	interleaveSize(interleave),
+	currentClockCycle(0),
+	syncClockCycle(0),
+	readCallback(NULL),
+	writeCallback(NULL),
+	startBarrier(chans),
+	endBarrier(chans),
+	quantumEnd(0),
+	stopThreads(false)
+{
+	if(numChannels < 1 || quantumCycles < 1) {
+		ERROR(" == Error - The number of channels ("<<numChannels<<") and quantum ("<<quantumCycles<<") should be at least 1");
+		exit(0);
+	}
+	if(interleaveSize < 16 || (interleaveSize & (interleaveSize-1)) != 0) {
+		ERROR(" == Error - Channel interleaving size ("<<interleaveSize<<") should be a power of two (16 byte at least)");
+		exit(0);
+	}
+
+	//Channels are made one by one, because configuration values and log names are global
+	for(unsigned c=0; c<numChannels; c++) {
+		channels.push_back(new HMCChannel(c, simCfg, dramCfg));
+	}
+	for(unsigned c=1; c<numChannels; c++) {
+		channelThreads.push_back(thread(&MultiChannel::ChannelLoop, this, c));
+	}
+	startWallNs = ReadWallNs();
+}
+
+MultiChannel::~MultiChannel()
+{
+	//Simulate the last partial quantum
+	if(currentClockCycle > syncClockCycle)	Synchronize();
+
+	stopThreads = true;
+	startBarrier.Wait();
+	for(unsigned t=0; t<channelThreads.size(); t++) {
+		channelThreads[t].join();
+	}
+	for(unsigned c=0; c<numChannels; c++) {
+		delete channels[c];
+	}
+	channels.clear();
+}
+
+void MultiChannel::RegisterCallbacks(TransCompCB *readCB, TransCompCB *writeCB)
+{
+	readCallback = readCB;
+	writeCallback = writeCB;
+}
+
+//
+//Host address interleaving over channels
+//
+unsigned MultiChannel::Channel(uint64_t addr)
+{
+	return (addr / interleaveSize) % numChannels;
+}
+
+uint64_t MultiChannel::LocalAddress(uint64_t addr)
+{
+	return (addr / (interleaveSize*numChannels))*interleaveSize + addr % interleaveSize;
+}
+
+uint64_t MultiChannel::GlobalAddress(unsigned channel, uint64_t localAddr)
+{
+	return (localAddr / interleaveSize)*interleaveSize*numChannels + channel*interleaveSize + localAddr % interleaveSize;
+}
+
+//
+//Receive a request at the current host cycle (false if the request buffer of the channel is full)
+//
+bool MultiChannel::ReceiveTran(TransactionType tranType, uint64_t addr, unsigned size, unsigned priority)
+{
+	HMCChannel *chan = channels[Channel(addr)];
+	if(chan->occupancy >= (unsigned)MAX_REQ_BUF)	return false;
+	chan->inbox.push_back(ChannelRequest(currentClockCycle, LocalAddress(addr), tranType, size, priority));
+	chan->occupancy++;
+	return true;
+}
+
+//
+//Advance the host one cycle (channels are simulated at every quantum boundary)
+//
+void MultiChannel::Update()
+{
+	currentClockCycle++;
+	if(currentClockCycle - syncClockCycle >= quantumCycles) {
+		Synchronize();
+	}
+}
+
+//
+//Simulate every channel up to the host cycle in parallel, and then exchange requests and completions
+//
+void MultiChannel::Synchronize()
+{
+	for(unsigned c=0; c<numChannels; c++) {
+		HMCChannel *chan = channels[c];
+		chan->waiting.insert(chan->waiting.end(), chan->inbox.begin(), chan->inbox.end());
+		chan->inbox.clear();
+	}
+
+	quantumEnd = currentClockCycle;
+	startBarrier.Wait();
+	//The first channel runs on the host thread, and the host keeps its own random sequence
+	unsigned *hostRandSeed = simRandSeed;
+	simRandSeed = &channels[0]->randSeed;
+	channels[0]->RunQuantum(quantumEnd);
+	simRandSeed = hostRandSeed;
+	endBarrier.Wait();
+	syncClockCycle = currentClockCycle;
+
+	//Completions are delivered at the quantum boundary (up to a quantum later than the completion cycle)
+	for(unsigned c=0; c<numChannels; c++) {
+		HMCChannel *chan = channels[c];
+		for(unsigned i=0; i<chan->outbox.size(); i++) {
+			ChannelCompletion &comp = chan->outbox[i];
+			TransCompCB *cb = comp.isWrite ? writeCallback : readCallback;
+			if(cb != NULL)	(*cb)(GlobalAddress(c, comp.addr), comp.cycle);
+		}
+		chan->outbox.clear();
+		chan->occupancy = chan->waiting.size();
+	}
+}
+
+//
+//Channel thread loop (one quantum per start barrier)
+//
+void MultiChannel::ChannelLoop(unsigned channel)
+{
+	simRandSeed = &channels[channel]->randSeed;
+	while(true) {
+		startBarrier.Wait();
+		if(stopThreads)	return;
+		channels[channel]->RunQuantum(quantumEnd);
+		endBarrier.Wait();
+	}
+}
+
+//
+//Print the summary of channels (each channel writes its own result log)
+//
+void MultiChannel::PrintStatistic(ostream &out)
+{
+	double elapsedTime = (double)(syncClockCycle*CPU_CLK_PERIOD*1E-9);
+	double wallTime = (ReadWallNs() - startWallNs)*1E-9;
+	uint64_t totalIssued = 0;
+	uint64_t totalCompleted = 0;
+	double totalBandwidth = 0;
+	out<<endl<<"  ============= Multi-channel statistic ============="<<endl;
+	out<<"  Channels : "<<numChannels<<"  (quantum : "<<quantumCycles<<" clk, interleaving : "<<interleaveSize<<" byte)"<<endl;
+	for(unsigned c=0; c<numChannels; c++) {
+		CasHMCWrapper *w = channels[c]->casHMCWrapper;
+		uint64_t tranCount = w->totalTranCount + w->tranFullLat.size();
+		uint64_t latencySum = w->totalTranFullSum + w->tranFullSum;
+		double bandwidth = (elapsedTime==0 ? 0 : (w->totalHmcTransmitSize + w->hmcTransmitSize)/elapsedTime/(1<<30));
+		out<<"    Channel "<<c<<" ["<<w->logName<<"] issued : "<<channels[c]->issued<<"  completed : "<<channels[c]->completed
+			<<"  bandwidth : "<<bandwidth<<" GB/s  mean latency : "<<(tranCount==0 ? 0 : (double)latencySum/tranCount*CPU_CLK_PERIOD)<<" ns"<<endl;
+		totalIssued += channels[c]->issued;
+		totalCompleted += channels[c]->completed;
+		totalBandwidth += bandwidth;
+	}
+	out<<"  Total issued : "<<totalIssued<<"  completed : "<<totalCompleted<<"  bandwidth : "<<totalBandwidth<<" GB/s"<<endl;
+	out<<"  Simulation speed : "<<(wallTime==0 ? 0 : syncClockCycle*numChannels/wallTime)<<" channel clk/s  ("<<wallTime<<" s)"<<endl<<endl;
+}
+
+}
@@ -0,0 +1,159 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef MULTICHANNEL_H
+#define MULTICHANNEL_H
+
+//MultiChannel.h
+//
+//Multi-channel driver (independent HMC channels are simulated on separate threads in lockstep quanta)
+// Requests and completions are exchanged between the host and the channels only at quantum boundaries.
+//
+
+#include <stdint.h>		//uint64_t
+#include <atomic>		//atomic
+#include <deque>		//deque
+#include <iostream>		//ostream
+#include <thread>		//thread
+#include <vector>		//vector
+
+#include "ConfigValue.h"
+#include "CallBack.h"
+#include "CasHMCWrapper.h"
+#include "Transaction.h"
+
+#define CHANNEL_RAND_SEED	0x9E3779B9	//Base seed of SimRand in channels (each channel gets base * (channel ID + 1))
+
+using namespace std;
+
+namespace CasHMC
+{
+
+//Generation counting barrier of channel threads (spins and then yields)
+class SpinBarrier
+{
+public:
+	SpinBarrier(unsigned n):threads(n) {
+		count.store(0);
+		generation.store(0);
+	}
+	void Wait() {
+		unsigned gen = generation.load(memory_order_acquire);
+		if(count.fetch_add(1, memory_order_acq_rel) + 1 == threads) {
+			count.store(0, memory_order_relaxed);
+			generation.store(gen + 1, memory_order_release);
+		}
+		else {
+			for(unsigned spin=0; generation.load(memory_order_acquire) == gen; spin++) {
+				if(spin >= 1000)	this_thread::yield();
+			}
+		}
+	}
+
+	unsigned threads;
+	atomic<unsigned> count;
+	atomic<unsigned> generation;
+};
+
+//Request handed from the host to a channel (stamped with the host cycle)
+class ChannelRequest
+{
+public:
+	ChannelRequest(uint64_t cyc, uint64_t a, TransactionType type, unsigned size, unsigned prio):
+		cycle(cyc), addr(a), tranType(type), dataSize(size), priority(prio) {}
+
+	uint64_t cycle;
+	uint64_t addr;		//Channel-local address
+	TransactionType tranType;
+	unsigned dataSize;
+	unsigned priority;
+};
+
+//Completion handed from a channel to the host
+class ChannelCompletion
+{
+public:
+	ChannelCompletion(uint64_t a, uint64_t cyc, bool write):addr(a), cycle(cyc), isWrite(write) {}
+
+	uint64_t addr;		//Channel-local address
+	uint64_t cycle;
+	bool isWrite;
+};
+
+class HMCChannel
+{
+public:
+	//
+	//Functions
+	//
+	HMCChannel(unsigned id, string simCfg, string dramCfg);
+	virtual ~HMCChannel();
+	void RunQuantum(uint64_t endCycle);
+	void ReadComplete(uint64_t addr, uint64_t cycle);
+	void WriteComplete(uint64_t addr, uint64_t cycle);
+
+	//
+	//Fields
+	//
+	unsigned channelID;
+	unsigned randSeed;						//SimRand sequence of the channel (independent of thread interleaving)
+	CasHMCWrapper *casHMCWrapper;
+	TransCompCB *readCB;
+	TransCompCB *writeCB;
+	vector<ChannelRequest> inbox;			//Written by the host during a quantum
+	deque<ChannelRequest> waiting;			//Requests not accepted by the HMC controller yet
+	vector<ChannelCompletion> outbox;		//Written by the channel thread during a quantum
+	unsigned occupancy;						//Host view of the channel request buffer (updated at quantum boundaries)
+	uint64_t issued;
+	uint64_t completed;
+};
+
+class MultiChannel
+{
+public:
+	//
+	//Functions
+	//
+	MultiChannel(unsigned channels, unsigned quantum, uint64_t interleave, string simCfg, string dramCfg);
+	virtual ~MultiChannel();
+	void RegisterCallbacks(TransCompCB *readCB, TransCompCB *writeCB);
+	unsigned Channel(uint64_t addr);
+	uint64_t LocalAddress(uint64_t addr);
+	uint64_t GlobalAddress(unsigned channel, uint64_t localAddr);
+	bool ReceiveTran(TransactionType tranType, uint64_t addr, unsigned size, unsigned priority=0);
+	void Update();
+	void Synchronize();
+	void ChannelLoop(unsigned channel);
+	void PrintStatistic(ostream &out);
+
+	//
+	//Fields
+	//
+	vector<HMCChannel *> channels;
+	unsigned numChannels;
+	unsigned quantumCycles;
+	uint64_t interleaveSize;			//[byte] Host address interleaving granularity
+	uint64_t currentClockCycle;			//Host cycle
+	uint64_t syncClockCycle;			//Cycle that every channel reached at the last quantum boundary
+	TransCompCB *readCallback;
+	TransCompCB *writeCallback;
+
+	vector<thread> channelThreads;		//Channel 0 is simulated by the host thread
+	SpinBarrier startBarrier;
+	SpinBarrier endBarrier;
+	uint64_t quantumEnd;
+	bool stopThreads;
+	uint64_t startWallNs;
+};
+
+}
+
+#endif
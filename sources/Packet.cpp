@@ -13,102 +13,85 @@
 
 using namespace std;
 
-extern unsigned packetGlobalTAG;
-
 namespace CasHMC
 {
 
+//
+//Remainder table divided by polynomial (CRC-32K), made once and shared by all packets
+//
+class CRCTable
+{
+public:
+	CRCTable() {
+		uint32_t k;
+		for(int i=0; i<256; ++i){
+			k = i;
+			for(int j=0; j<8; ++j){
+				if(k&1)	k = (k >> 1) ^ 0xEB31D82E;
+				else	k >>= 1;
+			}
+			entry[i] = k;
+		}
+	}
+	uint32_t entry[256];
+};
+static const CRCTable crcTable;
+
 //Request packet
 Packet::Packet(PacketType packet, PacketCommandType cmd, uint64_t addr, unsigned cub, unsigned lng, TranTrace *lat):
 	trace(lat),
-	packetType(packet),
-	CUB(cub),
-	LNG(lng),
-	CMD(cmd),
-	ADRS(addr)
+	packetType(packet)
 {
 	bufPopDelay=1;
-	CRCtable[256]=0;	
-	Pb=0;
-	CRC=0; RTC=0; SLID=0;
-	SEQ=0; FRP=0; RRP=0;
-	AF=0; ERRSTAT=0; DINV=0;
 	chkCRC = false;
 	chkRRP = false;
 	segment = false;
 	reqDataSize=16;	//The minimum size is 16-Byte
+	payload = NULL;
+	priority = 0;
+	bypassed = 0;
+	returnTokens = 0;
+	respADRS = 0;
 	
-	if(packet != FLOW) {
-		TAG = (packetGlobalTAG++)%2048;
-	}
-	else {
-		TAG = 0;
-	}
-	
-	ADRS = (ADRS<<30)>>30;	//Address length is 34 bits
-	
-	if(CRC_CHECK) {
-		if(LNG>1) {
-			DATA = new uint64_t[(LNG-1)*2];
-			uint64_t tempData;
-			for(int i=0; i<(LNG-1)*2; i++) {
-				tempData = rand();
-				tempData = (tempData<<32)|rand();
-				DATA[i] = tempData;
-			}
-		}
-		else {
-			DATA = NULL;
-		}
-		MakeCRCtable(CRCtable, 0xEB31D82E);
-	}
-	else {
-		DATA = NULL;
-	}
+	AllocWords(CRC_CHECK ? lng*2 : 2);
+	words[0] = 0;
+	words[numWords-1] = 0;
+	SetCUB(cub);
+	SetLNG(lng);
+	SetCMD(cmd);
+	SetADRS(addr);	//Address length is 34 bits
+	//Request tag is allocated from the tag pool of HMC controller
+	FillData();
 }
 //Response packet
 Packet::Packet(PacketType packet, PacketCommandType cmd, unsigned tag, unsigned lng, TranTrace *lat):
 	trace(lat),
-	packetType(packet),
-	TAG(tag),
-	LNG(lng),
-	CMD(cmd)
+	packetType(packet)
 {
 	bufPopDelay=1;
-	CRCtable[256]=0;	
-	CUB=0; Pb=0;
-	CRC=0; RTC=0; SLID=0;
-	SEQ=0; FRP=0; RRP=0;
-	AF=0; ERRSTAT=0; DINV=0;
 	chkCRC = false;
 	chkRRP = false;
 	segment = false;
 	reqDataSize=16;	//The minimum size is 16-Byte
+	payload = NULL;
+	priority = 0;
+	bypassed = 0;
+	returnTokens = 0;
+	respADRS = 0;
 	
-	if(CRC_CHECK) {
-		if(LNG>1) {
-			DATA = new uint64_t[(LNG-1)*2];
-			uint64_t tempData;
-			for(int i=0; i<(LNG-1)*2; i++) {
-				tempData = rand();
-				tempData = (tempData<<32)|rand();
-				DATA[i] = tempData;
-			}
-		}
-		else {
-			DATA = NULL;
-		}
-		MakeCRCtable(CRCtable, 0xEB31D82E);
-	}
-	else {
-		DATA = NULL;
-	}
+	AllocWords(CRC_CHECK ? lng*2 : 2);
+	words[0] = 0;
+	words[numWords-1] = 0;
+	SetTAG(tag);
+	SetLNG(lng);
+	SetCMD(cmd);
+	FillData();
 }
 
 Packet::~Packet()
 {
-	if(DATA != NULL) {
-		delete[] DATA;
+	if(words != inlineWords) {
+		delete[] words;
 	}
 }
 
@@ -121,139 +104,100 @@ Packet::Packet(const Packet &f)
 	chkRRP = f.chkRRP;
 	segment = f.segment;
 	reqDataSize = f.reqDataSize;
+	payload = f.payload;
+	priority = f.priority;
+	bypassed = f.bypassed;
+	returnTokens = f.returnTokens;
+	respADRS = f.respADRS;
 	
-	CUB = f.CUB;	TAG = f.TAG;
-	LNG = f.LNG;	CMD = f.CMD;
-	
-	CRC = f.CRC;	RTC = f.RTC;
-	SLID = f.SLID;	SEQ = f.SEQ;
-	FRP = f.FRP;	RRP = f.RRP;
-	
-	ADRS = f.ADRS;	Pb = f.Pb;
-	
-	AF = f.AF;		ERRSTAT = f.ERRSTAT;
-	DINV = f.DINV;
-	
-	if(CRC_CHECK) {
-		if(LNG>1) {
-			DATA = new uint64_t[(LNG-1)*2];
-			uint64_t tempData;
-			for(int i=0; i<(LNG-1)*2; i++) {
-				tempData = rand();
-				tempData = (tempData<<32)|rand();
-				DATA[i] = tempData;
-			}
-		}
-		else {
-			DATA = NULL;
-		}
-		MakeCRCtable(CRCtable, 0xEB31D82E);
-	}
-	else {
-		DATA = NULL;
-	}
+	AllocWords(f.numWords);
+	memcpy(words, f.words, numWords*sizeof(uint64_t));
 }
 
 //
-//Set Packet data included header, data, and tail for CRC generation
+//Point words at inline storage or allocate them
 //
-unsigned long Packet::GetCRC()
+void Packet::AllocWords(unsigned num)
 {
-	uint64_t packetData[LNG*2];
+	numWords = num;
+	words = (numWords <= PACKET_INLINE_FLITS*2) ? inlineWords : new uint64_t[numWords];
+}
 
-	if(packetType == REQUEST) {
-		packetData[0] <<= 3;	packetData[0] |= (CUB&0x7);
-		packetData[0] <<= 3;	packetData[0] |= (RES&0x7);
-		packetData[0] <<= 34;	packetData[0] |= (ADRS&0x3FFFFFFFF);
-		packetData[0] <<= 1;	packetData[0] |= (RES&0x1);
-		packetData[0] <<= 11;	packetData[0] |= (TAG&0x7FF);
-		packetData[0] <<= 5;	packetData[0] |= (LNG&0x1F);
-		packetData[0] <<= 7;	packetData[0] |= (CMD&0x7F);
-	}
-	else {
-		packetData[0] <<= 3;	packetData[0] |= (CUB&0x7);
-		packetData[0] <<= 19;	packetData[0] |= (RES&0x7FFFF);
-		packetData[0] <<= 3;	packetData[0] |= (SLID&0x7);
-		packetData[0] <<= 5;	packetData[0] |= (RES&0x1F);
-		packetData[0] <<= 1;	packetData[0] |= (AF&0x1);
-		packetData[0] <<= 10;	packetData[0] |= (RES&0x3FF);
-		packetData[0] <<= 11;	packetData[0] |= (TAG&0x7FF);
-		packetData[0] <<= 5;	packetData[0] |= (LNG&0x1F);
-		packetData[0] <<= 7;	packetData[0] |= (CMD&0x7F);
-	}
-	
-	for(int i=1; i<=(LNG-1)*2; i++){
-		packetData[i]=DATA[i-1];
-	}
-	
-	if(packetType == REQUEST) {
-		packetData[LNG*2-1] <<= 32;		packetData[LNG*2-1] |= (0&0xFFFFFFFF);	//CRC initial value is '0' before CRC calculation
-		packetData[LNG*2-1] <<= 3;		packetData[LNG*2-1] |= (RTC&0x7);
-		packetData[LNG*2-1] <<= 3;		packetData[LNG*2-1] |= (SLID&0x7);
-		packetData[LNG*2-1] <<= 4;		packetData[LNG*2-1] |= (RES&0xF);
-		packetData[LNG*2-1] <<= 1;		packetData[LNG*2-1] |= (Pb&0x1);
-		packetData[LNG*2-1] <<= 3;		packetData[LNG*2-1] |= (SEQ&0x7);
-		packetData[LNG*2-1] <<= 9;		packetData[LNG*2-1] |= (FRP&0x1FF);
-		packetData[LNG*2-1] <<= 9;		packetData[LNG*2-1] |= (RRP&0x1FF);
-	}
-	else {
-		packetData[LNG*2-1] <<= 32;		packetData[LNG*2-1] |= (0&0xFFFFFFFF);	//CRC initial value is '0' before CRC calculation
-		packetData[LNG*2-1] <<= 3;		packetData[LNG*2-1] |= (RTC&0x7);
-		packetData[LNG*2-1] <<= 7;		packetData[LNG*2-1] |= (ERRSTAT&0x7F);
-		packetData[LNG*2-1] <<= 1;		packetData[LNG*2-1] |= (DINV&0x1);
-		packetData[LNG*2-1] <<= 3;		packetData[LNG*2-1] |= (SEQ&0x7);
-		packetData[LNG*2-1] <<= 9;		packetData[LNG*2-1] |= (FRP&0x1FF);
-		packetData[LNG*2-1] <<= 9;		packetData[LNG*2-1] |= (RRP&0x1FF);
-	}
-	
-	unsigned char buf[8];
-	uint32_t crc = 0;
-	
-	for(int j=0; j<LNG*2; j++){
-		for(int i=0; i<8; i++){
-			buf[i] = packetData[j];
-			packetData[j] >>= 8;
-		}
-		crc = CalcCRC(buf, 8, crc, CRCtable);
+//
+//Random data words for CRC generation
+//
+void Packet::FillData()
+{
+	uint64_t tempData;
+	for(int i=1; i<numWords-1; i++) {
+		tempData = SimRand();
+		tempData = (tempData<<32)|SimRand();
+		words[i] = tempData;
 	}
-	return crc;
 }
 
 //
-//Makes remainder table diveded by polynomial (CRC-32K)
+//Packet length is changed by dividing or combining segment packets (data words are resized with CRC_CHECK)
 //
-void Packet::MakeCRCtable(uint32_t *table, uint32_t id) 
+void Packet::SetLNG(unsigned lng)
 {
-	uint32_t k;
-	for(int i=0; i<256; ++i){
-		k = i;
-		for(int j=0; j<8; ++j){
-			if(k&1)	k = (k >> 1) ^ id;
-			else	k >>= 1;
-		}
-		table[i] = k;
+	SetBits(Header(), 7, 5, lng);
+	if(!CRC_CHECK || lng*2 == numWords)	return;
+	
+	uint64_t *oldWords = words;
+	unsigned oldNum = numWords;
+	AllocWords(lng*2);
+	if(words == oldWords) {
+		//Both sizes are inline (the header stays in place)
+		words[numWords-1] = oldWords[oldNum-1];
+		for(int i=oldNum-1; i<numWords-1; i++)	words[i] = 0;
+		return;
+	}
+	unsigned keep = min(oldNum, numWords) - 1;
+	memcpy(words, oldWords, keep*sizeof(uint64_t));
+	for(int i=keep; i<numWords-1; i++)	words[i] = 0;
+	words[numWords-1] = oldWords[oldNum-1];
+	if(oldWords != inlineWords) {
+		delete[] oldWords;
 	}
 }
-	
+
 //
-//Calculates CRC value
+//Calculates CRC over the stored header, data, and tail words
+//  The wire is little-endian in each word, and CRC field is '0' before CRC calculation.
 //
-uint32_t Packet::CalcCRC(const unsigned char *mem, signed int size, uint32_t crc, uint32_t *table)
+uint32_t Packet::GetCRC()
 {
-	crc = ~crc;
-	while(size--){
-		crc = table[(crc ^ *(mem++)) & 0xFF] ^ (crc >> 8);
+	const uint32_t *table = crcTable.entry;
+	uint32_t crc = ~0U;
+	uint64_t tail = Tail() & 0xFFFFFFFF;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	const unsigned char *mem = (const unsigned char *)words;
+	for(int i=0; i<(numWords-1)*8; i++) {
+		crc = table[(crc ^ mem[i]) & 0xFF] ^ (crc >> 8);
+	}
+#else
+	for(int j=0; j<numWords-1; j++) {
+		for(int i=0; i<8; i++) {
+			crc = table[(crc ^ (words[j] >> (i*8))) & 0xFF] ^ (crc >> 8);
+		}
+	}
+#endif
+	for(int i=0; i<8; i++) {
+		crc = table[(crc ^ (tail >> (i*8))) & 0xFF] ^ (crc >> 8);
 	}
 	return ~crc;
 }
 
 //
-//Reduction packetGlobalTAG
+//Posted request does not have a response packet
 //
-void Packet::ReductGlobalTAG()
+bool Packet::IsPosted()
 {
-	packetGlobalTAG--;
-}	
+	PacketCommandType cmd = CMD();
+	return ((cmd >= P_WR16 && cmd <= P_WR128) || cmd == P_WR256 || cmd == P_2ADD8
+			|| cmd == P_ADD16 || cmd == P_INC8 || cmd == P_BWR);
+}
 	
 //
 //Defines "<<" operation for printing
@@ -262,9 +206,9 @@ ostream& operator<<(ostream &out, const Packet &f)
 {
 	string header;
 	stringstream id;
-	id << f.TAG;
+	id << f.TAG();
 	
-	switch(f.CMD) {
+	switch(f.CMD()) {
 		//Request commands
 		case WR16:	header = "[P" + id.str() + "-WR16]";	break;		case WR32:	header = "[P" + id.str() + "-WR32]";	break;
 		case WR48:	header = "[P" + id.str() + "-WR48]";	break;		case WR64:	header = "[P" + id.str() + "-WR64]";	break;
@@ -298,11 +242,11 @@ ostream& operator<<(ostream &out, const Packet &f)
 		//Flow Commands
 		case NULL_:		header = "[P" + id.str() + "-NULL]";		break;		case PRET:		header = "[P" + id.str() + "-PRET]";		break;
 		case TRET:		header = "[P" + id.str() + "-TRET]";		break;
-		case IRTRY:		if(f.FRP==1)		header = "[P" + id.str() + "-IRTRY1]";
-						else if(f.FRP==2)	header = "[P" + id.str() + "-IRTRY2]";
+		case IRTRY:		if(f.FRP()==1)		header = "[P" + id.str() + "-IRTRY1]";
+						else if(f.FRP()==2)	header = "[P" + id.str() + "-IRTRY2]";
 						else				header = "[P" + id.str() + "-IRTRY]";	break;
-		case QUIET:		if(f.FRP==1)		header = "[P" + id.str() + "-QUIET1]";
-						else if(f.FRP==2)	header = "[P" + id.str() + "-QUIET2]";						
+		case QUIET:		if(f.FRP()==1)		header = "[P" + id.str() + "-QUIET1]";
+						else if(f.FRP()==2)	header = "[P" + id.str() + "-QUIET2]";						
 						else				header = "[P" + id.str() + "-QUIET]";	break;
 		//Respond commands
 		case RD_RS:		header = "[P" + id.str() + "-RD_RS]";		break;		case WR_RS:		header = "[P" + id.str() + "-WR_RS]";		break;
@@ -310,7 +254,7 @@ ostream& operator<<(ostream &out, const Packet &f)
 		case ERROR:		header = "[P" + id.str() + "-ERROR]";		break;
 		default:
 			ERROR(" (FL) == Error - Trying to print unknown kind of Packet CMD type");
-			ERROR("         F-"<<f.TAG<<" [?"<<f.CMD<<"?] [TAG:"<<f.TAG<<"] [SEQ:"<<f.SEQ<<"] [LNG:"<<f.LNG<<"]");
+			ERROR("         F-"<<f.TAG()<<" [?"<<f.CMD()<<"?] [TAG:"<<f.TAG()<<"] [SEQ:"<<f.SEQ()<<"] [LNG:"<<f.LNG()<<"]");
 			exit(0);
 	}
 	out<<header;
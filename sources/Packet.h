@@ -13,17 +13,26 @@
 #define PACKET_H
 
 //Packet.h
+//
+//Packet stored in the HMC wire format (header and tail words in their link layout)
+//  Request header  : CUB[63:61] RES[60:58] ADRS[57:24] RES[23] TAG[22:12] LNG[11:7] CMD[6:0]
+//  Response header : CUB[63:61] RES[60:42] SLID[41:39] RES[38:34] AF[33] RES[32:23] TAG[22:12] LNG[11:7] CMD[6:0]
+//  Request tail    : CRC[63:32] RTC[31:29] SLID[28:26] RES[25:22] Pb[21] SEQ[20:18] FRP[17:9] RRP[8:0]
+//  Response tail   : CRC[63:32] RTC[31:29] ERRSTAT[28:22] DINV[21] SEQ[20:18] FRP[17:9] RRP[8:0]
+// Flow packets use the response layout.
+//
 
 #include <stdint.h>		//uint64_t
 #include <stdlib.h>		//exit(0)
 #include <iomanip>		//setw()
 #include <iostream> 	//ostream
 #include <sstream>		//stringstream
+#include <string.h>		//memcpy
 
 #include "ConfigValue.h"
 #include "TranTrace.h"
 
-#define RES 0
+#define PACKET_INLINE_FLITS	5		//Packets up to 5 flits (64-byte data) hold their words inline
 
 using namespace std;
 
@@ -63,37 +72,81 @@ public:
 	Packet(PacketType packet, PacketCommandType cmd, unsigned tag, unsigned lng, TranTrace *lat);				//Response Packet
 	virtual ~Packet();
 	Packet(const Packet &f);
-	unsigned long GetCRC();
-	void MakeCRCtable(uint32_t *table, uint32_t id);
-	uint32_t CalcCRC(const unsigned char *mem, signed int size, uint32_t crc, uint32_t *table);
-	void ReductGlobalTAG();
+	uint32_t GetCRC();
+	bool IsPosted();
+	
+	//Header and tail fields extracted from the wire layout
+	unsigned CUB() const		{return GetBits(Header(), 61, 3);}
+	unsigned TAG() const		{return GetBits(Header(), 12, 11);}
+	unsigned LNG() const		{return GetBits(Header(), 7, 5);}
+	PacketCommandType CMD() const	{return (PacketCommandType)GetBits(Header(), 0, 7);}
+	unsigned CRC() const		{return GetBits(Tail(), 32, 32);}
+	unsigned RTC() const		{return returnTokens;}
+	unsigned SLID() const		{return (packetType == REQUEST) ? GetBits(Tail(), 26, 3) : GetBits(Header(), 39, 3);}
+	unsigned SEQ() const		{return GetBits(Tail(), 18, 3);}
+	unsigned FRP() const		{return GetBits(Tail(), 9, 9);}
+	unsigned RRP() const		{return GetBits(Tail(), 0, 9);}
+	uint64_t ADRS() const		{return (packetType == REQUEST) ? GetBits(Header(), 24, 34) : respADRS;}
+	unsigned Pb() const			{return (packetType == REQUEST) ? GetBits(Tail(), 21, 1) : 0;}
+	unsigned AF() const			{return (packetType == REQUEST) ? 0 : GetBits(Header(), 33, 1);}
+	unsigned ERRSTAT() const	{return (packetType == REQUEST) ? 0 : GetBits(Tail(), 22, 7);}
+	unsigned DINV() const		{return (packetType == REQUEST) ? 0 : GetBits(Tail(), 21, 1);}
+	
+	void SetCUB(unsigned cub)	{SetBits(Header(), 61, 3, cub);}
+	void SetTAG(unsigned tag)	{SetBits(Header(), 12, 11, tag);}
+	void SetLNG(unsigned lng);
+	void SetCMD(PacketCommandType cmd)	{SetBits(Header(), 0, 7, cmd);}
+	void SetCRC(unsigned crc)	{SetBits(Tail(), 32, 32, crc);}
+	void SetRTC(unsigned rtc)	{returnTokens = rtc;	SetBits(Tail(), 29, 3, rtc);}
+	void SetSLID(unsigned slid)	{if(packetType == REQUEST)	SetBits(Tail(), 26, 3, slid);	else SetBits(Header(), 39, 3, slid);}
+	void SetSEQ(unsigned seq)	{SetBits(Tail(), 18, 3, seq);}
+	void SetFRP(unsigned frp)	{SetBits(Tail(), 9, 9, frp);}
+	void SetRRP(unsigned rrp)	{SetBits(Tail(), 0, 9, rrp);}
+	void SetADRS(uint64_t adrs)	{if(packetType == REQUEST)	SetBits(Header(), 24, 34, adrs);	else respADRS = adrs;}
+	void SetAF(unsigned af)		{if(packetType != REQUEST)	SetBits(Header(), 33, 1, af);}
 	
 	//Fields
 	TranTrace *trace;
 	PacketType packetType;	//Type of transaction (defined above)
 	int bufPopDelay;
-	uint64_t *DATA;
-	uint32_t CRCtable[256];
+	uint8_t *payload;	//Host data passed by reference (not owned, used only with FUNCTIONAL_MEM)
 	bool chkCRC;
 	bool chkRRP;
 	bool segment;
 	unsigned reqDataSize;
+	unsigned priority;		//QoS class of the request (carried into DRAM commands and response packet)
+	unsigned bypassed;		//The number of times bypassed by higher-priority packets
 	
-	//Packet Common Fields
-	unsigned CUB, TAG, LNG;
-	PacketCommandType CMD;
+	//Wire words of the packet (header, data, and tail in 64-bit words)
+	// Data words are held only with CRC_CHECK (as many as (LNG-1)*2), so that CRC is calculated over the stored words.
+	// Small packets keep the words in inlineWords, and bigger ones are allocated on the heap.
+	uint64_t *words;
+	unsigned numWords;
+	uint64_t inlineWords[PACKET_INLINE_FLITS*2];
 	
-	unsigned CRC, RTC, SLID;
-	unsigned SEQ, FRP, RRP;
+	//Simulator fields that do not fit in the wire layout
+	unsigned returnTokens;	//RTC is accumulated over the 3-bit field (only the lower bits are on the wire)
+	uint64_t respADRS;		//Response and flow packets carry the request address for the host (not on the wire)
 	
-	//Request Packet Fields
-	uint64_t ADRS;
-	unsigned Pb;
-	
-	//Response Packet Fields
-	unsigned AF, ERRSTAT, DINV;
+private:
+	uint64_t &Header()			{return words[0];}
+	uint64_t Header() const		{return words[0];}
+	uint64_t &Tail()			{return words[numWords-1];}
+	uint64_t Tail() const		{return words[numWords-1];}
+	void AllocWords(unsigned num);
+	void FillData();
+	static uint64_t GetBits(uint64_t word, unsigned lsb, unsigned width) {
+		return ((word >> lsb) & ((1ULL << width) - 1));
+	}
+	static void SetBits(uint64_t &word, unsigned lsb, unsigned width, uint64_t value) {
+		uint64_t mask = ((1ULL << width) - 1) << lsb;
+		word = (word & ~mask) | ((value << lsb) & mask);
+	}
 };
 
+//Buffer space of a packet (one space per flit)
+unsigned inline BufferLength(const Packet *packet) {return packet->LNG();}
+
 ostream& operator<<(ostream &out, const Packet &t);
 }
 
@@ -0,0 +1,74 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//Profiler.h
+//
+//Self-profiling of simulator components (compiled only with -DPROFILE)
+//
+
+#include <stdint.h>		//uint64_t
+#include <time.h>		//clock_gettime
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>	//__rdtsc
+#endif
+
+#ifdef PROFILE
+	#define PROFILE_CALL(stat, func)	{uint64_t profStart = CasHMC::ReadTSC(); func; (stat).Add(CasHMC::ReadTSC() - profStart);}
+#else
+	#define PROFILE_CALL(stat, func)	func;
+#endif
+
+namespace CasHMC
+{
+
+//Time stamp counter (nanosecond wall clock on the other architectures)
+uint64_t inline ReadTSC()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+#endif
+}
+
+uint64_t inline ReadWallNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+class ProfileStat
+{
+public:
+	ProfileStat():ticks(0), calls(0) {}
+	void Add(uint64_t t) {
+		ticks += t;
+		calls++;
+	}
+	ProfileStat &operator+=(const ProfileStat &p) {
+		ticks += p.ticks;
+		calls += p.calls;
+		return *this;
+	}
+
+	uint64_t ticks;		//Accumulated time stamp counter
+	uint64_t calls;		//The number of profiled calls
+};
+
+}
+
+#endif
@@ -11,12 +11,17 @@
 
 #include <getopt.h>		//getopt_long
 #include <stdlib.h>		//exit(0)
+#include <deque>		//deque
 #include <fstream>		//ofstream
 #include <vector>		//vector
 
 #include "CasHMCWrapper.h"
+#include "MultiChannel.h"
 #include "Transaction.h"
 #include "CallBack.h"
+#include "Workload.h"
+#include "TraceReader.h"
+#include "TraceStream.h"
 
 using namespace std;
 using namespace CasHMC;
@@ -30,6 +35,7 @@ extern string traceFileName;
 uint64_t lineNumber = 1;
 vector<Transaction *> transactionBuffers;
 CasHMCWrapper *casHMCWrapper;
+TraceOutStream *genTrace = NULL;
 
 #ifdef CALLBACKTRANS
 class CallbackTrans
@@ -47,99 +53,138 @@ class CallbackTrans
 void Help()
 {
 	cout<<endl<<"-c (--cycle)   : The number of CPU cycles to be simulated"<<endl;
-	cout<<"-t (--trace)   : Trace type ('random' or 'file')"<<endl;
+	cout<<"-t (--trace)   : Trace type ('random', 'file', or 'synthetic')"<<endl;
 	cout<<"-u (--util)    : Requests frequency (0 = no requests, 1 = as fast as possible) [Default 0.1]"<<endl;
 	cout<<"-r (--rwratio) : (%) The percentage of reads in request stream [Default 80]"<<endl;
-	cout<<"-f (--file)    : Trace file name"<<endl;
+	cout<<"-f (--file)    : Trace file name (gzip, xz, and zstd compressed files are decompressed while reading)"<<endl;
+	cout<<"-g (--gen)     : Trace file written from the requests of 'random' trace type (.gz, .xz, or .zst is compressed)"<<endl;
+	cout<<"-w (--pattern) : Synthetic workload pattern ('uniform', 'stream', 'strided', 'chase', 'zipf', or 'gups') [Default uniform]"<<endl;
+	cout<<"-n (--cores)   : The number of virtual cores in synthetic workload [Default 4]"<<endl;
+	cout<<"-m (--mshr)    : The number of outstanding requests per core in synthetic workload [Default 8]"<<endl;
+	cout<<"-s (--size)    : [byte] Request size in synthetic workload (16 ~ 256, 0 = 16-256 byte mix) [Default TRANSACTION_SIZE]"<<endl;
+	cout<<"-d (--stride)  : [byte] Stride of 'strided' pattern [Default 4096]"<<endl;
+	cout<<"-z (--zipf)    : Skewness of 'zipf' pattern [Default 0.99]"<<endl;
+	cout<<"-o (--footprint) : [MB] Memory footprint of synthetic workload (0 = whole HMC) [Default 0]"<<endl;
+	cout<<"-q (--qos)     : The number of cores issuing requests of the highest QoS class in synthetic workload [Default 0]"<<endl;
+	cout<<"-N (--channels) : The number of independent HMC channels simulated in parallel ('random' and 'file' trace type) [Default 1]"<<endl;
+	cout<<"-Q (--quantum) : [CPU clk] Synchronization quantum of channels (larger is faster but less accurate) [Default 1000]"<<endl;
+	cout<<"-I (--interleave) : [byte] Address interleaving granularity over channels [Default 256]"<<endl;
 	cout<<"-h (--help)    : Simulation option help"<<endl<<endl;
 }
 
-void MakeRandomTransaction(void)
+//
+//Random request of the current cycle (false if no request is made)
+//
+bool MakeRandomRequest(uint64_t cpuCycle, TransactionType &tranType, uint64_t &physicalAddress)
 {
 	int rand_tran = rand()%10000+1;
 	if(rand_tran <= (int)(memUtil*10000)) {
-		Transaction *newTran;
-		uint64_t physicalAddress = rand();
+		physicalAddress = rand();
 		physicalAddress = (physicalAddress<<32)|rand();
 		
 		if(physicalAddress%101 <= (int)rwRatio) {
-			newTran = new Transaction(DATA_READ, physicalAddress, TRANSACTION_SIZE, casHMCWrapper);		// Read transaction
+			tranType = DATA_READ;	// Read transaction
 		}
 		else {
-			newTran = new Transaction(DATA_WRITE, physicalAddress, TRANSACTION_SIZE, casHMCWrapper);	// Write transaction
+			tranType = DATA_WRITE;	// Write transaction
 		}
-		transactionBuffers.push_back(newTran);
+		if(genTrace != NULL) {
+			stringstream traceLine;
+			traceLine<<cpuCycle<<" 0x"<<hex<<physicalAddress<<dec<<(tranType == DATA_READ ? " READ " : " WRITE ")<<TRANSACTION_SIZE<<"\n";
+			genTrace->Write(traceLine.str());
+		}
+		return true;
 	}
+	return false;
 }
 
-void ParseTraceFileLine(string &line, uint64_t &clockCycle, uint64_t &addr, TransactionType &tranType, unsigned &dataSize)
+void MakeRandomTransaction(uint64_t cpuCycle)
 {
-	int previousIndex=0;
-	int spaceIndex=0;
-	string  tempStr="";
-
-	spaceIndex = line.find_first_of(" ", 0);
-	if(spaceIndex==-1)	ERROR("  == Error - tracefile format is wrong : "<<line);
-	tempStr = line.substr(0, spaceIndex);
-	istringstream clock(tempStr);
-	clock>>clockCycle;
-	previousIndex = spaceIndex;
+	TransactionType tranType;
+	uint64_t physicalAddress;
+	if(MakeRandomRequest(cpuCycle, tranType, physicalAddress)) {
+		transactionBuffers.push_back(new Transaction(tranType, physicalAddress, TRANSACTION_SIZE, casHMCWrapper));
+	}
+}
 
-	spaceIndex = line.find_first_not_of(" ", previousIndex);
-	if(spaceIndex==-1)	ERROR("  == Error - tracefile format is wrong : "<<line);
-	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-	istringstream add(tempStr.substr(2));
-	add>>hex>>addr;
-	previousIndex = line.find_first_of(" ", spaceIndex);
+//
+//Statistics directive of trace file
+//
+void ApplyTraceDirective(TraceDirective directive)
+{
+	switch(directive) {
+		case TRACE_ROI_BEGIN:	casHMCWrapper->BeginROI();				break;
+		case TRACE_ROI_END:		casHMCWrapper->EndROI();				break;
+		case TRACE_STATS_RESET:	casHMCWrapper->ResetStatistic();		break;
+		case TRACE_STATS_DUMP:	casHMCWrapper->SnapshotStatistic();		break;
+		default:	break;
+	}
+}
 
-	spaceIndex = line.find_first_not_of(" ", previousIndex);
-	if(spaceIndex==-1)	ERROR("  == Error - tracefile format is wrong : "<<line);
+//
+//Open-loop requests over independent channels (requests wait in the host until the channel has a free buffer entry)
+//
+void RunMultiChannel(unsigned numChannels, unsigned quantum, uint64_t interleave, string genFileName)
+{
+	MultiChannel *multiChannel = new MultiChannel(numChannels, quantum, interleave, "ConfigSim.ini", "ConfigDRAM.ini");
+#ifdef CALLBACKTRANS
+	CallbackTrans callbackTrans;
+	TransCompCB* read_cb = new Callback<CallbackTrans, void, uint64_t, uint64_t>(&callbackTrans, &CallbackTrans::ReadComplete);
+	TransCompCB* write_cb = new Callback<CallbackTrans, void, uint64_t, uint64_t>(&callbackTrans, &CallbackTrans::WriteComplete);
+	multiChannel->RegisterCallbacks(read_cb, write_cb);
+#endif
 	
-	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-	if(tempStr.compare("READ")==0)			tranType = DATA_READ;
-	else if(tempStr.compare("WRITE")==0)	tranType = DATA_WRITE;
-	//Arithmetic atomic
-	else if(tempStr.compare("2ADD8")==0)	tranType = ATM_2ADD8;
-	else if(tempStr.compare("ADD16")==0)	tranType = ATM_ADD16;
-	else if(tempStr.compare("P_2ADD8")==0)	tranType = ATM_P_2ADD8;
-	else if(tempStr.compare("P_ADD16")==0)	tranType = ATM_P_ADD16;
-	else if(tempStr.compare("2ADDS8R")==0)	tranType = ATM_2ADDS8R;
-	else if(tempStr.compare("ADDS16R")==0)	tranType = ATM_ADDS16R;
-	else if(tempStr.compare("INC8")==0)		tranType = ATM_INC8;
-	else if(tempStr.compare("P_INC8")==0)	tranType = ATM_P_INC8;
-	//Boolean atomic
-	else if(tempStr.compare("XOR16")==0)	tranType = ATM_XOR16;
-	else if(tempStr.compare("OR16")==0)		tranType = ATM_OR16;
-	else if(tempStr.compare("NOR16")==0)	tranType = ATM_NOR16;
-	else if(tempStr.compare("AND16")==0)	tranType = ATM_AND16;
-	else if(tempStr.compare("NAND16")==0)	tranType = ATM_NAND16;
-	//Comparison atomic
-	else if(tempStr.compare("CASGT8")==0)	tranType = ATM_CASGT8;
-	else if(tempStr.compare("CASLT8")==0)	tranType = ATM_CASLT8;
-	else if(tempStr.compare("CASGT16")==0)	tranType = ATM_CASGT16;
-	else if(tempStr.compare("CASLT16")==0)	tranType = ATM_CASLT16;
-	else if(tempStr.compare("CASEQ8")==0)	tranType = ATM_CASEQ8;
-	else if(tempStr.compare("CASZERO16")==0)tranType = ATM_CASZERO16;
-	else if(tempStr.compare("EQ16")==0)		tranType = ATM_EQ16;
-	else if(tempStr.compare("EQ8")==0)		tranType = ATM_EQ8;
-	//Bitwise atomic
-	else if(tempStr.compare("BWR")==0)		tranType = ATM_BWR;
-	else if(tempStr.compare("P_BWR")==0)	tranType = ATM_P_BWR;
-	else if(tempStr.compare("BWR8R")==0)	tranType = ATM_BWR8R;
-	else if(tempStr.compare("SWAP16")==0)	tranType = ATM_SWAP16;
-	else {
-		ERROR("  == Error - Unknown command in tracefile : "<<tempStr);
+	deque<TraceRecord> hostBuffer;
+	TraceRecord rec;
+	if(traceType == "random") {
+		if(genFileName != "")	genTrace = new TraceOutStream(genFileName);
+		for(uint64_t cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
+			if(MakeRandomRequest(cpuCycle, rec.tranType, rec.addr)) {
+				rec.dataSize = TRANSACTION_SIZE;
+				hostBuffer.push_back(rec);
+			}
+			if(!hostBuffer.empty()) {
+				if(multiChannel->ReceiveTran(hostBuffer.front().tranType, hostBuffer.front().addr, hostBuffer.front().dataSize)) {
+					hostBuffer.pop_front();
+				}
+			}
+			multiChannel->Update();
+		}
+		delete genTrace;
 	}
-	previousIndex = line.find_first_of(" ", spaceIndex);
-
-	spaceIndex = line.find_first_not_of(" ", previousIndex);
-	if(spaceIndex==-1) {
-		dataSize = TRANSACTION_SIZE;
-		return;
+	else {
+		TraceReader *traceReader = new TraceReader(traceFileName);
+		for(uint64_t cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
+			if(hostBuffer.empty() && traceReader->Next(rec)) {
+				if(rec.valid && rec.directive != TRACE_REQUEST) {
+					cout<<" ## WARNING ## Statistics directive is not supported in multi-channel simulation ("<<lineNumber<<")"<<endl;
+				}
+				else if(rec.valid) {
+					hostBuffer.push_back(rec);
+				}
+				else {
+					cout<<" ## WARNING ## Skipping line ("<<lineNumber<<") in tracefile  (CurrentClock : "<<cpuCycle<<")"<<endl;
+				}
+				lineNumber++;
+			}
+			if(!hostBuffer.empty() && cpuCycle >= hostBuffer.front().clockCycle) {
+				TraceRecord &req = hostBuffer.front();
+				if(multiChannel->ReceiveTran(req.tranType, req.addr, req.dataSize, req.priority)) {
+					hostBuffer.pop_front();
+				}
+			}
+			multiChannel->Update();
+		}
+		delete traceReader;
 	}
-	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-	istringstream size(tempStr);
-	size>>dataSize;
+	
+	multiChannel->Synchronize();
+	multiChannel->PrintStatistic(cout);
+	delete multiChannel;
+#ifdef CALLBACKTRANS
+	delete read_cb;
+	delete write_cb;
+#endif
 }
 
 int main(int argc, char **argv)
@@ -152,12 +197,23 @@ int main(int argc, char **argv)
 	rwRatio = 80;
 	traceType = "";
 	traceFileName = "";
+	string workloadPattern = "uniform";
+	unsigned numCores = 4;
+	unsigned coreMSHR = 8;
+	unsigned reqSize = 0;
+	bool reqSizeSet = false;
+	uint64_t strideSize = 4096;
+	double zipfAlpha = 0.99;
+	uint64_t footprintSize = 0;
+	unsigned qosCores = 0;
 	
 	int opt;
 	string pwdString = "";
-	ifstream traceFile;
-	string line;
+	string genFileName = "";
 	bool pendingTran = false;
+	unsigned numChannels = 1;
+	unsigned quantum = 1000;
+	uint64_t interleave = 256;
 	while(1) {
 		static struct option long_options[] = {
 			{"pwd", required_argument, 0, 'p'},
@@ -166,11 +222,23 @@ int main(int argc, char **argv)
 			{"util",  required_argument, 0, 'u'},
 			{"rwratio",  required_argument, 0, 'r'},
 			{"file",  required_argument, 0, 'f'},
+			{"gen",  required_argument, 0, 'g'},
+			{"pattern",  required_argument, 0, 'w'},
+			{"cores",  required_argument, 0, 'n'},
+			{"mshr",  required_argument, 0, 'm'},
+			{"size",  required_argument, 0, 's'},
+			{"stride",  required_argument, 0, 'd'},
+			{"zipf",  required_argument, 0, 'z'},
+			{"footprint",  required_argument, 0, 'o'},
+			{"qos",  required_argument, 0, 'q'},
+			{"channels",  required_argument, 0, 'N'},
+			{"quantum",  required_argument, 0, 'Q'},
+			{"interleave",  required_argument, 0, 'I'},
 			{"help", no_argument, 0, 'h'},
 			{0, 0, 0, 0}
 		};
 		int option_index=0;
-		opt = getopt_long (argc, argv, "p:c:t:u:r:f:h", long_options, &option_index);
+		opt = getopt_long (argc, argv, "p:c:t:u:r:f:g:w:n:m:s:d:z:o:q:N:Q:I:h", long_options, &option_index);
 		if(opt == -1) {
 			break;
 		}
@@ -194,9 +262,9 @@ int main(int argc, char **argv)
 				break;
 			case 't':
 				traceType = string(optarg);
-				if(traceType != "random" && traceType != "file") {
+				if(traceType != "random" && traceType != "file" && traceType != "synthetic") {
 					cout<<endl<<" == -t (--trace) ERROR ==";
-					cout<<endl<<"  This option must be selected by one of 'random' and 'file'"<<endl<<endl;
+					cout<<endl<<"  This option must be selected by one of 'random', 'file', and 'synthetic'"<<endl<<endl;
 					exit(0);
 				}
 				break;
@@ -224,6 +292,84 @@ int main(int argc, char **argv)
 					exit(0);
 				}
 				break;
+			case 'g':
+				genFileName = string(optarg);
+				break;
+			case 'w':
+				workloadPattern = string(optarg);
+				if(workloadPattern != "uniform" && workloadPattern != "stream" && workloadPattern != "strided"
+				&& workloadPattern != "chase" && workloadPattern != "zipf" && workloadPattern != "gups") {
+					cout<<endl<<" == -w (--pattern) ERROR ==";
+					cout<<endl<<"  This option must be selected by one of 'uniform', 'stream', 'strided', 'chase', 'zipf', and 'gups'"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 'n':
+				numCores = atoi(optarg);
+				if(numCores == 0) {
+					cout<<endl<<" == -n (--cores) ERROR ==";
+					cout<<endl<<"  This value must be bigger than '0'"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 'm':
+				coreMSHR = atoi(optarg);
+				if(coreMSHR == 0) {
+					cout<<endl<<" == -m (--mshr) ERROR ==";
+					cout<<endl<<"  This value must be bigger than '0'"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 's':
+				reqSize = atoi(optarg);
+				reqSizeSet = true;
+				if(reqSize != 0 && ((reqSize%16 != 0 || reqSize > 128) && reqSize != 256)) {
+					cout<<endl<<" == -s (--size) ERROR ==";
+					cout<<endl<<"  This value must be one of 16, 32, 48, 64, 80, 96, 112, 128, 256, and 0 (mix)"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 'd':
+				strideSize = strtoull(optarg, NULL, 10);
+				break;
+			case 'z':
+				zipfAlpha = atof(optarg);
+				if(zipfAlpha < 0) {
+					cout<<endl<<" == -z (--zipf) ERROR ==";
+					cout<<endl<<"  This value must not be negative"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 'o':
+				footprintSize = strtoull(optarg, NULL, 10)<<20;
+				break;
+			case 'q':
+				qosCores = atoi(optarg);
+				break;
+			case 'N':
+				numChannels = atoi(optarg);
+				if(numChannels == 0) {
+					cout<<endl<<" == -N (--channels) ERROR ==";
+					cout<<endl<<"  This value must be bigger than '0'"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 'Q':
+				quantum = atoi(optarg);
+				if(quantum == 0) {
+					cout<<endl<<" == -Q (--quantum) ERROR ==";
+					cout<<endl<<"  This value must be bigger than '0'"<<endl<<endl;
+					exit(0);
+				}
+				break;
+			case 'I':
+				interleave = strtoull(optarg, NULL, 10);
+				if(interleave < 16 || (interleave & (interleave-1)) != 0) {
+					cout<<endl<<" == -I (--interleave) ERROR ==";
+					cout<<endl<<"  This value must be a power of two (16 byte at least)"<<endl<<endl;
+					exit(0);
+				}
+				break;
 			case 'h':
 			case '?':
 				Help();
@@ -232,8 +378,26 @@ int main(int argc, char **argv)
 		}
 	}
 	
+	if(genFileName != "" && traceType != "random") {
+		cout<<endl<<" == -g (--gen) ERROR ==";
+		cout<<endl<<"  Trace file is generated only in 'random' trace type"<<endl<<endl;
+		exit(0);
+	}
+	
+	if(numChannels > 1 && traceType != "random" && traceType != "file") {
+		cout<<endl<<" == -N (--channels) ERROR ==";
+		cout<<endl<<"  Multiple channels are simulated only in 'random' and 'file' trace type"<<endl<<endl;
+		exit(0);
+	}
+	
 	srand((unsigned)time(NULL));
+	if(numChannels > 1) {
+		RunMultiChannel(numChannels, quantum, interleave, genFileName);
+		return 0;
+	}
+	
 	casHMCWrapper = new CasHMCWrapper("ConfigSim.ini", "ConfigDRAM.ini");
+	if(!reqSizeSet)	reqSize = TRANSACTION_SIZE;
 	
 #ifdef CALLBACKTRANS
 	//Register callback function (ReadComplete, WriteComplete)
@@ -244,8 +408,9 @@ int main(int argc, char **argv)
 #endif
 	
 	if(traceType == "random") {
+		if(genFileName != "")	genTrace = new TraceOutStream(genFileName);
 		for(uint64_t cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
-			MakeRandomTransaction();
+			MakeRandomTransaction(cpuCycle);
 			if(!transactionBuffers.empty()) {
 				if(casHMCWrapper->ReceiveTran(transactionBuffers[0])) {
 					transactionBuffers.erase(transactionBuffers.begin());
@@ -253,24 +418,31 @@ int main(int argc, char **argv)
 			}
 			casHMCWrapper->Update();
 		}
+		delete genTrace;
 	}
 	else if(traceType == "file") {
 		uint64_t issueClock = 0;
-		traceFile.open(traceFileName.c_str());
-		if(!traceFile.is_open()) {
-			ERROR(" == Error - Could not open trace file ["<<traceFileName<<"]");
-			exit(0);
-		}
+		//Trace file is read and decoded on its own thread
+		TraceReader *traceReader = new TraceReader(traceFileName);
+		TraceRecord rec;
+		TraceDirective pendingDirective = TRACE_REQUEST;
 		for(uint64_t cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
 			if(!pendingTran) {
-				if(!traceFile.eof()) {
-					getline(traceFile, line);
-					if(line.size() > 0) {
-						uint64_t addr;
-						TransactionType tranType;
-						unsigned dataSize;
-						ParseTraceFileLine(line, issueClock, addr, tranType, dataSize);
-						Transaction *newTran = new Transaction(tranType, addr, dataSize, casHMCWrapper);
+				if(traceReader->Next(rec)) {
+					if(rec.valid && rec.directive != TRACE_REQUEST) {
+						//Statistics directive takes effect in trace order at its clock
+						issueClock = rec.clockCycle;
+						if(cpuCycle >= issueClock) {
+							ApplyTraceDirective(rec.directive);
+						}
+						else {
+							pendingTran = true;
+							pendingDirective = rec.directive;
+						}
+					}
+					else if(rec.valid) {
+						issueClock = rec.clockCycle;
+						Transaction *newTran = new Transaction(rec.tranType, rec.addr, rec.dataSize, casHMCWrapper, NULL, rec.priority);
 						
 						if(cpuCycle >= issueClock) {
 							if(!casHMCWrapper->ReceiveTran(newTran)) {
@@ -290,7 +462,12 @@ int main(int argc, char **argv)
 				}
 			}
 			else {
-				if(cpuCycle >= issueClock) {
+				if(cpuCycle >= issueClock && pendingDirective != TRACE_REQUEST) {
+					ApplyTraceDirective(pendingDirective);
+					pendingTran = false;
+					pendingDirective = TRACE_REQUEST;
+				}
+				else if(cpuCycle >= issueClock) {
 					if(casHMCWrapper->ReceiveTran(transactionBuffers[0])) {
 						pendingTran = false;
 						transactionBuffers.erase(transactionBuffers.begin());
@@ -299,6 +476,19 @@ int main(int argc, char **argv)
 			}
 			casHMCWrapper->Update();
 		}
+		delete traceReader;
+	}
+
+	else if(traceType == "synthetic") {
+		//Closed-loop workload (virtual cores issue requests only when they have a free MSHR entry)
+		Workload *workload = new Workload(casHMCWrapper, workloadPattern, numCores, coreMSHR, reqSize,
+											strideSize, zipfAlpha, footprintSize, memUtil, rwRatio, qosCores);
+		for(uint64_t cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
+			workload->Update();
+			casHMCWrapper->Update();
+		}
+		workload->PrintStatistic(cout);
+		delete workload;
 	}
 
 	transactionBuffers.clear();
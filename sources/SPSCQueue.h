@@ -0,0 +1,95 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+//SPSCQueue.h
+//
+//Bounded lock-free single-producer/single-consumer ring of preallocated elements
+// One thread calls Push and the other thread calls Front/Pop (no lock and no allocation after construction)
+//
+
+#include <stdint.h>		//uint64_t
+#include <stdlib.h>		//exit(0)
+#include <atomic>		//atomic
+#include <vector>		//vector
+
+#include "ConfigValue.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+template <typename T>
+class SPSCQueue
+{
+public:
+	SPSCQueue(unsigned size) {
+		if(size < 2 || (size & (size-1)) != 0) {
+			ERROR(" == Error - SPSC queue size ("<<size<<") should be a power of two");
+			exit(0);
+		}
+		ring = vector<T>(size);
+		mask = size - 1;
+		head.store(0, memory_order_relaxed);
+		tail.store(0, memory_order_relaxed);
+		cachedHead = 0;
+		cachedTail = 0;
+	}
+	//Producer side (returns false if the ring is full)
+	bool Push(const T &ele) {
+		uint64_t t = tail.load(memory_order_relaxed);
+		if(t - cachedHead > mask) {
+			cachedHead = head.load(memory_order_acquire);
+			if(t - cachedHead > mask)	return false;
+		}
+		ring[t & mask] = ele;
+		tail.store(t + 1, memory_order_release);
+		return true;
+	}
+	//Consumer side (returns NULL if the ring is empty)
+	T *Front() {
+		uint64_t h = head.load(memory_order_relaxed);
+		if(h == cachedTail) {
+			cachedTail = tail.load(memory_order_acquire);
+			if(h == cachedTail)	return NULL;
+		}
+		return &ring[h & mask];
+	}
+	void Pop() {
+		head.store(head.load(memory_order_relaxed) + 1, memory_order_release);
+	}
+	bool Pop(T &ele) {
+		T *front = Front();
+		if(front == NULL)	return false;
+		ele = *front;
+		Pop();
+		return true;
+	}
+	unsigned Size() {
+		return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+	}
+
+private:
+	vector<T> ring;
+	uint64_t mask;
+	//Producer and consumer indexes are kept in separate cache lines
+	alignas(64) atomic<uint64_t> head;
+	uint64_t cachedTail;		//Consumer copy of tail
+	alignas(64) atomic<uint64_t> tail;
+	uint64_t cachedHead;		//Producer copy of head
+};
+
+}
+
+#endif
@@ -22,6 +22,8 @@
 #include <iomanip>		//setw()
 #include <sstream>		//stringstream
 
+#include "Profiler.h"
+
 using namespace std;
 
 namespace CasHMC
@@ -46,6 +48,9 @@ public:
 	ofstream &stateOut;
 	string header;
 	stringstream classID;
+#ifdef PROFILE
+	ProfileStat profile;
+#endif
 	
 };
 
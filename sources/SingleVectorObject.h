@@ -65,11 +65,11 @@ public:
 	}
 	
 	bool Receive(BufT *ele) {
-		if(Buffers.size() + ele->LNG <= bufferMax) {
+		if(Buffers.size() + BufferLength(ele) <= bufferMax) {
 			Buffers.push_back(ele);
 			//If receiving packet is packet, add virtual tail packet in Buffers as long as packet length
 			if(sizeof(*ele) == sizeof(Packet)) {
-				for(int i=1; i<ele->LNG; i++) {
+				for(int i=1; i<BufferLength(ele); i++) {
 					Buffers.push_back(NULL);
 				}
 			}
@@ -0,0 +1,115 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef TAGPOOL_H
+#define TAGPOOL_H
+
+//TagPool.h
+//
+//Request packet tag pool of HMC controller (11-bit TAG field)
+//
+
+#include <stdint.h>		//uint64_t
+#include <stdlib.h>		//exit(0)
+#include <algorithm>	//max
+#include <deque>		//deque
+#include <vector>		//vector
+
+#include "ConfigValue.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+//Tag occupancy statistics
+class TagStat
+{
+public:
+	TagStat():allocated(0), exhaustCycles(0), occupancySum(0), occupancyMax(0), cycles(0) {}
+	TagStat &operator+=(const TagStat &t) {
+		allocated += t.allocated;
+		exhaustCycles += t.exhaustCycles;
+		occupancySum += t.occupancySum;
+		occupancyMax = max(occupancyMax, t.occupancyMax);
+		cycles += t.cycles;
+		return *this;
+	}
+
+	uint64_t allocated;		//Allocated tags
+	uint64_t exhaustCycles;	//Cycles that a transaction is not issued because all tags are in use
+	uint64_t occupancySum;	//Tags in use accumulated every cycle
+	unsigned occupancyMax;	//The maximum number of tags in use
+	uint64_t cycles;		//Sampled cycles
+};
+
+class TagPool
+{
+public:
+	TagPool(unsigned size=2048):inFlight(0) {
+		if(size < 1 || size > 2048) {
+			ERROR(" == Error - NUM_TAGS ("<<size<<") should be in 1 ~ 2048 (11-bit TAG field)");
+			exit(0);
+		}
+		//Tags are recycled in FIFO order so that a freed tag is reused as late as possible
+		for(unsigned t=0; t<size; t++) {
+			freeTags.push_back(t);
+		}
+		refCount = vector<unsigned>(size, 0);
+	}
+	bool Available() {
+		return !freeTags.empty();
+	}
+	unsigned Allocate() {
+		unsigned tag = freeTags.front();
+		freeTags.pop_front();
+		refCount[tag] = 1;
+		inFlight++;
+		epochTagStat.allocated++;
+		return tag;
+	}
+	//The tag of a packet refused by link master is returned to the head of free list
+	void Unallocate(unsigned tag) {
+		refCount[tag] = 0;
+		freeTags.push_front(tag);
+		inFlight--;
+		epochTagStat.allocated--;
+	}
+	//Posted request divided into segment packets completes once per segment
+	void AddSegment(unsigned tag, unsigned segments) {
+		refCount[tag] += segments;
+	}
+	void Free(unsigned tag) {
+		if(tag >= refCount.size() || refCount[tag] == 0) {
+			ERROR(" == Error - Tag "<<tag<<" is freed but it is not in use");
+			exit(0);
+		}
+		if(--refCount[tag] == 0) {
+			freeTags.push_back(tag);
+			inFlight--;
+		}
+	}
+	void Sample() {
+		epochTagStat.occupancySum += inFlight;
+		epochTagStat.occupancyMax = max(epochTagStat.occupancyMax, inFlight);
+		epochTagStat.cycles++;
+	}
+
+	deque<unsigned> freeTags;
+	vector<unsigned> refCount;	//Completions left before the tag is freed
+	unsigned inFlight;			//Tags in use
+	TagStat epochTagStat;
+	TagStat totalTagStat;
+};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include "TraceReader.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+TraceReader::TraceReader(string fileName):
+	ring(TRACE_RING_SIZE)
+{
+	finished.store(false);
+	stopped.store(false);
+	traceFile = new TraceInStream(fileName);
+	readThread = thread(&TraceReader::ReadLoop, this);
+}
+
+TraceReader::~TraceReader()
+{
+	stopped.store(true);
+	readThread.join();
+	delete traceFile;
+}
+
+//
+//Get the next trace record (waits for the reader thread, and returns false at the end of trace)
+//
+bool TraceReader::Next(TraceRecord &rec)
+{
+	while(!ring.Pop(rec)) {
+		if(finished.load(memory_order_acquire)) {
+			//Records pushed before the finished flag are visible here
+			return ring.Pop(rec);
+		}
+		this_thread::yield();
+	}
+	return true;
+}
+
+//
+//Decode trace file lines ahead into the ring (reader thread)
+//
+void TraceReader::ReadLoop()
+{
+	string line;
+	TraceRecord rec;
+	while(!traceFile->Eof() && !stopped.load(memory_order_relaxed)) {
+		traceFile->GetLine(line);
+		rec.valid = (line.size() > 0);
+		if(rec.valid && !ParseTraceDirective(line, rec.clockCycle, rec.directive)) {
+			ParseTraceFileLine(line, rec.clockCycle, rec.addr, rec.tranType, rec.dataSize, rec.priority);
+		}
+		while(!ring.Push(rec)) {
+			if(stopped.load(memory_order_relaxed))	break;
+			this_thread::yield();
+		}
+	}
+	finished.store(true, memory_order_release);
+}
+
+//
+//Parse a statistics directive line (false for a memory request line)
+//
+bool ParseTraceDirective(string &line, uint64_t &clockCycle, TraceDirective &directive)
+{
+	istringstream lineStream(line);
+	string name;
+	uint64_t clock = 0;
+	lineStream>>clock>>name;
+	
+	if(name == "ROI_BEGIN")			directive = TRACE_ROI_BEGIN;
+	else if(name == "ROI_END")		directive = TRACE_ROI_END;
+	else if(name == "STATS_RESET")	directive = TRACE_STATS_RESET;
+	else if(name == "STATS_DUMP")	directive = TRACE_STATS_DUMP;
+	else {
+		directive = TRACE_REQUEST;
+		return false;
+	}
+	clockCycle = clock;
+	return true;
+}
+
+//
+//Parse one trace file line (clock, address, command, [size], [priority])
+//
+void ParseTraceFileLine(string &line, uint64_t &clockCycle, uint64_t &addr, TransactionType &tranType, unsigned &dataSize, unsigned &priority)
+{
+	int previousIndex=0;
+	int spaceIndex=0;
+	string  tempStr="";
+
+	spaceIndex = line.find_first_of(" ", 0);
+	if(spaceIndex==-1)	ERROR("  == Error - tracefile format is wrong : "<<line);
+	tempStr = line.substr(0, spaceIndex);
+	istringstream clock(tempStr);
+	clock>>clockCycle;
+	previousIndex = spaceIndex;
+
+	spaceIndex = line.find_first_not_of(" ", previousIndex);
+	if(spaceIndex==-1)	ERROR("  == Error - tracefile format is wrong : "<<line);
+	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+	istringstream add(tempStr.substr(2));
+	add>>hex>>addr;
+	previousIndex = line.find_first_of(" ", spaceIndex);
+
+	spaceIndex = line.find_first_not_of(" ", previousIndex);
+	if(spaceIndex==-1)	ERROR("  == Error - tracefile format is wrong : "<<line);
+	
+	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+	if(tempStr.compare("READ")==0)			tranType = DATA_READ;
+	else if(tempStr.compare("WRITE")==0)	tranType = DATA_WRITE;
+	//Arithmetic atomic
+	else if(tempStr.compare("2ADD8")==0)	tranType = ATM_2ADD8;
+	else if(tempStr.compare("ADD16")==0)	tranType = ATM_ADD16;
+	else if(tempStr.compare("P_2ADD8")==0)	tranType = ATM_P_2ADD8;
+	else if(tempStr.compare("P_ADD16")==0)	tranType = ATM_P_ADD16;
+	else if(tempStr.compare("2ADDS8R")==0)	tranType = ATM_2ADDS8R;
+	else if(tempStr.compare("ADDS16R")==0)	tranType = ATM_ADDS16R;
+	else if(tempStr.compare("INC8")==0)		tranType = ATM_INC8;
+	else if(tempStr.compare("P_INC8")==0)	tranType = ATM_P_INC8;
+	//Boolean atomic
+	else if(tempStr.compare("XOR16")==0)	tranType = ATM_XOR16;
+	else if(tempStr.compare("OR16")==0)		tranType = ATM_OR16;
+	else if(tempStr.compare("NOR16")==0)	tranType = ATM_NOR16;
+	else if(tempStr.compare("AND16")==0)	tranType = ATM_AND16;
+	else if(tempStr.compare("NAND16")==0)	tranType = ATM_NAND16;
+	//Comparison atomic
+	else if(tempStr.compare("CASGT8")==0)	tranType = ATM_CASGT8;
+	else if(tempStr.compare("CASLT8")==0)	tranType = ATM_CASLT8;
+	else if(tempStr.compare("CASGT16")==0)	tranType = ATM_CASGT16;
+	else if(tempStr.compare("CASLT16")==0)	tranType = ATM_CASLT16;
+	else if(tempStr.compare("CASEQ8")==0)	tranType = ATM_CASEQ8;
+	else if(tempStr.compare("CASZERO16")==0)tranType = ATM_CASZERO16;
+	else if(tempStr.compare("EQ16")==0)		tranType = ATM_EQ16;
+	else if(tempStr.compare("EQ8")==0)		tranType = ATM_EQ8;
+	//Bitwise atomic
+	else if(tempStr.compare("BWR")==0)		tranType = ATM_BWR;
+	else if(tempStr.compare("P_BWR")==0)	tranType = ATM_P_BWR;
+	else if(tempStr.compare("BWR8R")==0)	tranType = ATM_BWR8R;
+	else if(tempStr.compare("SWAP16")==0)	tranType = ATM_SWAP16;
+	else {
+		ERROR("  == Error - Unknown command in tracefile : "<<tempStr);
+	}
+	previousIndex = line.find_first_of(" ", spaceIndex);
+
+	priority = 0;
+	spaceIndex = line.find_first_not_of(" ", previousIndex);
+	if(spaceIndex==-1) {
+		dataSize = TRANSACTION_SIZE;
+		return;
+	}
+	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+	istringstream size(tempStr);
+	size>>dataSize;
+	previousIndex = line.find_first_of(" ", spaceIndex);
+
+	//Optional QoS priority class
+	if(previousIndex==-1)	return;
+	spaceIndex = line.find_first_not_of(" ", previousIndex);
+	if(spaceIndex==-1)	return;
+	tempStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+	istringstream prio(tempStr);
+	prio>>priority;
+}
+
+}
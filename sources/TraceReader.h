@@ -0,0 +1,90 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
+
+//TraceReader.h
+//
+//Trace file reader thread (lines are decoded ahead into a SPSC ring drained by the simulation loop,
+// and compressed trace files are decompressed on another helper thread)
+//
+
+#include <stdint.h>		//uint64_t
+#include <atomic>		//atomic
+#include <sstream>		//istringstream
+#include <string>		//string
+#include <thread>		//thread
+
+#include "ConfigValue.h"
+#include "SPSCQueue.h"
+#include "TraceStream.h"
+#include "Transaction.h"
+
+#define TRACE_RING_SIZE	4096	//The number of decoded trace records buffered ahead of the simulation
+
+using namespace std;
+
+namespace CasHMC
+{
+
+//Statistics directive line of trace file (clock, directive name)
+enum TraceDirective
+{
+	TRACE_REQUEST,		//Not a directive (memory request line)
+	TRACE_ROI_BEGIN,	//ROI_BEGIN   : Statistics are reset, and region of interest begins
+	TRACE_ROI_END,		//ROI_END     : Region of interest ends (*_roi[k].log)
+	TRACE_STATS_RESET,	//STATS_RESET : Statistics are reset
+	TRACE_STATS_DUMP	//STATS_DUMP  : Statistics until the clock are printed without reset (*_snapshot[k].log)
+};
+
+//One decoded trace file line
+class TraceRecord
+{
+public:
+	TraceRecord():clockCycle(0), addr(0), tranType(DATA_READ), dataSize(0), priority(0), directive(TRACE_REQUEST), valid(false) {}
+
+	uint64_t clockCycle;
+	uint64_t addr;
+	TransactionType tranType;
+	unsigned dataSize;
+	unsigned priority;
+	TraceDirective directive;
+	bool valid;			//false for an empty line
+};
+
+void ParseTraceFileLine(string &line, uint64_t &clockCycle, uint64_t &addr, TransactionType &tranType, unsigned &dataSize, unsigned &priority);
+bool ParseTraceDirective(string &line, uint64_t &clockCycle, TraceDirective &directive);
+
+class TraceReader
+{
+public:
+	//
+	//Functions
+	//
+	TraceReader(string fileName);
+	virtual ~TraceReader();
+	bool Next(TraceRecord &rec);
+	void ReadLoop();
+
+	//
+	//Fields
+	//
+	TraceInStream *traceFile;
+	SPSCQueue<TraceRecord> ring;
+	thread readThread;
+	atomic<bool> finished;		//All lines are decoded into the ring
+	atomic<bool> stopped;		//The simulation ends before the end of trace
+};
+
+}
+
+#endif
@@ -0,0 +1,396 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include <stdlib.h>		//exit(0)
+#include <string.h>		//memchr
+
+#include "TraceStream.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+string CodecName(TraceCodec codec)
+{
+	switch(codec) {
+		case CODEC_PLAIN:	return "plain text";
+		case CODEC_GZIP:	return "gzip";
+		case CODEC_XZ:		return "xz";
+		case CODEC_ZSTD:	return "zstd";
+		default:			return "unknown";
+	}
+}
+
+TraceInStream::TraceInStream(string fileName):
+	fullChunks(TRACE_CHUNKS),
+	freeChunks(TRACE_CHUNKS)
+{
+	file = fopen(fileName.c_str(), "rb");
+	if(file == NULL) {
+		ERROR(" == Error - Could not open trace file ["<<fileName<<"]");
+		exit(0);
+	}
+
+	//Detect the compression format by magic bytes
+	unsigned char magic[6] = {0, 0, 0, 0, 0, 0};
+	size_t magicSize = fread(magic, 1, 6, file);
+	rewind(file);
+	if(magicSize >= 2 && magic[0] == 0x1F && magic[1] == 0x8B)	codec = CODEC_GZIP;
+	else if(magicSize >= 6 && magic[0] == 0xFD && magic[1] == '7' && magic[2] == 'z'
+		&& magic[3] == 'X' && magic[4] == 'Z' && magic[5] == 0)	codec = CODEC_XZ;
+	else if(magicSize >= 4 && magic[0] == 0x28 && magic[1] == 0xB5
+		&& magic[2] == 0x2F && magic[3] == 0xFD)	codec = CODEC_ZSTD;
+	else	codec = CODEC_PLAIN;
+
+	inBuf = vector<char>(TRACE_CHUNK_SIZE);
+	inPos = 0;
+	inSize = 0;
+	inEnd = false;
+	decodeEnd = false;
+	bool supported = (codec == CODEC_PLAIN);
+#ifdef TRACE_GZIP
+	if(codec == CODEC_GZIP) {
+		fclose(file);
+		file = NULL;
+		gzIn = gzopen(fileName.c_str(), "rb");
+		if(gzIn == NULL) {
+			ERROR(" == Error - Could not open gzip trace file ["<<fileName<<"]");
+			exit(0);
+		}
+		gzbuffer(gzIn, TRACE_CHUNK_SIZE);
+		supported = true;
+	}
+#endif
+#ifdef TRACE_XZ
+	if(codec == CODEC_XZ) {
+		xzIn = LZMA_STREAM_INIT;
+		if(lzma_stream_decoder(&xzIn, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+			ERROR(" == Error - Could not initialize xz decoder");
+			exit(0);
+		}
+		supported = true;
+	}
+#endif
+#ifdef TRACE_ZSTD
+	if(codec == CODEC_ZSTD) {
+		zstdIn = ZSTD_createDStream();
+		ZSTD_initDStream(zstdIn);
+		supported = true;
+	}
+#endif
+	if(!supported) {
+		ERROR(" == Error - "<<CodecName(codec)<<" trace file ["<<fileName<<"] is not supported by this build");
+		exit(0);
+	}
+
+	//Decompressed chunks are recycled between the decompression thread and the line reader
+	chunkBuf = vector<vector<char> >(TRACE_CHUNKS, vector<char>(TRACE_CHUNK_SIZE));
+	for(unsigned c=0; c<TRACE_CHUNKS; c++) {
+		freeChunks.Push(c);
+	}
+	eof = false;
+	chunkValid = false;
+	curPos = 0;
+	stopped.store(false);
+	decodeThread = thread(&TraceInStream::DecodeLoop, this);
+}
+
+TraceInStream::~TraceInStream()
+{
+	stopped.store(true);
+	decodeThread.join();
+	switch(codec) {
+#ifdef TRACE_GZIP
+		case CODEC_GZIP:	gzclose(gzIn);				break;
+#endif
+#ifdef TRACE_XZ
+		case CODEC_XZ:		lzma_end(&xzIn);			break;
+#endif
+#ifdef TRACE_ZSTD
+		case CODEC_ZSTD:	ZSTD_freeDStream(zstdIn);	break;
+#endif
+		default:	break;
+	}
+	if(file != NULL)	fclose(file);
+}
+
+//
+//Read one line (the same behavior as getline of ifstream)
+//
+void TraceInStream::GetLine(string &line)
+{
+	line.clear();
+	while(!eof) {
+		if(!chunkValid) {
+			while(!fullChunks.Pop(curChunk)) {
+				this_thread::yield();
+			}
+			curPos = 0;
+			chunkValid = true;
+			if(curChunk.size == 0) {
+				eof = true;
+				return;
+			}
+		}
+		char *buf = &chunkBuf[curChunk.index][0];
+		char *newLine = (char *)memchr(buf + curPos, '\n', curChunk.size - curPos);
+		unsigned end = (newLine == NULL) ? curChunk.size : newLine - buf;
+		line.append(buf + curPos, end - curPos);
+		curPos = end + (newLine == NULL ? 0 : 1);
+		if(curPos == curChunk.size) {
+			freeChunks.Push(curChunk.index);
+			chunkValid = false;
+		}
+		if(newLine != NULL)	return;
+	}
+}
+
+//
+//Decompress chunks ahead of the line reader (decompression thread)
+//
+void TraceInStream::DecodeLoop()
+{
+	while(!stopped.load(memory_order_relaxed)) {
+		unsigned index;
+		if(!freeChunks.Pop(index)) {
+			this_thread::yield();
+			continue;
+		}
+		unsigned size = Decode(&chunkBuf[index][0], TRACE_CHUNK_SIZE);
+		//The queue has a slot for every chunk
+		fullChunks.Push(TraceChunk(index, size));
+		if(size == 0)	return;
+	}
+}
+
+//
+//Read compressed input of xz and zstd decoders
+//
+bool TraceInStream::FillInput()
+{
+	inSize = fread(&inBuf[0], 1, inBuf.size(), file);
+	inPos = 0;
+	if(inSize < inBuf.size())	inEnd = true;
+	return inSize > 0;
+}
+
+//
+//Decompress up to size bytes (less than size only at the end of file)
+//
+unsigned TraceInStream::Decode(char *buf, unsigned size)
+{
+	unsigned total = 0;
+	switch(codec) {
+		case CODEC_PLAIN:
+			while(total < size) {
+				size_t n = fread(buf + total, 1, size - total, file);
+				if(n == 0)	break;
+				total += n;
+			}
+			break;
+#ifdef TRACE_GZIP
+		case CODEC_GZIP:
+			while(total < size) {
+				int n = gzread(gzIn, buf + total, size - total);
+				if(n < 0) {
+					int errNum;
+					ERROR(" == Error - gzip trace decompression failed ("<<gzerror(gzIn, &errNum)<<")");
+					exit(0);
+				}
+				if(n == 0)	break;
+				total += n;
+			}
+			break;
+#endif
+#ifdef TRACE_XZ
+		case CODEC_XZ:
+			xzIn.next_out = (uint8_t *)buf;
+			xzIn.avail_out = size;
+			while(xzIn.avail_out > 0 && !decodeEnd) {
+				if(xzIn.avail_in == 0 && !inEnd) {
+					FillInput();
+					xzIn.next_in = (const uint8_t *)&inBuf[0];
+					xzIn.avail_in = inSize;
+				}
+				lzma_ret ret = lzma_code(&xzIn, (inEnd && xzIn.avail_in == 0) ? LZMA_FINISH : LZMA_RUN);
+				if(ret == LZMA_STREAM_END) {
+					decodeEnd = true;
+				}
+				else if(ret != LZMA_OK) {
+					ERROR(" == Error - xz trace decompression failed (lzma_ret : "<<ret<<")");
+					exit(0);
+				}
+			}
+			total = size - xzIn.avail_out;
+			break;
+#endif
+#ifdef TRACE_ZSTD
+		case CODEC_ZSTD: {
+			ZSTD_outBuffer out = {buf, size, 0};
+			while(out.pos < out.size && !decodeEnd) {
+				if(inPos == inSize && !inEnd)	FillInput();
+				size_t prevPos = out.pos;
+				ZSTD_inBuffer in = {&inBuf[0], inSize, inPos};
+				size_t ret = ZSTD_decompressStream(zstdIn, &out, &in);
+				inPos = in.pos;
+				if(ZSTD_isError(ret)) {
+					ERROR(" == Error - zstd trace decompression failed ("<<ZSTD_getErrorName(ret)<<")");
+					exit(0);
+				}
+				//Decoder is flushed when no more output is made from the last input
+				if(inEnd && inPos == inSize && out.pos == prevPos)	decodeEnd = true;
+			}
+			total = out.pos;
+			break;
+		}
+#endif
+		default:
+			break;
+	}
+	return total;
+}
+
+TraceOutStream::TraceOutStream(string fileName)
+{
+	string ext = fileName.substr(fileName.find_last_of('.') == string::npos ? fileName.size() : fileName.find_last_of('.'));
+	if(ext == ".gz")		codec = CODEC_GZIP;
+	else if(ext == ".xz")	codec = CODEC_XZ;
+	else if(ext == ".zst")	codec = CODEC_ZSTD;
+	else					codec = CODEC_PLAIN;
+
+	file = NULL;
+	compBuf = vector<char>(TRACE_CHUNK_SIZE);
+	switch(codec) {
+		case CODEC_GZIP:
+#ifdef TRACE_GZIP
+			gzOut = gzopen(fileName.c_str(), "wb");
+			if(gzOut == NULL) {
+				ERROR(" == Error - Could not open trace file ["<<fileName<<"]");
+				exit(0);
+			}
+			gzbuffer(gzOut, TRACE_CHUNK_SIZE);
+			return;
+#else
+			ERROR(" == Error - gzip trace file ["<<fileName<<"] is not supported by this build");
+			exit(0);
+#endif
+		case CODEC_XZ:
+#ifdef TRACE_XZ
+			xzOut = LZMA_STREAM_INIT;
+			if(lzma_easy_encoder(&xzOut, 6, LZMA_CHECK_CRC64) != LZMA_OK) {
+				ERROR(" == Error - Could not initialize xz encoder");
+				exit(0);
+			}
+			break;
+#else
+			ERROR(" == Error - xz trace file ["<<fileName<<"] is not supported by this build");
+			exit(0);
+#endif
+		case CODEC_ZSTD:
+#ifdef TRACE_ZSTD
+			zstdOut = ZSTD_createCStream();
+			ZSTD_initCStream(zstdOut, 3);
+			break;
+#else
+			ERROR(" == Error - zstd trace file ["<<fileName<<"] is not supported by this build");
+			exit(0);
+#endif
+		default:
+			break;
+	}
+	file = fopen(fileName.c_str(), "wb");
+	if(file == NULL) {
+		ERROR(" == Error - Could not open trace file ["<<fileName<<"]");
+		exit(0);
+	}
+}
+
+TraceOutStream::~TraceOutStream()
+{
+	Flush(true);
+	switch(codec) {
+#ifdef TRACE_GZIP
+		case CODEC_GZIP:	gzclose(gzOut);				break;
+#endif
+#ifdef TRACE_XZ
+		case CODEC_XZ:		lzma_end(&xzOut);			break;
+#endif
+#ifdef TRACE_ZSTD
+		case CODEC_ZSTD:	ZSTD_freeCStream(zstdOut);	break;
+#endif
+		default:	break;
+	}
+	if(file != NULL)	fclose(file);
+}
+
+void TraceOutStream::Write(const string &str)
+{
+	outBuf.insert(outBuf.end(), str.begin(), str.end());
+	if(outBuf.size() >= TRACE_CHUNK_SIZE)	Flush(false);
+}
+
+//
+//Compress and write the buffered data (finish ends the compressed stream)
+//
+void TraceOutStream::Flush(bool finish)
+{
+	switch(codec) {
+		case CODEC_PLAIN:
+			if(!outBuf.empty())	fwrite(&outBuf[0], 1, outBuf.size(), file);
+			break;
+#ifdef TRACE_GZIP
+		case CODEC_GZIP:
+			if(!outBuf.empty())	gzwrite(gzOut, &outBuf[0], outBuf.size());
+			break;
+#endif
+#ifdef TRACE_XZ
+		case CODEC_XZ: {
+			xzOut.next_in = (const uint8_t *)(outBuf.empty() ? NULL : &outBuf[0]);
+			xzOut.avail_in = outBuf.size();
+			while(true) {
+				xzOut.next_out = (uint8_t *)&compBuf[0];
+				xzOut.avail_out = compBuf.size();
+				lzma_ret ret = lzma_code(&xzOut, finish ? LZMA_FINISH : LZMA_RUN);
+				fwrite(&compBuf[0], 1, compBuf.size() - xzOut.avail_out, file);
+				if(ret == LZMA_STREAM_END)	break;
+				if(ret != LZMA_OK) {
+					ERROR(" == Error - xz trace compression failed (lzma_ret : "<<ret<<")");
+					exit(0);
+				}
+				if(!finish && xzOut.avail_in == 0)	break;
+			}
+			break;
+		}
+#endif
+#ifdef TRACE_ZSTD
+		case CODEC_ZSTD: {
+			ZSTD_inBuffer in = {outBuf.empty() ? NULL : &outBuf[0], outBuf.size(), 0};
+			while(true) {
+				ZSTD_outBuffer out = {&compBuf[0], compBuf.size(), 0};
+				size_t remain = ZSTD_compressStream2(zstdOut, &out, &in, finish ? ZSTD_e_end : ZSTD_e_continue);
+				if(ZSTD_isError(remain)) {
+					ERROR(" == Error - zstd trace compression failed ("<<ZSTD_getErrorName(remain)<<")");
+					exit(0);
+				}
+				fwrite(&compBuf[0], 1, out.pos, file);
+				if(finish ? remain == 0 : in.pos == in.size)	break;
+			}
+			break;
+		}
+#endif
+		default:
+			break;
+	}
+	outBuf.clear();
+}
+
+}
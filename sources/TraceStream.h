@@ -0,0 +1,153 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef TRACESTREAM_H
+#define TRACESTREAM_H
+
+//TraceStream.h
+//
+//Trace file streams with gzip, xz, and zstd compression
+// (each format is compiled with TRACE_GZIP, TRACE_XZ, and TRACE_ZSTD, which the Makefile defines if the library is found)
+//
+
+#include <stdio.h>		//FILE
+#include <stdint.h>		//uint64_t
+#include <atomic>		//atomic
+#include <string>		//string
+#include <thread>		//thread
+#include <vector>		//vector
+
+#ifdef TRACE_GZIP
+#include <zlib.h>
+#endif
+#ifdef TRACE_XZ
+#include <lzma.h>
+#endif
+#ifdef TRACE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "ConfigValue.h"
+#include "SPSCQueue.h"
+
+#define TRACE_CHUNK_SIZE	(1<<18)	//[byte] Decompressed chunk size
+#define TRACE_CHUNKS		4		//The number of chunks decompressed ahead (power of two)
+
+using namespace std;
+
+namespace CasHMC
+{
+
+enum TraceCodec
+{
+	CODEC_PLAIN,
+	CODEC_GZIP,
+	CODEC_XZ,
+	CODEC_ZSTD
+};
+
+string CodecName(TraceCodec codec);
+
+//Decompressed chunk handed from decompression thread to the line reader
+class TraceChunk
+{
+public:
+	TraceChunk():index(0), size(0) {}
+	TraceChunk(unsigned i, unsigned s):index(i), size(s) {}
+
+	unsigned index;		//Chunk buffer index
+	unsigned size;		//[byte] 0 at the end of file
+};
+
+//
+//Input trace stream (the format is detected by magic bytes, and chunks are decompressed on a helper thread)
+//
+class TraceInStream
+{
+public:
+	//
+	//Functions
+	//
+	TraceInStream(string fileName);
+	virtual ~TraceInStream();
+	void GetLine(string &line);
+	bool Eof() {return eof;}
+	void DecodeLoop();
+	unsigned Decode(char *buf, unsigned size);
+	bool FillInput();
+
+	//
+	//Fields
+	//
+	TraceCodec codec;
+	FILE *file;
+	bool eof;			//The same as ifstream::eof() after getline
+	vector<vector<char> > chunkBuf;
+	SPSCQueue<TraceChunk> fullChunks;	//Decompression thread -> line reader
+	SPSCQueue<unsigned> freeChunks;		//Line reader -> decompression thread
+	TraceChunk curChunk;
+	unsigned curPos;
+	bool chunkValid;
+	thread decodeThread;
+	atomic<bool> stopped;
+
+	//Compressed input of decoders
+	vector<char> inBuf;
+	unsigned inPos;
+	unsigned inSize;
+	bool inEnd;			//All compressed input is read
+	bool decodeEnd;		//All data is decompressed
+#ifdef TRACE_GZIP
+	gzFile gzIn;
+#endif
+#ifdef TRACE_XZ
+	lzma_stream xzIn;
+#endif
+#ifdef TRACE_ZSTD
+	ZSTD_DStream *zstdIn;
+#endif
+};
+
+//
+//Output trace stream (compressed by the file extension: .gz, .xz, or .zst)
+//
+class TraceOutStream
+{
+public:
+	//
+	//Functions
+	//
+	TraceOutStream(string fileName);
+	virtual ~TraceOutStream();
+	void Write(const string &str);
+	void Flush(bool finish);
+
+	//
+	//Fields
+	//
+	TraceCodec codec;
+	FILE *file;
+	vector<char> outBuf;	//Uncompressed data waiting to be written
+	vector<char> compBuf;
+#ifdef TRACE_GZIP
+	gzFile gzOut;
+#endif
+#ifdef TRACE_XZ
+	lzma_stream xzOut;
+#endif
+#ifdef TRACE_ZSTD
+	ZSTD_CStream *zstdOut;
+#endif
+};
+
+}
+
+#endif
@@ -17,13 +17,65 @@
 #include <vector>		//vector
 #include <iostream> 	//ostream
 #include <stdint.h>		//uint64_t
+#include <math.h>		//ceil
+#include <string>		//string
 
 #include "ConfigValue.h"
 
 using namespace std;
 
+#define NUM_STAGE_HIST	128		//The number of log-linear latency histogram buckets per stage
+
 namespace CasHMC
 {
+
+//Latency stages of one transaction (each stage starts at the hand-off stamped in TranTrace)
+enum LatencyStage
+{
+	STAGE_HC_QUEUE,		//HMC controller queueing
+	STAGE_LINK_MASTER,	//Link master buffer and token stall
+	STAGE_LINK_RETRY,	//Link retry (from the first to the last transmission)
+	STAGE_LINK_SERIAL,	//Link serialization, CRC, and link slave buffer
+	STAGE_CROSSBAR,		//Crossbar switch queueing and segmentation
+	STAGE_VAULT_BUF,	//Vault controller input buffer
+	STAGE_CMD_QUEUE,	//Command queue wait
+	STAGE_DRAM,			//DRAM service
+	STAGE_RETURN,		//Return path (response packet to HMC controller)
+	NUM_STAGES
+};
+
+string inline StageName(int stage)
+{
+	switch(stage) {
+		case STAGE_HC_QUEUE:	return "HC queue";
+		case STAGE_LINK_MASTER:	return "Link master";
+		case STAGE_LINK_RETRY:	return "Link retry";
+		case STAGE_LINK_SERIAL:	return "Link serial";
+		case STAGE_CROSSBAR:	return "Crossbar";
+		case STAGE_VAULT_BUF:	return "Vault buffer";
+		case STAGE_CMD_QUEUE:	return "Command queue";
+		case STAGE_DRAM:		return "DRAM";
+		case STAGE_RETURN:		return "Return path";
+		default:				return "Unknown";
+	}
+}
+
+//
+//Log-linear histogram bucket (exact under 8 clocks, then 4 sub-buckets per power of two)
+//
+unsigned inline HistBucket(unsigned lat)
+{
+	if(lat < 8)	return lat;
+	unsigned exp = 31 - __builtin_clz(lat);
+	return 8 + (exp-3)*4 + ((lat >> (exp-2)) & 3);
+}
+
+unsigned inline HistBucketValue(unsigned bucket)
+{
+	if(bucket < 8)	return bucket;
+	unsigned exp = (bucket-8)/4 + 3;
+	return (4 + (bucket-8)%4) << (exp-2);
+}
 	
 class TranStatistic
 {
@@ -67,6 +119,16 @@ public:
 		totalUpLinkTransmitSize = vector<uint64_t>(1, 0);
 		totalDownLinkDataSize = vector<uint64_t>(1, 0);
 		totalUpLinkDataSize = vector<uint64_t>(1, 0);
+		
+		stageCount = 0;		totalStageCount = 0;
+		for(int s=0; s<NUM_STAGES; s++) {
+			stageSum[s] = 0;	totalStageSum[s] = 0;
+			stageMax[s] = 0;	totalStageMax[s] = 0;
+			for(int b=0; b<NUM_STAGE_HIST; b++) {
+				stageHist[s][b] = 0;
+				totalStageHist[s][b] = 0;
+			}
+		}
 	}
 	virtual ~TranStatistic() {
 		tranFullLat.clear();
@@ -104,6 +166,20 @@ public:
 			totalUpLinkDataSize.push_back(0);
 		}		
 	}
+	//Every counter is cleared, and statistics restart from the current clock
+	void ResetStatis() {
+		*this = TranStatistic();
+		PushStatisPerLink();
+		PushStatisPerClass();
+	}
+	void PushStatisPerClass() {
+		for(int i=0; i<QOS_CLASSES; i++) {
+			classCount.push_back(0);
+			classSum.push_back(0);
+			classMax.push_back(0);
+			classHist.push_back(vector<uint64_t>(NUM_STAGE_HIST, 0));
+		}
+	}
 	void UpdateStatis(unsigned tranFull, unsigned linkFull, unsigned vaultFull) {
 		tranFullLat.push_back(tranFull);
 		linkFullLat.push_back(linkFull);
@@ -113,6 +189,53 @@ public:
 		linkFullSum += linkFull;
 		vaultFullSum += vaultFull;
 	}
+	void UpdateStageStatis(unsigned *stageLat) {
+		for(int s=0; s<NUM_STAGES; s++) {
+			stageSum[s] += stageLat[s];
+			stageMax[s] = max(stageLat[s], stageMax[s]);
+			stageHist[s][HistBucket(stageLat[s])]++;
+		}
+		stageCount++;
+	}
+	void UpdateClassStatis(unsigned priority, unsigned tranFull) {
+		classCount[priority]++;
+		classSum[priority] += tranFull;
+		classMax[priority] = max(tranFull, classMax[priority]);
+		classHist[priority][HistBucket(tranFull)]++;
+	}
+	//Link statistics counted by the cube thread are moved at synchronization points (PIPELINE_SIM)
+	void MergeLinkStatis(TranStatistic &cube) {
+		MovePerLink(readPerLink, cube.readPerLink);
+		MovePerLink(writePerLink, cube.writePerLink);
+		MovePerLink(atomicPerLink, cube.atomicPerLink);
+		MovePerLink(reqPerLink, cube.reqPerLink);
+		MovePerLink(resPerLink, cube.resPerLink);
+		MovePerLink(flowPerLink, cube.flowPerLink);
+		MovePerLink(errorPerLink, cube.errorPerLink);
+		MovePerLink(retryFailPerLink, cube.retryFailPerLink);
+		MovePerLink(downLinkTransmitSize, cube.downLinkTransmitSize);
+		MovePerLink(upLinkTransmitSize, cube.upLinkTransmitSize);
+		MovePerLink(downLinkDataSize, cube.downLinkDataSize);
+		MovePerLink(upLinkDataSize, cube.upLinkDataSize);
+		errorRetryLat.insert(errorRetryLat.end(), cube.errorRetryLat.begin(), cube.errorRetryLat.end());
+		cube.errorRetryLat.clear();
+	}
+	template <typename T>
+	void MovePerLink(vector<T> &to, vector<T> &from) {
+		for(unsigned i=0; i<to.size() && i<from.size(); i++) {
+			to[i] += from[i];
+			from[i] = 0;
+		}
+	}
+	unsigned HistPercentile(uint64_t *hist, uint64_t count, double percent) {
+		uint64_t target = (uint64_t)ceil(count*percent/100);
+		uint64_t accu = 0;
+		for(int b=0; b<NUM_STAGE_HIST; b++) {
+			accu += hist[b];
+			if(accu >= target && accu > 0)	return HistBucketValue(b);
+		}
+		return 0;
+	}
 	
 	//Bookkeeping and statistics
 	vector<unsigned> tranFullLat;
@@ -170,6 +293,24 @@ public:
 	double totalVaultStdSum;
 	double totalErrorStdSum;
 	
+	//Per-stage latency breakdown [CPU clock] (histograms have constant memory)
+	uint64_t stageCount;
+	uint64_t stageSum[NUM_STAGES];
+	unsigned stageMax[NUM_STAGES];
+	uint64_t stageHist[NUM_STAGES][NUM_STAGE_HIST];
+	uint64_t totalStageCount;
+	uint64_t totalStageSum[NUM_STAGES];
+	unsigned totalStageMax[NUM_STAGES];
+	uint64_t totalStageHist[NUM_STAGES][NUM_STAGE_HIST];
+	vector<vector<double> > epochStageMean;	//Stacked latency attribution per epoch
+	vector<vector<double> > epochEnergy;	//HMC bandwidth, DRAM energy, link energy, and data bits per epoch
+	
+	//Transaction latency per QoS class [CPU clock]
+	vector<uint64_t> classCount;
+	vector<uint64_t> classSum;
+	vector<unsigned> classMax;
+	vector<vector<uint64_t> > classHist;
+	
 	uint64_t totalHmcTransmitSize;
 	vector<uint64_t> totalDownLinkTransmitSize;
 	vector<uint64_t> totalUpLinkTransmitSize;
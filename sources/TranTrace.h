@@ -15,11 +15,15 @@
 //TranTrace.h
 
 #include <stdint.h>		//uint64_t
+#include <math.h>		//ceil
+#include <algorithm>	//min, max
 
 #include "TranStatistic.h"
 
 using namespace std;
 
+#define STAMP_UNSET		0xFFFFFFFFFFFFFFFFULL
+
 namespace CasHMC
 {
 
@@ -33,6 +37,10 @@ public:
 		linkFullLat = 0;
 		vaultIssueTime = 0;
 		vaultFullLat = 0;
+		priority = 0;
+		for(int s=0; s<=NUM_STAGES; s++) {
+			stageStamp[s] = STAMP_UNSET;
+		}
 	}
 	~TranTrace() {
 		if(tranFullLat==0 || linkFullLat==0 || vaultFullLat==0) {
@@ -42,9 +50,35 @@ public:
 		}
 		else {
 			statis->UpdateStatis(tranFullLat, linkFullLat, vaultFullLat);
+			
+			//Missing or reordered stamps are merged into the previous stage
+			unsigned stageLat[NUM_STAGES];
+			uint64_t endTime = (uint64_t)tranTransmitTime + tranFullLat;
+			uint64_t prev = tranTransmitTime;
+			for(int s=1; s<=NUM_STAGES; s++) {
+				uint64_t cur = (s==NUM_STAGES || stageStamp[s]==STAMP_UNSET) ? prev : stageStamp[s];
+				if(s == NUM_STAGES)	cur = endTime;
+				cur = min(max(cur, prev), endTime);
+				stageLat[s-1] = cur - prev;
+				prev = cur;
+			}
+			statis->UpdateStageStatis(stageLat);
+			statis->UpdateClassStatis(priority, tranFullLat);
 		}
 	}
 	
+	//Stamp the start of a latency stage (CPU clock)
+	void Stamp(LatencyStage stage, uint64_t cpuClock) {
+		stageStamp[stage] = cpuClock;
+	}
+	void StampFirst(LatencyStage stage, uint64_t cpuClock) {
+		if(stageStamp[stage] == STAMP_UNSET)	stageStamp[stage] = cpuClock;
+	}
+	//Stamp with HMC clock (tCK) converted into CPU clock
+	void StampHMC(LatencyStage stage, uint64_t hmcClock) {
+		stageStamp[stage] = ceil((double)hmcClock * (double)tCK/CPU_CLK_PERIOD);
+	}
+	
 	//Identifier
 	TranStatistic *statis;
 	
@@ -57,6 +91,10 @@ public:
 	
 	unsigned vaultIssueTime; 	//[DRAM clock (tCK)] Time to issue ACTIVATE command corresponding to this transaction
 	unsigned vaultFullLat; 		//[DRAM clock (tCK)] Total latency time from issue ACTIVATE command to return data
+	
+	unsigned priority;			//QoS class of transaction
+	
+	uint64_t stageStamp[NUM_STAGES+1];	//[CPU clock] Start time of each latency stage (LatencyStage)
 };
 
 }
@@ -13,17 +13,20 @@
 
 using namespace std;
 
-extern unsigned tranGlobalID;
+extern thread_local unsigned tranGlobalID;
 
 namespace CasHMC
 {
 	
-Transaction::Transaction(TransactionType tranType, uint64_t addr, unsigned size, TranStatistic *statis):
+Transaction::Transaction(TransactionType tranType, uint64_t addr, unsigned size, TranStatistic *statis, uint8_t *dt, unsigned prio):
 	transactionType(tranType),
 	address(addr),
-	dataSize(size)
+	dataSize(size),
+	data(dt),
+	priority(prio)
 {
 	LNG = 1;
+	bypassed = 0;
 	transactionID = tranGlobalID++;
 	trace = new TranTrace(statis);
 }
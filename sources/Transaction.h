@@ -47,7 +47,7 @@ public:
 	//
 	//Functions
 	//
-	Transaction(TransactionType tranType, uint64_t addr, unsigned size, TranStatistic *statis);
+	Transaction(TransactionType tranType, uint64_t addr, unsigned size, TranStatistic *statis, uint8_t *dt=NULL, unsigned prio=0);
 	virtual ~Transaction();
 	void ReductGlobalID();
 
@@ -60,8 +60,14 @@ public:
 	unsigned dataSize;					//[byte] Size of data
 	unsigned transactionID;				//Unique identifier
 	unsigned LNG;
+	uint8_t *data;						//Host data buffer (write data and atomic operand, or read data destination)
+	unsigned priority;					//QoS class (0 is the lowest)
+	unsigned bypassed;					//The number of times bypassed by higher-priority transactions
 };
 
+//Buffer space of a transaction (packets take one space per flit)
+unsigned inline BufferLength(const Transaction *tran) {return tran->LNG;}
+
 ostream& operator<<(ostream &out, const Transaction &t);
 }
 
@@ -25,6 +25,8 @@ VaultController::VaultController(ofstream &debugOut_, ofstream &stateOut_, unsig
 	powerDown = false;
 	poppedCMD = NULL;
 	atomicCMD = NULL;
+	tagPool = NULL;
+	upPipe = NULL;
 	atomicOperLeft = 0;
 	pendingDataSize = 0;
 	
@@ -35,6 +37,7 @@ VaultController::VaultController(ofstream &debugOut_, ofstream &stateOut_, unsig
 	
 	//Make class objects
 	commandQueue = new CommandQueue(debugOut, stateOut, vaultContID, this);
+	vaultMemory = (FUNCTIONAL_MEM ? new VaultMemory() : NULL);
 }
 
 VaultController::~VaultController()
@@ -44,6 +47,9 @@ VaultController::~VaultController()
 	writeDataCountdown.clear(); 
 
 	delete commandQueue;
+	if(vaultMemory != NULL) {
+		delete vaultMemory;
+	}
 }
 
 //
@@ -62,7 +68,7 @@ void VaultController::CallbackReceiveDown(Packet *downEle, bool chkReceive)
 void VaultController::CallbackReceiveUp(Packet *upEle, bool chkReceive)
 {
 	if(chkReceive) {
-		switch(upEle->CMD) {
+		switch(upEle->CMD()) {
 			case RD_RS:	DE_CR(ALI(18)<<header<<ALI(15)<<*upEle<<"Up)   RETURNING read data response packet");	break;
 			case WR_RS:	DE_CR(ALI(18)<<header<<ALI(15)<<*upEle<<"Up)   RETURNING write response packet");		break;
 			default:
@@ -73,7 +79,7 @@ void VaultController::CallbackReceiveUp(Packet *upEle, bool chkReceive)
 	}
 	else {
 		ERROR(header<<"  == Error - Vault controller upstream packet buffer FULL  "<<*upEle<<"  (CurrentClock : "<<currentClockCycle<<")");
-		ERROR(header<<"             Vault buffer max size : "<<upBufferMax<<", current size : "<<upBuffers.size()<<", "<<*upEle<<" size : "<<upEle->LNG);
+		ERROR(header<<"             Vault buffer max size : "<<upBufferMax<<", current size : "<<upBuffers.size()<<", "<<*upEle<<" size : "<<upEle->LNG());
 		exit(0);
 	}
 }	
@@ -99,6 +105,10 @@ void VaultController::ReturnCommand(DRAMCommand *retCMD)
 					DE_CR(ALI(18)<<header<<ALI(15)<<*atomicCMD<<"Up)   RETURNING ATOMIC read data");
 				}
 				else {
+					//Read data is copied into host buffer when DRAM returns it (valid when the read callback is called)
+					if(vaultMemory != NULL && retCMD->payload != NULL) {
+						vaultMemory->Read(retCMD->address, retCMD->dataSize, retCMD->payload);
+					}
 					MakeRespondPacket(retCMD);
 					delete retCMD;
 				}
@@ -124,6 +134,7 @@ void VaultController::MakeRespondPacket(DRAMCommand *retCMD)
 {
 	if(retCMD->trace != NULL) {
 		retCMD->trace->vaultFullLat = currentClockCycle - retCMD->trace->vaultIssueTime;
+		retCMD->trace->StampHMC(STAGE_RETURN, currentClockCycle);
 	}
 	Packet *newPacket;
 	if(retCMD->atomic) {
@@ -155,8 +166,12 @@ void VaultController::MakeRespondPacket(DRAMCommand *retCMD)
 			exit(0);
 		}
 	}
-	ReverseAddressMapping(newPacket->ADRS, retCMD->bank, retCMD->column, retCMD->row);
+	uint64_t physicalAddress;
+	ReverseAddressMapping(physicalAddress, retCMD->bank, retCMD->column, retCMD->row);
+	newPacket->SetADRS(physicalAddress);
 	newPacket->segment = retCMD->segment;
+	newPacket->SetAF(retCMD->atomicFlag);
+	newPacket->priority = retCMD->priority;
 	ReceiveUp(newPacket);
 }
 
@@ -174,7 +189,10 @@ void VaultController::Update()
 			//Make sure that buffer[0] is not virtual tail packet.
 			if(downBuffers[i] != NULL) {
 				if(ConvPacketIntoCMDs(downBuffers[i])) {
-					int tempLNG = downBuffers[i]->LNG;
+					if(downBuffers[i]->trace != NULL) {
+						downBuffers[i]->trace->StampHMC(STAGE_CMD_QUEUE, currentClockCycle);
+					}
+					int tempLNG = downBuffers[i]->LNG();
 					delete downBuffers[i];
 					downBuffers.erase(downBuffers.begin()+i, downBuffers.begin()+i+tempLNG);
 				}
@@ -192,7 +210,7 @@ void VaultController::Update()
 		else{
 			if(upBufferDest->ReceiveUp(upBuffers[0])) {
 				DEBUG(ALI(18)<<header<<ALI(15)<<*upBuffers[0]<<"Up)   SENDING packet to crossbar switch (CS)");
-				upBuffers.erase(upBuffers.begin(), upBuffers.begin()+upBuffers[0]->LNG);
+				upBuffers.erase(upBuffers.begin(), upBuffers.begin()+upBuffers[0]->LNG());
 			}
 			else {
 				//DEBUG(ALI(18)<<header<<ALI(15)<<*upBuffers[0]<<"Up)   Crossbar switch buffer FULL");	
@@ -201,7 +219,9 @@ void VaultController::Update()
 	}
 	
 	//Pop command from command queue
-	if(commandQueue->CmdPop(&poppedCMD)) {
+	bool popped;
+	PROFILE_CALL(commandQueue->profile, popped = commandQueue->CmdPop(&poppedCMD));
+	if(popped) {
 		//Write data command will be issued after countdown
 		if(poppedCMD->commandType == WRITE || poppedCMD->commandType == WRITE_P) {
 			DRAMCommand *writeData = new DRAMCommand(*poppedCMD);
@@ -249,8 +269,25 @@ void VaultController::Update()
 	//Atomic command operation (assume that all operations consume one clock cycle)
 	if(atomicCMD != NULL) {
 		if(atomicOperLeft == 0) {
+			bool writeBack = (atomicCMD->packetCMD != EQ16 && atomicCMD->packetCMD != EQ8);
+			if(vaultMemory != NULL) {
+				//Returning atomics overwrite the host operand buffer with the original memory data
+				bool returnData = !(atomicCMD->posted || atomicCMD->packetCMD == _2ADD8 || atomicCMD->packetCMD == ADD16
+									|| atomicCMD->packetCMD == INC8 || atomicCMD->packetCMD == EQ8
+									|| atomicCMD->packetCMD == EQ16 || atomicCMD->packetCMD == BWR);
+				atomicCMD->atomicFlag = vaultMemory->ExecuteAtomic(atomicCMD->packetCMD, atomicCMD->address, atomicCMD->payload,
+																	(returnData ? atomicCMD->payload : NULL), writeBack);
+				if(!writeBack) {
+					//The bank locked by atomic command is released without write-back
+					if(commandQueue->atomicLock[atomicCMD->bank] && commandQueue->atomicLockTag[atomicCMD->bank] == atomicCMD->packetTAG) {
+						commandQueue->atomicLock[atomicCMD->bank] = false;
+						commandQueue->atomicLockTag[atomicCMD->bank] = 0;
+					}
+					DEBUG(ALI(18)<<(commandQueue->header+")")<<ALI(15)<<*atomicCMD<<"Down) Atomic result write-back is SKIPPED (atomic flag : "<<atomicCMD->atomicFlag<<")");
+				}
+			}
 			//The results are written back to DRAM, overwriting the original memory operands
-			if(atomicCMD->packetCMD != EQ16 && atomicCMD->packetCMD != EQ8) {
+			if(writeBack) {
 				DRAMCommand *atmRstCMD = new DRAMCommand(*atomicCMD);
 				atmRstCMD->commandType = (OPEN_PAGE ? WRITE : WRITE_P);
 				atmRstCMD->dataSize = 16;
@@ -285,7 +322,7 @@ void VaultController::Update()
 	//Power-down mode setting
 	EnablePowerdown();
 
-	commandQueue->Update();
+	PROFILE_CALL(commandQueue->profile, commandQueue->Update());
 	Step();
 }
 
@@ -301,6 +338,7 @@ void VaultController::UpdateCountdown()
 			DE_CR(ALI(18)<<header<<ALI(15)<<*cmdBus<<"Down) ISSUING command to DRAM");
 			if(cmdBus->trace != NULL && cmdBus->trace->vaultIssueTime == 0) {
 				cmdBus->trace->vaultIssueTime = currentClockCycle;
+				cmdBus->trace->StampHMC(STAGE_DRAM, currentClockCycle);
 			}
 			dramP->receiveCMD(cmdBus);
 			cmdBus = NULL;
@@ -312,14 +350,24 @@ void VaultController::UpdateCountdown()
 		if(dataCyclesLeft == 0) {
 			DE_CR(ALI(18)<<header<<ALI(15)<<*dataBus<<"Down) ISSUING data corresponding to previous write command");
 			if(dataBus->lastCMD) {
+				if(vaultMemory != NULL && !dataBus->atomic && dataBus->payload != NULL) {
+					vaultMemory->Write(dataBus->address, dataBus->dataSize, dataBus->payload);
+				}
 				if(!dataBus->atomic && !dataBus->posted) {
 					MakeRespondPacket(dataBus);
 				}
-				else if(dataBus->trace != NULL && dataBus->posted) {
+				if(dataBus->posted && upPipe != NULL) {
+					upPipe->PushTagFree(dataBus->packetTAG);
+				}
+				else if(dataBus->posted && tagPool != NULL) {
+					tagPool->Free(dataBus->packetTAG);
+				}
+				if(dataBus->trace != NULL && dataBus->posted) {
 					dataBus->trace->tranFullLat = ceil((double)currentClockCycle * (double)tCK/CPU_CLK_PERIOD) - dataBus->trace->tranTransmitTime;
 					dataBus->trace->linkFullLat = ceil((double)currentClockCycle * (double)tCK/CPU_CLK_PERIOD) - dataBus->trace->linkTransmitTime;
 					dataBus->trace->vaultFullLat = currentClockCycle - dataBus->trace->vaultIssueTime;
-					delete dataBus->trace;
+					if(upPipe != NULL)	upPipe->PushTrace(dataBus->trace);
+					else				delete dataBus->trace;
 				}
 			}
 			dramP->receiveCMD(dataBus);
@@ -348,10 +396,30 @@ void VaultController::UpdateCountdown()
 	//Time for a refresh issue a refresh
 	refreshCountdown--;
 	if(refreshCountdown == 0) {
-		commandQueue->refreshWaiting = true;
-		refreshCountdown = REFRESH_PERIOD/tCK;
+		//Per-bank refresh is issued NUM_BANKS times more frequently
+		if(REFRESH_POLICY == PER_BANK) {
+			commandQueue->refreshWaiting = true;
+			refreshCountdown = max(REFRESH_PERIOD/tCK/NUM_BANKS, 1.0);
+		}
+		//Elastic refresh is postponed while the command queue is busy
+		else if(REFRESH_POLICY == ELASTIC) {
+			commandQueue->refreshPending++;
+			commandQueue->epochRefStat.postponedMax = max(commandQueue->epochRefStat.postponedMax, (uint64_t)commandQueue->refreshPending);
+			refreshCountdown = REFRESH_PERIOD/tCK;
+		}
+		else {
+			commandQueue->refreshWaiting = true;
+			refreshCountdown = REFRESH_PERIOD/tCK;
+		}
 		DEBUG(ALI(39)<<header<<"REFRESH countdown is over");
 	}
+	//Postponed refreshes are caught up when the command queue is idle, or forced at the maximum postponement
+	if(REFRESH_POLICY == ELASTIC && !commandQueue->refreshWaiting && commandQueue->refreshPending > 0) {
+		if(commandQueue->refreshPending >= REFRESH_MAX_POSTPONE || commandQueue->isEmpty()) {
+			commandQueue->refreshWaiting = true;
+			commandQueue->refreshPending--;
+		}
+	}
 	//If a rank is powered down, make sure we power it up in time for a refresh
 	else if(powerDown && refreshCountdown<=tXP)	{
 	}
@@ -363,12 +431,12 @@ void VaultController::UpdateCountdown()
 bool VaultController::ConvPacketIntoCMDs(Packet *packet)
 {
 	unsigned bankAdd, colAdd, rowAdd;
-	AddressMapping(packet->ADRS, bankAdd, colAdd, rowAdd);
+	AddressMapping(packet->ADRS(), bankAdd, colAdd, rowAdd);
 	
 	DRAMCommandType tempCMD;
 	bool tempPosted = false;
 	bool atomic = false;
-	switch(packet->CMD) {
+	switch(packet->CMD()) {
 		//Write
 		case WR16:		tempCMD = OPEN_PAGE ? WRITE : WRITE_P;	break;
 		case WR32:		tempCMD = OPEN_PAGE ? WRITE : WRITE_P;	break;
@@ -438,30 +506,34 @@ bool VaultController::ConvPacketIntoCMDs(Packet *packet)
 	
 	//Due to the internal 32-byte granularity of the DRAM data bus within each vault in the HMC (HMC spec v2.1 p.99)
 	if(commandQueue->AvailableSpace(bankAdd, ceil((double)packet->reqDataSize/32)+1)) {
-		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) phyAdd : 0x"<<hex<<setw(9)<<setfill('0')<<packet->ADRS<<dec<<"  bankAdd : "<<bankAdd<<"  colAdd : "<<colAdd<<"  rowAdd : "<<rowAdd);
+		DEBUG(ALI(18)<<header<<ALI(15)<<*packet<<"Down) phyAdd : 0x"<<hex<<setw(9)<<setfill('0')<<packet->ADRS()<<dec<<"  bankAdd : "<<bankAdd<<"  colAdd : "<<colAdd<<"  rowAdd : "<<rowAdd);
 		//cmdtype, tag, bnk, col, rw, *dt, dSize, pst, *lat
-		DRAMCommand *actCMD = new DRAMCommand(ACTIVATE, packet->TAG, bankAdd, colAdd, rowAdd, 0, false, packet->trace, true, packet->CMD, atomic, packet->segment);
+		DRAMCommand *actCMD = new DRAMCommand(ACTIVATE, packet->TAG(), bankAdd, colAdd, rowAdd, 0, false, packet->trace, true, packet->CMD(), atomic, packet->segment);
+		actCMD->priority = packet->priority;
 		commandQueue->Enqueue(bankAdd, actCMD);
 		
 		for(int i=0; i<ceil((double)packet->reqDataSize/32); i++) {
 			DRAMCommand *rwCMD;
 			if(i < ceil((double)packet->reqDataSize/32)-1) {
 				if(tempCMD == WRITE_P) {
-					rwCMD = new DRAMCommand(WRITE, packet->TAG, bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, false, packet->CMD, atomic, packet->segment);
+					rwCMD = new DRAMCommand(WRITE, packet->TAG(), bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, false, packet->CMD(), atomic, packet->segment);
 				}
 				else if(tempCMD == READ_P) {
-					rwCMD = new DRAMCommand(READ, packet->TAG, bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, false, packet->CMD, atomic, packet->segment);
+					rwCMD = new DRAMCommand(READ, packet->TAG(), bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, false, packet->CMD(), atomic, packet->segment);
 				}
 				else {
-					rwCMD = new DRAMCommand(tempCMD, packet->TAG, bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, false, packet->CMD, atomic, packet->segment);
+					rwCMD = new DRAMCommand(tempCMD, packet->TAG(), bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, false, packet->CMD(), atomic, packet->segment);
 				}
 			}
 			else {
-				rwCMD = new DRAMCommand(tempCMD, packet->TAG, bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, true, packet->CMD, atomic, packet->segment);
+				rwCMD = new DRAMCommand(tempCMD, packet->TAG(), bankAdd, colAdd, rowAdd, packet->reqDataSize, tempPosted, packet->trace, true, packet->CMD(), atomic, packet->segment);
 			}
+			rwCMD->address = packet->ADRS();
+			rwCMD->payload = packet->payload;
+			rwCMD->priority = packet->priority;
 			commandQueue->Enqueue(bankAdd, rwCMD);
 			if(tempCMD == READ || tempCMD == READ_P) {
-				pendingReadData.push_back(packet->TAG);
+				pendingReadData.push_back(packet->TAG());
 			}
 		}
 		return true;
@@ -476,20 +548,8 @@ bool VaultController::ConvPacketIntoCMDs(Packet *packet)
 //
 void VaultController::AddressMapping(uint64_t physicalAddress, unsigned &bankAdd, unsigned &colAdd, unsigned &rowAdd)
 {
-	unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
-	physicalAddress >>= maxBlockBit/*max block bits*/ + _log2(NUM_VAULTS)/*vault address bits*/;
-	
-	//Extract bank address
-	bankAdd = physicalAddress & (NUM_BANKS-1);
-	physicalAddress >>= _log2(NUM_BANKS);
-	
-	//Extract column address
-	colAdd = physicalAddress & ((NUM_COLS-1)>>maxBlockBit);
-	colAdd <<= maxBlockBit;
-	physicalAddress >>= (_log2(NUM_COLS)-maxBlockBit);
-	
-	//Extract row address
-	rowAdd = physicalAddress & (NUM_ROWS-1);
+	unsigned vaultAdd;
+	addressMap->Decode(physicalAddress, vaultAdd, bankAdd, colAdd, rowAdd);
 }
 
 //
@@ -497,19 +557,7 @@ void VaultController::AddressMapping(uint64_t physicalAddress, unsigned &bankAdd
 //
 void VaultController::ReverseAddressMapping(uint64_t &physicalAddress, unsigned bankAdd, unsigned colAdd, unsigned rowAdd)
 {
-	unsigned maxBlockBit = _log2(ADDRESS_MAPPING);
-	
-	physicalAddress = rowAdd;
-	physicalAddress <<= (_log2(NUM_COLS)-maxBlockBit);
-	physicalAddress += (colAdd>>maxBlockBit);
-	
-	physicalAddress <<= _log2(NUM_BANKS);
-	physicalAddress += bankAdd;
-	
-	physicalAddress <<= _log2(NUM_VAULTS);
-	physicalAddress += vaultContID;
-	
-	physicalAddress <<= maxBlockBit;
+	physicalAddress = addressMap->Encode(vaultContID, bankAdd, colAdd, rowAdd);
 }
 
 //
@@ -523,7 +571,7 @@ void VaultController::EnablePowerdown()
 				powerDown = true;
 			}
 		}
-		else if(powerDown && dramP->bankStates[0]->nextPowerUp <= currentClockCycle) {
+		else if(powerDown && dramP->bankStates.nextPowerUp[0] <= currentClockCycle) {
 			dramP->powerUp();
 			powerDown = false;
 		}
@@ -23,6 +23,10 @@
 #include "DRAMCommand.h"
 #include "CommandQueue.h"
 #include "DRAM.h" 
+#include "VaultMemory.h"
+#include "AddressMap.h"
+#include "TagPool.h"
+#include "LinkPipe.h"
 using namespace std;
 
 namespace CasHMC
@@ -57,6 +61,10 @@ public:
 	
 	DRAM *dramP;
 	CommandQueue *commandQueue;
+	VaultMemory *vaultMemory;			//Functional memory image (NULL if FUNCTIONAL_MEM is disabled)
+	AddressMap *addressMap;				//Shared with crossbar switch
+	TagPool *tagPool;					//Tag pool of HMC controller (posted request tags are freed on completion)
+	LinkPipe *upPipe;					//Tags and traces of posted requests are handed to the host thread (PIPELINE_SIM)
 	DRAMCommand *poppedCMD;
 	DRAMCommand *atomicCMD;
 	unsigned atomicOperLeft;
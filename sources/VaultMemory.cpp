@@ -0,0 +1,172 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include "VaultMemory.h"
+
+namespace CasHMC
+{
+
+VaultMemory::VaultMemory()
+{
+	readBytes = 0;
+	writeBytes = 0;
+	atomicCnt = 0;
+	atomicFlagCnt = 0;
+	atomicSkipCnt = 0;
+}
+
+VaultMemory::~VaultMemory()
+{
+	for(map<uint64_t, uint8_t *>::iterator it=pages.begin(); it!=pages.end(); it++) {
+		delete[] it->second;
+	}
+	pages.clear();
+}
+
+//
+//Copy memory data into buffer (a request may cross the page boundary)
+//
+void VaultMemory::Read(uint64_t addr, unsigned size, uint8_t *buf)
+{
+	readBytes += size;
+	while(size > 0) {
+		unsigned offset = addr % MEM_PAGE_SIZE;
+		unsigned chunk = min(size, MEM_PAGE_SIZE - offset);
+		map<uint64_t, uint8_t *>::iterator it = pages.find(addr / MEM_PAGE_SIZE);
+		if(it == pages.end()) {
+			memset(buf, 0, chunk);
+		}
+		else {
+			memcpy(buf, it->second + offset, chunk);
+		}
+		addr += chunk;	buf += chunk;	size -= chunk;
+	}
+}
+
+//
+//Copy buffer data into memory (a page is allocated on the first write)
+//
+void VaultMemory::Write(uint64_t addr, unsigned size, const uint8_t *buf)
+{
+	writeBytes += size;
+	while(size > 0) {
+		unsigned offset = addr % MEM_PAGE_SIZE;
+		unsigned chunk = min(size, MEM_PAGE_SIZE - offset);
+		uint8_t *&page = pages[addr / MEM_PAGE_SIZE];
+		if(page == NULL) {
+			page = new uint8_t[MEM_PAGE_SIZE];
+			memset(page, 0, MEM_PAGE_SIZE);
+		}
+		memcpy(page + offset, buf, chunk);
+		addr += chunk;	buf += chunk;	size -= chunk;
+	}
+}
+
+//
+//Execute atomic operation on 16-byte memory operand (HMC spec v2.1 p.39-44)
+// operand : 16-byte request payload (CASEQ8 is [compare, swap], BWR is [data, mask])
+// original : original memory data to be returned (can be NULL)
+// writeBack : whether the result has to be written back to DRAM
+// return value is the atomic flag (AF) of the response packet
+//
+bool VaultMemory::ExecuteAtomic(PacketCommandType cmd, uint64_t addr, const uint8_t *operand, uint8_t *original, bool &writeBack)
+{
+	uint64_t mem[2], op[2] = {0, 0}, res[2];
+	Read(addr, 16, (uint8_t *)mem);
+	if(operand != NULL) {
+		memcpy(op, operand, 16);
+	}
+	res[0] = mem[0];	res[1] = mem[1];
+	
+	bool flag = false;
+	writeBack = true;
+	switch(cmd) {
+		//Arithmetic atomic
+		case _2ADD8:	case P_2ADD8:	case _2ADDS8R:
+			res[0] = mem[0] + op[0];
+			res[1] = mem[1] + op[1];
+			break;
+		case ADD16:		case P_ADD16:	case ADDS16R:
+			res[0] = mem[0] + op[0];
+			res[1] = mem[1] + op[1] + (res[0] < mem[0] ? 1 : 0);
+			break;
+		case INC8:		case P_INC8:
+			res[0] = mem[0] + 1;
+			break;
+		//Boolean atomic
+		case XOR16:		res[0] = mem[0] ^ op[0];		res[1] = mem[1] ^ op[1];		break;
+		case OR16:		res[0] = mem[0] | op[0];		res[1] = mem[1] | op[1];		break;
+		case NOR16:		res[0] = ~(mem[0] | op[0]);		res[1] = ~(mem[1] | op[1]);		break;
+		case AND16:		res[0] = mem[0] & op[0];		res[1] = mem[1] & op[1];		break;
+		case NAND16:	res[0] = ~(mem[0] & op[0]);		res[1] = ~(mem[1] & op[1]);		break;
+		//Comparison atomic (the write-back is skipped if the comparison fails)
+		case CASGT8:
+			flag = ((int64_t)op[0] > (int64_t)mem[0]);
+			if(flag)	res[0] = op[0];
+			break;
+		case CASLT8:
+			flag = ((int64_t)op[0] < (int64_t)mem[0]);
+			if(flag)	res[0] = op[0];
+			break;
+		case CASGT16:
+			flag = ((int64_t)op[1] > (int64_t)mem[1]) || (op[1] == mem[1] && op[0] > mem[0]);
+			if(flag)	{res[0] = op[0];	res[1] = op[1];}
+			break;
+		case CASLT16:
+			flag = ((int64_t)op[1] < (int64_t)mem[1]) || (op[1] == mem[1] && op[0] < mem[0]);
+			if(flag)	{res[0] = op[0];	res[1] = op[1];}
+			break;
+		case CASEQ8:
+			flag = (op[0] == mem[0]);
+			if(flag)	res[0] = op[1];
+			break;
+		case CASZERO16:
+			flag = (mem[0] == 0 && mem[1] == 0);
+			if(flag)	{res[0] = op[0];	res[1] = op[1];}
+			break;
+		case EQ16:
+			flag = (op[0] == mem[0] && op[1] == mem[1]);
+			writeBack = false;
+			break;
+		case EQ8:
+			flag = (op[0] == mem[0]);
+			writeBack = false;
+			break;
+		//Bitwise atomic
+		case BWR:		case P_BWR:		case BWR8R:
+			res[0] = (mem[0] & ~op[1]) | (op[0] & op[1]);
+			break;
+		case SWAP16:
+			res[0] = op[0];		res[1] = op[1];
+			break;
+		default:
+			ERROR("  == Error - WRONG atomic command type ["<<cmd<<"] for functional memory");
+			exit(0);
+	}
+	
+	if(cmd == CASGT8 || cmd == CASLT8 || cmd == CASGT16 || cmd == CASLT16 || cmd == CASEQ8 || cmd == CASZERO16) {
+		writeBack = flag;
+	}
+	if(writeBack) {
+		Write(addr, 16, (uint8_t *)res);
+	}
+	else {
+		atomicSkipCnt++;
+	}
+	if(original != NULL) {
+		memcpy(original, mem, 16);
+	}
+	atomicCnt++;
+	if(flag)	atomicFlagCnt++;
+	return flag;
+}
+
+} //namespace CasHMC
@@ -0,0 +1,57 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef VAULTMEMORY_H
+#define VAULTMEMORY_H
+
+//VaultMemory.h
+
+#include <stdint.h>		//uint64_t
+#include <string.h>		//memcpy, memset
+#include <map>			//map
+
+#include "ConfigValue.h"
+#include "Packet.h"
+
+#define MEM_PAGE_SIZE	4096	//[byte] Allocation granularity of the functional memory image
+
+using namespace std;
+
+namespace CasHMC
+{
+
+//Sparse functional memory image of one vault (pages are allocated on the first write, untouched memory reads as zero)
+class VaultMemory
+{
+public:
+	//
+	//Functions
+	//
+	VaultMemory();
+	virtual ~VaultMemory();
+	void Read(uint64_t addr, unsigned size, uint8_t *buf);
+	void Write(uint64_t addr, unsigned size, const uint8_t *buf);
+	bool ExecuteAtomic(PacketCommandType cmd, uint64_t addr, const uint8_t *operand, uint8_t *original, bool &writeBack);
+
+	//
+	//Fields
+	//
+	map<uint64_t, uint8_t *> pages;		//Page number -> page data
+	uint64_t readBytes;
+	uint64_t writeBytes;
+	uint64_t atomicCnt;
+	uint64_t atomicFlagCnt;				//Atomic operations setting atomic flag (compare success or equal)
+	uint64_t atomicSkipCnt;				//Atomic write-backs skipped (compare fail or EQ)
+};
+
+}
+
+#endif
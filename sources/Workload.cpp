@@ -0,0 +1,337 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#include <math.h>		//pow
+#include <algorithm>	//lower_bound
+
+#include "Workload.h"
+
+#define MSHR_FREE		0xFFFFFFFFFFFFFFFFULL
+#define ZIPF_MAX_ITEMS	(1<<20)
+
+using namespace std;
+
+namespace CasHMC
+{
+
+//Valid request sizes of HMC read and write commands (16 - 256 byte mix)
+static const unsigned sizeMix[] = {16, 32, 48, 64, 80, 96, 112, 128, 256};
+
+Workload::Workload(CasHMCWrapper *wrapper, string patternName, unsigned cores_, unsigned mshr, unsigned size,
+					uint64_t stride, double alpha, uint64_t footprint, double util, double rwratio, unsigned qos):
+	casHMCWrapper(wrapper),
+	numCores(cores_),
+	mshrSize(mshr),
+	requestSize(size),
+	strideSize(stride),
+	zipfAlpha(alpha),
+	footprintSize(footprint),
+	issueProb(util),
+	readRatio(rwratio),
+	qosCores(qos)
+{
+	if(patternName == "uniform")		pattern = UNIFORM;
+	else if(patternName == "stream")	pattern = STREAM;
+	else if(patternName == "strided")	pattern = STRIDED;
+	else if(patternName == "chase")		pattern = POINTER_CHASE;
+	else if(patternName == "zipf")		pattern = ZIPF;
+	else if(patternName == "gups")		pattern = GUPS;
+	else {
+		ERROR(" (WL) == Error - Unknown workload pattern ["<<patternName<<"]");
+		exit(0);
+	}
+	if(numCores == 0 || mshrSize == 0) {
+		ERROR(" (WL) == Error - The number of cores and MSHR entries should be bigger than 0  (cores : "<<numCores<<", MSHR : "<<mshrSize<<")");
+		exit(0);
+	}
+	if(qosCores > numCores) {
+		ERROR(" (WL) == Error - The number of high priority cores ("<<qosCores<<") should not be bigger than the number of cores ("<<numCores<<")");
+		exit(0);
+	}
+
+	uint64_t capacity = (uint64_t)NUM_VAULTS*NUM_BANKS*NUM_COLS*NUM_ROWS;
+	if(footprintSize == 0 || footprintSize > capacity) {
+		footprintSize = capacity;
+	}
+	partitionSize = (footprintSize / numCores) & ~(uint64_t)255;
+	if(partitionSize == 0) {
+		ERROR(" (WL) == Error - Footprint is too small for "<<numCores<<" cores  (footprint : "<<footprintSize<<" byte)");
+		exit(0);
+	}
+	blockBit = _log2(ADDRESS_MAPPING);
+	startCore = 0;
+	completedBytes = 0;
+	maxLat = 0;
+	minLat = -1;
+
+	//Virtual cores and MSHR entries are allocated once at the beginning
+	cores = vector<VirtualCore>(numCores);
+	for(unsigned c=0; c<numCores; c++) {
+		cores[c].rngState = 0x9E3779B97F4A7C15ULL * (c+1);
+		cores[c].base = partitionSize * c;
+		cores[c].offset = 0;
+		cores[c].outstanding = 0;
+		cores[c].priority = (c < qosCores) ? QOS_CLASSES-1 : 0;
+		cores[c].pending = false;
+		cores[c].issued = 0;
+		cores[c].completed = 0;
+		cores[c].latSum = 0;
+		if(pattern == POINTER_CHASE) {
+			cores[c].offset = NextRandom(cores[c]) % partitionSize;
+		}
+	}
+	mshrBlock = vector<uint64_t>(numCores*mshrSize, MSHR_FREE);
+	mshrIssueTime = vector<uint64_t>(numCores*mshrSize, 0);
+	mshrReqSize = vector<unsigned>(numCores*mshrSize, 0);
+
+	//Cumulative distribution of Zipf ranks (hot set over 256-byte slots)
+	if(pattern == ZIPF) {
+		uint64_t items = footprintSize >> 8;
+		if(items > ZIPF_MAX_ITEMS)	items = ZIPF_MAX_ITEMS;
+		zipfCDF = vector<double>(items);
+		double sum = 0;
+		for(uint64_t i=0; i<items; i++) {
+			sum += 1.0 / pow((double)(i+1), zipfAlpha);
+			zipfCDF[i] = sum;
+		}
+		for(uint64_t i=0; i<items; i++) {
+			zipfCDF[i] /= sum;
+		}
+	}
+
+	//Workload setting is appended to the setting log file
+	string settingName = casHMCWrapper->logName + "_setting.log";
+	ofstream settingOut(settingName.c_str(), ios::app);
+	settingOut<<endl<<"        ==== Synthetic workload setting ===="<<endl;
+	settingOut<<ALI(36)<<" Workload pattern : "<<patternName<<endl;
+	settingOut<<ALI(36)<<" The number of virtual cores : "<<numCores<<endl;
+	settingOut<<ALI(36)<<" MSHR entries per core : "<<mshrSize<<endl;
+	if(requestSize == 0) {
+		settingOut<<ALI(36)<<" Request size [byte] : "<<"16-256 mix"<<endl;
+	}
+	else {
+		settingOut<<ALI(36)<<" Request size [byte] : "<<requestSize<<endl;
+	}
+	if(pattern == STRIDED) {
+		settingOut<<ALI(36)<<" Stride [byte] : "<<strideSize<<endl;
+	}
+	if(pattern == ZIPF) {
+		settingOut<<ALI(36)<<" Zipf skewness : "<<zipfAlpha<<endl;
+	}
+	settingOut<<ALI(36)<<" Footprint [MB] : "<<(footprintSize>>20)<<endl;
+	settingOut<<ALI(36)<<" Issue probability per core : "<<issueProb<<endl;
+	settingOut<<ALI(36)<<" The percentage of reads [%] : "<<readRatio<<endl;
+	if(qosCores > 0) {
+		settingOut<<ALI(36)<<" High priority cores (QoS class "<<QOS_CLASSES-1<<") : "<<qosCores<<endl;
+	}
+	settingOut.flush();		settingOut.close();
+	
+	readCB = new Callback<Workload, void, uint64_t, uint64_t>(this, &Workload::ReadComplete);
+	writeCB = new Callback<Workload, void, uint64_t, uint64_t>(this, &Workload::WriteComplete);
+	casHMCWrapper->RegisterCallbacks(readCB, writeCB);
+}
+
+Workload::~Workload()
+{
+	casHMCWrapper->RegisterCallbacks(NULL, NULL);
+	delete readCB;
+	delete writeCB;
+	cores.clear();
+	mshrBlock.clear();
+	mshrIssueTime.clear();
+	mshrReqSize.clear();
+	zipfCDF.clear();
+}
+
+//
+//Issue requests of virtual cores that have a free MSHR entry (closed-loop)
+//
+void Workload::Update()
+{
+	for(unsigned i=0; i<numCores; i++) {
+		VirtualCore &core = cores[(startCore + i) % numCores];
+		if(core.outstanding >= mshrSize)	continue;
+		//Pointer chasing has only one dependent request in flight
+		if(pattern == POINTER_CHASE && core.outstanding > 0)	continue;
+
+		if(!core.pending) {
+			if(NextRandom(core)%10000 >= (uint64_t)(issueProb*10000))	continue;
+			GenerateRequest(core);
+			core.pending = true;
+		}
+
+		if(!casHMCWrapper->CanAcceptTran())	break;
+		if(!casHMCWrapper->ReceiveTran(core.nextType, core.nextAddr, core.nextSize, NULL, core.priority))	break;
+
+		//Occupy a free MSHR entry of this core
+		unsigned c = &core - &cores[0];
+		for(unsigned m=c*mshrSize; m<(c+1)*mshrSize; m++) {
+			if(mshrBlock[m] == MSHR_FREE) {
+				mshrBlock[m] = core.nextAddr >> blockBit;
+				mshrIssueTime[m] = casHMCWrapper->currentClockCycle;
+				mshrReqSize[m] = core.nextSize;
+				break;
+			}
+		}
+		core.outstanding++;
+		core.issued++;
+		core.pending = false;
+	}
+	startCore = (startCore + 1) % numCores;
+}
+
+//
+//Completion callback functions registered in HMC controller
+//
+void Workload::ReadComplete(uint64_t addr, uint64_t cycle)
+{
+	CompleteRequest(addr, cycle);
+}
+
+void Workload::WriteComplete(uint64_t addr, uint64_t cycle)
+{
+	CompleteRequest(addr, cycle);
+}
+
+//
+//Release the MSHR entry matched with returned address
+//
+void Workload::CompleteRequest(uint64_t addr, uint64_t cycle)
+{
+	//The oldest entry is released when several requests are waiting for the same block
+	uint64_t block = addr >> blockBit;
+	int entry = -1;
+	for(unsigned m=0; m<mshrBlock.size(); m++) {
+		if(mshrBlock[m] == block && (entry == -1 || mshrIssueTime[m] < mshrIssueTime[entry])) {
+			entry = m;
+		}
+	}
+	if(entry != -1) {
+		VirtualCore &core = cores[entry / mshrSize];
+		uint64_t lat = cycle - mshrIssueTime[entry];
+		if(lat > maxLat)	maxLat = lat;
+		if(lat < minLat)	minLat = lat;
+		core.latSum += lat;
+		core.completed++;
+		core.outstanding--;
+		completedBytes += mshrReqSize[entry];
+		mshrBlock[entry] = MSHR_FREE;
+
+		//The next address of pointer chasing depends on the returned address
+		if(pattern == POINTER_CHASE) {
+			uint64_t hash = (addr + 1) * 0x9E3779B97F4A7C15ULL;
+			core.offset = (hash ^ (hash >> 29)) % partitionSize;
+		}
+		return;
+	}
+	ERROR(" (WL) == Error - There is no MSHR entry for returned address [0x"<<hex<<setw(9)<<setfill('0')<<addr<<dec<<"]  (CurrentClock : "<<cycle<<")");
+	exit(0);
+}
+
+//
+//Make the next request of the core depending on workload pattern
+//
+void Workload::GenerateRequest(VirtualCore &core)
+{
+	uint64_t addr;
+	core.nextSize = NextSize(core);
+	core.nextType = (NextRandom(core)%10000 < (uint64_t)(readRatio*100)) ? DATA_READ : DATA_WRITE;
+
+	switch(pattern) {
+		case UNIFORM:
+			addr = NextRandom(core) % footprintSize;
+			break;
+		case STREAM:
+			addr = core.base + core.offset;
+			core.offset = (core.offset + core.nextSize) % partitionSize;
+			break;
+		case STRIDED:
+			addr = core.base + core.offset;
+			core.offset = (core.offset + strideSize) % partitionSize;
+			break;
+		case POINTER_CHASE:
+			addr = core.base + core.offset;
+			core.nextType = DATA_READ;
+			break;
+		case ZIPF:
+			addr = ((ZipfRank(core) * 0x9E3779B97F4A7C15ULL) % (footprintSize >> 8)) << 8;
+			break;
+		case GUPS:
+			addr = NextRandom(core) % footprintSize;
+			core.nextType = ATM_INC8;
+			core.nextSize = 16;
+			break;
+	}
+
+	//Requests are aligned to 16 bytes (FLIT) or to the power-of-two request size
+	addr &= ~(uint64_t)15;
+	if((core.nextSize & (core.nextSize-1)) == 0) {
+		addr &= ~(uint64_t)(core.nextSize-1);
+	}
+	core.nextAddr = addr;
+}
+
+unsigned Workload::NextSize(VirtualCore &core)
+{
+	if(requestSize == 0) {
+		return sizeMix[NextRandom(core) % (sizeof(sizeMix)/sizeof(sizeMix[0]))];
+	}
+	else {
+		return requestSize;
+	}
+}
+
+//
+//xorshift64* random number generator (each core has its own stream)
+//
+uint64_t Workload::NextRandom(VirtualCore &core)
+{
+	core.rngState ^= core.rngState >> 12;
+	core.rngState ^= core.rngState << 25;
+	core.rngState ^= core.rngState >> 27;
+	return core.rngState * 0x2545F4914F6CDD1DULL;
+}
+
+uint64_t Workload::ZipfRank(VirtualCore &core)
+{
+	double u = (NextRandom(core) >> 11) * (1.0 / 9007199254740992.0);
+	return lower_bound(zipfCDF.begin(), zipfCDF.end(), u) - zipfCDF.begin();
+}
+
+//
+//Print closed-loop workload result (sustained bandwidth and latency)
+//
+void Workload::PrintStatistic(ostream &out)
+{
+	uint64_t issued = 0;
+	uint64_t completed = 0;
+	uint64_t latSum = 0;
+	for(unsigned c=0; c<numCores; c++) {
+		issued += cores[c].issued;
+		completed += cores[c].completed;
+		latSum += cores[c].latSum;
+	}
+	uint64_t cycles = casHMCWrapper->currentClockCycle;
+
+	out.setf(ios::left);
+	out<<endl<<"   === Synthetic workload result ==="<<endl;
+	out<<"  Cores x MSHR entries : "<<numCores<<" x "<<mshrSize<<endl;
+	out<<"  Issued / completed requests : "<<issued<<" / "<<completed<<endl;
+	out<<"  Average latency [CPU clk] : "<<(completed == 0 ? 0 : (double)latSum/completed)<<endl;
+	out<<"  Max / min latency [CPU clk] : "<<maxLat<<" / "<<(completed == 0 ? 0 : minLat)<<endl;
+	out<<"  Sustained bandwidth [GB/s] : "<<(cycles == 0 ? 0 : (double)completedBytes/(cycles*CPU_CLK_PERIOD))<<endl;
+	for(unsigned c=0; c<numCores; c++) {
+		out<<"    Core["<<c<<"] completed : "<<ALI(10)<<cores[c].completed
+			<<" average latency : "<<(cores[c].completed == 0 ? 0 : (double)cores[c].latSum/cores[c].completed)<<endl;
+	}
+}
+
+} //namespace CasHMC
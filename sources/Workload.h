@@ -0,0 +1,117 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+//Workload.h
+
+#include <stdint.h>		//uint64_t
+#include <stdlib.h>		//exit(0)
+#include <iomanip>		//setw()
+#include <iostream> 	//ostream
+#include <fstream>		//ofstream
+#include <vector>		//vector
+
+#include "ConfigValue.h"
+#include "CallBack.h"
+#include "Transaction.h"
+#include "CasHMCWrapper.h"
+
+using namespace std;
+
+namespace CasHMC
+{
+
+enum WorkloadPattern
+{
+	UNIFORM,		//Uniform random address over the footprint
+	STREAM,			//Sequential address per core
+	STRIDED,		//Constant stride per core
+	POINTER_CHASE,	//Dependent reads (the next address is decided by the returned address)
+	ZIPF,			//Zipf distributed hot set
+	GUPS			//Random read-modify-write atomics (INC8)
+};
+
+//Request state of one virtual core
+struct VirtualCore
+{
+	uint64_t rngState;		//Private xorshift state
+	uint64_t base;			//Start address of the core partition
+	uint64_t offset;		//Current offset in the core partition (STREAM, STRIDED, POINTER_CHASE)
+	unsigned outstanding;	//The number of occupied MSHR entries
+	unsigned priority;		//QoS priority class of requests
+
+	bool pending;			//The next request is generated but not accepted yet
+	TransactionType nextType;
+	uint64_t nextAddr;
+	unsigned nextSize;
+
+	uint64_t issued;
+	uint64_t completed;
+	uint64_t latSum;
+};
+
+class Workload
+{
+public:
+	//
+	//Functions
+	//
+	Workload(CasHMCWrapper *wrapper, string pattern, unsigned cores, unsigned mshr, unsigned size,
+				uint64_t stride, double alpha, uint64_t footprint, double util, double rwratio, unsigned qos=0);
+	virtual ~Workload();
+	void Update();
+	void ReadComplete(uint64_t addr, uint64_t cycle);
+	void WriteComplete(uint64_t addr, uint64_t cycle);
+	void CompleteRequest(uint64_t addr, uint64_t cycle);
+	void GenerateRequest(VirtualCore &core);
+	unsigned NextSize(VirtualCore &core);
+	uint64_t NextRandom(VirtualCore &core);
+	uint64_t ZipfRank(VirtualCore &core);
+	void PrintStatistic(ostream &out);
+
+	//
+	//Fields
+	//
+	CasHMCWrapper *casHMCWrapper;
+	TransCompCB *readCB;
+	TransCompCB *writeCB;
+
+	WorkloadPattern pattern;
+	unsigned numCores;
+	unsigned mshrSize;
+	unsigned requestSize;		//[byte] 0 means 16-256 byte mix
+	uint64_t strideSize;		//[byte]
+	double zipfAlpha;
+	uint64_t footprintSize;		//[byte]
+	uint64_t partitionSize;		//[byte] footprintSize / numCores
+	double issueProb;
+	double readRatio;
+	unsigned qosCores;			//The number of cores issuing requests of the highest QoS class
+	unsigned blockBit;
+	unsigned startCore;
+
+	vector<VirtualCore> cores;
+	//MSHR entries of all cores are allocated once and recycled (core c owns entries [c*mshrSize, (c+1)*mshrSize))
+	vector<uint64_t> mshrBlock;
+	vector<uint64_t> mshrIssueTime;
+	vector<unsigned> mshrReqSize;
+	vector<double> zipfCDF;
+
+	uint64_t completedBytes;
+	uint64_t maxLat;
+	uint64_t minLat;
+};
+
+}
+
+#endif
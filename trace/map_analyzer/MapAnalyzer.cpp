@@ -0,0 +1,181 @@
+/*********************************************************************************
+*  CasHMC v1.3 - 2017.07.10
+*  A Cycle-accurate Simulator for Hybrid Memory Cube
+*
+*  Copyright 2016, Dong-Ik Jeon
+*                  Ki-Seok Chung
+*                  Hanyang University
+*                  estwings57 [at] gmail [dot] com
+*  All rights reserved.
+*********************************************************************************/
+
+//MapAnalyzer.cpp
+//Offline report of vault and bank distribution of a trace under candidate address mappings
+
+#include <getopt.h>		//getopt_long
+#include <stdint.h>		//uint64_t
+#include <stdlib.h>		//exit(0)
+#include <math.h>		//sqrt
+#include <fstream>		//ifstream
+#include <iostream>		//cout
+#include <sstream>		//stringstream
+#include <iomanip>		//setw
+#include <vector>		//vector
+
+#include "ConfigReader.h"
+#include "AddressMap.h"
+
+using namespace std;
+using namespace CasHMC;
+
+//Default candidates (ADDRESS_ORDER:VAULT_HASH:BANK_HASH)
+static const char *defaultCandidates[] =
+{
+	"RO_CO_BA_VA:NONE:NONE",
+	"RO_CO_VA_BA:NONE:NONE",
+	"RO_BA_CO_VA:NONE:NONE",
+	"RO_CO_BA_VA:RO:NONE",
+	"RO_CO_BA_VA:RO:RO",
+	"RO_CO_BA_VA:RO_CO:RO_CO",
+	NULL
+};
+
+void help()
+{
+	cout<<endl<<"-f (--file)    : Trace file name"<<endl;
+	cout<<"-d (--dram)    : DRAM configure file [Default ../../ConfigDRAM.ini]"<<endl;
+	cout<<"-m (--map)     : Candidate mapping 'ADDRESS_ORDER:VAULT_HASH:BANK_HASH' (repeatable) [Default ini mapping and built-in candidates]"<<endl;
+	cout<<"-h (--help)    : Option help"<<endl<<endl;
+}
+
+//
+//Split candidate string into order and hash fields
+//
+void ParseCandidate(string candidate, string &order, string &vaultHash, string &bankHash)
+{
+	stringstream ss(candidate);
+	vaultHash = "NONE";
+	bankHash = "NONE";
+	getline(ss, order, ':');
+	getline(ss, vaultHash, ':');
+	getline(ss, bankHash, ':');
+}
+
+//
+//Max/mean ratio and coefficient of variation of access counts
+//
+void LoadBalance(vector<uint64_t> &count, uint64_t total, unsigned &used, double &maxRatio, double &cv)
+{
+	double mean = (double)total/count.size();
+	double var = 0;
+	uint64_t maxCount = 0;
+	used = 0;
+	for(int i=0; i<count.size(); i++) {
+		if(count[i] > 0)	used++;
+		maxCount = max(maxCount, count[i]);
+		var += (count[i]-mean)*(count[i]-mean);
+	}
+	maxRatio = (mean==0 ? 0 : maxCount/mean);
+	cv = (mean==0 ? 0 : sqrt(var/count.size())/mean);
+}
+
+int main(int argc, char **argv)
+{
+	string traceFileName = "";
+	string dramCfg = "../../ConfigDRAM.ini";
+	vector<string> candidates;
+	
+	int opt;
+	while(1) {
+		static struct option long_options[] = {
+			{"file",  required_argument, 0, 'f'},
+			{"dram",  required_argument, 0, 'd'},
+			{"map",  required_argument, 0, 'm'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0;
+		opt = getopt_long (argc, argv, "f:d:m:h", long_options, &option_index);
+		if(opt == -1) {
+			break;
+		}
+		switch(opt) {
+			case 'f':	traceFileName = string(optarg);			break;
+			case 'd':	dramCfg = string(optarg);				break;
+			case 'm':	candidates.push_back(string(optarg));	break;
+			case 'h':
+			case '?':
+				help();
+				exit(0);
+				break;
+		}
+	}
+	if(traceFileName == "") {
+		cout<<endl<<" == -f (--file) ERROR ==";
+		cout<<endl<<"  Trace file name is required"<<endl<<endl;
+		exit(0);
+	}
+	
+	ReadIniFile(dramCfg);
+	if(candidates.size() == 0) {
+		candidates.push_back(ADDRESS_ORDER + ":" + VAULT_HASH + ":" + BANK_HASH);
+		for(int c=0; defaultCandidates[c] != NULL; c++) {
+			if(candidates[0] != defaultCandidates[c])	candidates.push_back(defaultCandidates[c]);
+		}
+	}
+	
+	//Read addresses of the trace (cycle address type [size])
+	ifstream traceFile(traceFileName.c_str());
+	if(!traceFile.is_open()) {
+		cout<<endl<<" == Error - Could not open trace file ["<<traceFileName<<"]"<<endl<<endl;
+		exit(0);
+	}
+	vector<uint64_t> addrs;
+	string line;
+	uint64_t capacityMask = (uint64_t)NUM_VAULTS*NUM_BANKS*NUM_COLS*NUM_ROWS - 1;
+	while(getline(traceFile, line)) {
+		stringstream ss(line);
+		uint64_t clk, addr;
+		if(ss >> clk >> hex >> addr) {
+			addrs.push_back(addr & capacityMask);
+		}
+	}
+	traceFile.close();
+	
+	cout.setf(ios::left);
+	cout<<endl<<"   === Address mapping distribution of ["<<traceFileName<<"] ("<<addrs.size()<<" requests) ==="<<endl;
+	cout<<"  * Max/mean is the load of the busiest vault (bank) over the average, CV is the coefficient of variation"<<endl;
+	cout<<"  * Row switch is the ratio of accesses hitting a different row from the previous access to the same bank"<<endl<<endl;
+	cout<<"  "<<setw(28)<<"Mapping"<<setw(8)<<"Vaults"<<setw(10)<<"Max/mean"<<setw(8)<<"CV"
+		<<setw(8)<<"Banks"<<setw(10)<<"Max/mean"<<setw(8)<<"CV"<<"Row switch"<<endl;
+	
+	for(int c=0; c<candidates.size(); c++) {
+		string order, vaultHash, bankHash;
+		ParseCandidate(candidates[c], order, vaultHash, bankHash);
+		AddressMap addressMap(order, vaultHash, bankHash);
+		
+		vector<uint64_t> vaultCount(NUM_VAULTS, 0);
+		vector<uint64_t> bankCount(NUM_VAULTS*NUM_BANKS, 0);
+		vector<int64_t> lastRow(NUM_VAULTS*NUM_BANKS, -1);
+		uint64_t rowSwitch = 0;
+		for(int i=0; i<addrs.size(); i++) {
+			unsigned vault, bank, col, row;
+			addressMap.Decode(addrs[i], vault, bank, col, row);
+			unsigned bankID = vault*NUM_BANKS + bank;
+			vaultCount[vault]++;
+			bankCount[bankID]++;
+			if(lastRow[bankID] != -1 && lastRow[bankID] != row)	rowSwitch++;
+			lastRow[bankID] = row;
+		}
+		
+		unsigned vaultUsed, bankUsed;
+		double vaultMax, vaultCV, bankMax, bankCV;
+		LoadBalance(vaultCount, addrs.size(), vaultUsed, vaultMax, vaultCV);
+		LoadBalance(bankCount, addrs.size(), bankUsed, bankMax, bankCV);
+		cout<<"  "<<setw(28)<<candidates[c]<<setw(8)<<vaultUsed<<setw(10)<<setprecision(3)<<vaultMax<<setw(8)<<vaultCV
+			<<setw(8)<<bankUsed<<setw(10)<<bankMax<<setw(8)<<bankCV
+			<<(addrs.size()==0 ? 0 : (double)rowSwitch/addrs.size()*100)<<" %"<<endl;
+	}
+	cout<<endl;
+	return 0;
+}
@@ -1,16 +1,17 @@
 #include <getopt.h>		//getopt_long
 #include <stdint.h>		//uint64_t
 #include <stdlib.h>		//exit(0)
-#include <fstream>		//ofstream
 #include <iostream>		//cout
-#include <fstream>		//ofstream
 #include <sstream>		//stringstream
 #include <iomanip>		//setw
 #include <unistd.h>		//access()
 
+#include "TraceStream.h"
+
 using namespace std;
+using namespace CasHMC;
 
-ofstream traceOut;
+TraceOutStream *traceOut;
 long numSimCycles = 100000;
 uint64_t lineNumber = 1;
 double memUtil = 0.1;
@@ -22,7 +23,8 @@ void help()
 	cout<<endl<<"-c (--cycle)   : The number of CPU cycles to be simulated"<<endl;
 	cout<<"-u (--util)    : Requests frequency (0 = no requests, 1 = as fast as possible) [Default 0.1]"<<endl;
 	cout<<"-r (--rwratio) : (%) The percentage of reads in request stream [Default 80]"<<endl;
-	cout<<"-s (--size)    : Data size of DRAM request ('0' means random data size) [Default 32]"<<endl<<endl;
+	cout<<"-s (--size)    : Data size of DRAM request ('0' means random data size) [Default 32]"<<endl;
+	cout<<"-o (--output)  : Trace file name (.gz, .xz, or .zst is compressed) [Default CasHMC_trace_no#.trc]"<<endl<<endl;
 	cout<<"-h (--help)    : Simulation option help"<<endl<<endl;
 }
 
@@ -33,6 +35,7 @@ int main(int argc, char **argv)
 	//
 	int opt;
 	string pwdString = "";
+	string traceName = "";
 	while(1) {
 		static struct option long_options[] = {
 			{"pwd", required_argument, 0, 'p'},
@@ -40,11 +43,12 @@ int main(int argc, char **argv)
 			{"util",  required_argument, 0, 'u'},
 			{"rwratio",  required_argument, 0, 'r'},
 			{"size",  required_argument, 0, 's'},
+			{"output",  required_argument, 0, 'o'},
 			{"help", no_argument, 0, 'h'},
 			{0, 0, 0, 0}
 		};
 		int option_index=0;
-		opt = getopt_long (argc, argv, "p:c:u:r:s:h", long_options, &option_index);
+		opt = getopt_long (argc, argv, "p:c:u:r:s:o:h", long_options, &option_index);
 		if(opt == -1) {
 			break;
 		}
@@ -91,6 +95,9 @@ int main(int argc, char **argv)
 					exit(0);
 				}
 				break;
+			case 'o':
+				traceName = string(optarg);
+				break;
 			case 'h':
 			case '?':
 				help();
@@ -101,8 +108,7 @@ int main(int argc, char **argv)
 
 	unsigned int ver_num = 0;
 	stringstream temp_vn;
-	string traceName;
-	while(1) { 
+	while(traceName == "") { 
 		traceName += "CasHMC_trace_no";
 		temp_vn << ver_num;
 		traceName += temp_vn.str();
@@ -116,24 +122,26 @@ int main(int argc, char **argv)
 			ver_num++;
 		}
 	}
-	traceOut.open(traceName.c_str());
+	//The trace file is compressed according to its extension (.gz, .xz, or .zst)
+	traceOut = new TraceOutStream(traceName);
 	srand((unsigned)time(NULL));
 	
 	for(uint64_t cpuCycle=0; cpuCycle<numSimCycles; cpuCycle++) {
 		int rand_tran = rand()%10000+1;
 		if(rand_tran <= (int)(memUtil*10000)) {
+			stringstream traceLine;
 			uint64_t physicalAddress = rand();
 			physicalAddress = (physicalAddress<<32)|rand();
 			
 			if(dataSize==16 || dataSize==32 || dataSize==48 || dataSize==64 || dataSize==80 ||
 				dataSize==96 || dataSize==112 || dataSize==128 || dataSize==256) {
 				if(physicalAddress%101 <= (int)rwRatio) {
-					traceOut<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
-								<<dec<<" READ "<<dataSize<<" "<<endl;
+					traceLine<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
+								<<dec<<" READ "<<dataSize<<" \n";
 				}
 				else {
-					traceOut<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
-								<<dec<<" WRITE "<<dataSize<<" "<<endl;
+					traceLine<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
+								<<dec<<" WRITE "<<dataSize<<" \n";
 				}
 			}
 			else {
@@ -153,18 +161,18 @@ int main(int argc, char **argv)
 						exit(0);
 				}
 				if(physicalAddress%101 <= (int)rwRatio) {
-					traceOut<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
-								<<dec<<" READ "<<size<<" "<<endl;
+					traceLine<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
+								<<dec<<" READ "<<size<<" \n";
 				}
 				else {
-					traceOut<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
-								<<dec<<" WRITE "<<size<<" "<<endl;
+					traceLine<<cpuCycle<<" 0x"<<right<<setw(16)<<setfill('0')<<hex<<physicalAddress
+								<<dec<<" WRITE "<<size<<" \n";
 				}
 			}
+			traceOut->Write(traceLine.str());
 		}
 	}
 
-	traceOut.flush();
-	traceOut.close();
+	delete traceOut;	//Remaining data is flushed and the compressed stream is finished
 	return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file